@@ -16,6 +16,12 @@ private:
     LinkedListNode<T> *_head;
     LinkedListNode<T> *_tail;
 
+    /// @brief link a new node in front of the head
+    LinkedListNode<T> *linkFront(LinkedListNode<T> *node);
+
+    /// @brief link a new node after the tail
+    LinkedListNode<T> *linkBack(LinkedListNode<T> *node);
+
 public:
     /// @brief create a new empty list
     LinkedList();
@@ -49,17 +55,31 @@ public:
     /// @brief find the first occurrence of the specified value in the list
     /// @param value: the value we are trying to find
     /// @return the node that contains the value specified if exists; nullptr otherwise
-    LinkedListNode<T> *find(T value) const;
+    LinkedListNode<T> *find(const T &value) const;
 
     /// @brief add a new element to the beginning of the list
     /// @param value: the value to be added
     /// @return the new node created containing the specified value
-    LinkedListNode<T> *prepend(T value);
+    LinkedListNode<T> *prepend(const T &value);
+    LinkedListNode<T> *prepend(T &&value);
+
+    /// @brief construct a new element in place at the beginning of the list
+    /// @param args: arguments forwarded to a constructor of `T`
+    /// @return the new node created containing the constructed value
+    template <typename... Args>
+    LinkedListNode<T> *emplaceFront(Args &&...args);
 
     /// @brief add a new element to the end of the list
     /// @param value: the value to be added
     /// @return the new node created containing the specified value
-    LinkedListNode<T> *append(T value);
+    LinkedListNode<T> *append(const T &value);
+    LinkedListNode<T> *append(T &&value);
+
+    /// @brief construct a new element in place at the end of the list
+    /// @param args: arguments forwarded to a constructor of `T`
+    /// @return the new node created containing the constructed value
+    template <typename... Args>
+    LinkedListNode<T> *emplaceBack(Args &&...args);
 
     /// @brief insert a new element after the specified node
     /// @param node: the node before the insertion position.
@@ -75,7 +95,7 @@ public:
     /// @brief removes the first occurrence of the given element if found
     /// @param value: the value to be removed
     /// @return true of the value is found and removed; false otherwise
-    bool remove(T value);
+    bool remove(const T &value);
 
     /// @brief remove all elements from the list
     void clear();
@@ -3,6 +3,8 @@
 
 // DO NOT CHANGE THIS FILE
 
+#include <utility>
+
 template <typename T>
 class LinkedListNode
 {
@@ -15,8 +17,11 @@ private:
 
     LinkedListNode<T> *_next;
 
-    explicit LinkedListNode(T value) : value(value), _next(nullptr) {}
-    LinkedListNode(T value, LinkedListNode<T> *next) : value(value), _next(next) {}
+    explicit LinkedListNode(T value) : value(std::move(value)), _next(nullptr) {}
+    LinkedListNode(T value, LinkedListNode<T> *next) : value(std::move(value)), _next(next) {}
+
+    template <typename... Args>
+    explicit LinkedListNode(std::in_place_t, Args &&...args) : _next(nullptr), value(std::forward<Args>(args)...) {}
 
 public:
     T value;
@@ -0,0 +1,83 @@
+// g++ -std=c++17 -I. -IECS36C.Homework1 ECS36C.Homework1/tests/LinkedListTest.cpp -lgtest -lgtest_main -pthread
+// (run from the repository root, where LinkedList.cpp lives)
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include "LinkedList.cpp"
+
+// counts how often values are copied and moved
+struct Tracked
+{
+    static int copies;
+    static int moves;
+
+    std::string name;
+    int weight;
+
+    Tracked(std::string name, int weight) : name(std::move(name)), weight(weight) {}
+    Tracked(const Tracked &other) : name(other.name), weight(other.weight) { copies++; }
+    Tracked(Tracked &&other) noexcept : name(std::move(other.name)), weight(other.weight) { moves++; }
+
+    static void reset()
+    {
+        copies = 0;
+        moves = 0;
+    }
+};
+
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
+TEST(LinkedListTest, EmplaceConstructsInPlace)
+{
+    LinkedList<Tracked> list;
+    Tracked::reset();
+    list.emplaceBack("b", 2);
+    list.emplaceFront("a", 1);
+    list.emplaceBack("c", 3);
+    ASSERT_EQ(Tracked::copies, 0);
+    ASSERT_EQ(Tracked::moves, 0);
+
+    ASSERT_EQ(list.size(), 3);
+    ASSERT_EQ(list.head()->value.name, "a");
+    ASSERT_EQ(list.head()->next()->value.name, "b");
+    ASSERT_EQ(list.tail()->value.weight, 3);
+}
+
+TEST(LinkedListTest, RvalueAppendAndPrependMoveOnce)
+{
+    LinkedList<Tracked> list;
+    Tracked::reset();
+    list.append(Tracked("b", 2));
+    list.prepend(Tracked("a", 1));
+    ASSERT_EQ(Tracked::copies, 0);
+    ASSERT_EQ(Tracked::moves, 2);
+
+    // lvalues are still copied, exactly once
+    Tracked c("c", 3);
+    Tracked::reset();
+    list.append(c);
+    list.prepend(c);
+    ASSERT_EQ(Tracked::copies, 2);
+    ASSERT_EQ(Tracked::moves, 0);
+    ASSERT_EQ(c.name, "c");
+    ASSERT_EQ(list.size(), 4);
+}
+
+TEST(LinkedListTest, MoveOnlyValues)
+{
+    LinkedList<std::unique_ptr<int>> list;
+    list.append(std::make_unique<int>(2));
+    list.prepend(std::make_unique<int>(1));
+    list.emplaceBack(new int(3));
+    list.insertAfter(list.head(), std::make_unique<int>(9));
+    ASSERT_EQ(list.size(), 4);
+    ASSERT_EQ(*list.tail()->value, 3);
+
+    std::optional<std::unique_ptr<int>> first = list.removeHead();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_EQ(**first, 1);
+    ASSERT_EQ(*list.head()->value, 9);
+    ASSERT_EQ(list.size(), 3);
+}
@@ -1,6 +1,7 @@
 #ifndef LINKED_LIST_CPP
 #define LINKED_LIST_CPP
 
+#include <utility>
 #include "LinkedList.hpp"
 
 template <typename T>
@@ -44,7 +45,7 @@ LinkedListNode<T> *LinkedList<T>::tail() const
 }
 
 template <typename T>
-LinkedListNode<T> *LinkedList<T>::find(T value) const
+LinkedListNode<T> *LinkedList<T>::find(const T &value) const
 {
     LinkedListNode<T> *current = _head;
     while (current != nullptr)
@@ -59,9 +60,8 @@ LinkedListNode<T> *LinkedList<T>::find(T value) const
 }
 
 template <typename T>
-LinkedListNode<T> *LinkedList<T>::prepend(T value)
+LinkedListNode<T> *LinkedList<T>::linkFront(LinkedListNode<T> *newNode)
 {
-    LinkedListNode<T> *newNode = new LinkedListNode<T>(value);
     if (_head == nullptr)
     {
         _head = newNode;
@@ -77,9 +77,8 @@ LinkedListNode<T> *LinkedList<T>::prepend(T value)
 }
 
 template <typename T>
-LinkedListNode<T> *LinkedList<T>::append(T value)
+LinkedListNode<T> *LinkedList<T>::linkBack(LinkedListNode<T> *newNode)
 {
-    LinkedListNode<T> *newNode = new LinkedListNode<T>(value);
     if (_head == nullptr)
     {
         _head = newNode;
@@ -94,14 +93,52 @@ LinkedListNode<T> *LinkedList<T>::append(T value)
     return newNode;
 }
 
+template <typename T>
+LinkedListNode<T> *LinkedList<T>::prepend(const T &value)
+{
+    return linkFront(new LinkedListNode<T>(std::in_place, value));
+}
+
+template <typename T>
+LinkedListNode<T> *LinkedList<T>::prepend(T &&value)
+{
+    return linkFront(new LinkedListNode<T>(std::in_place, std::move(value)));
+}
+
+template <typename T>
+template <typename... Args>
+LinkedListNode<T> *LinkedList<T>::emplaceFront(Args &&...args)
+{
+    return linkFront(new LinkedListNode<T>(std::in_place, std::forward<Args>(args)...));
+}
+
+template <typename T>
+LinkedListNode<T> *LinkedList<T>::append(const T &value)
+{
+    return linkBack(new LinkedListNode<T>(std::in_place, value));
+}
+
+template <typename T>
+LinkedListNode<T> *LinkedList<T>::append(T &&value)
+{
+    return linkBack(new LinkedListNode<T>(std::in_place, std::move(value)));
+}
+
+template <typename T>
+template <typename... Args>
+LinkedListNode<T> *LinkedList<T>::emplaceBack(Args &&...args)
+{
+    return linkBack(new LinkedListNode<T>(std::in_place, std::forward<Args>(args)...));
+}
+
 template <typename T>
 LinkedListNode<T> *LinkedList<T>::insertAfter(LinkedListNode<T> *node, T value)
 {
     if (node == nullptr)
     {
-        return prepend(value);
+        return prepend(std::move(value));
     }
-    LinkedListNode<T> *newNode = new LinkedListNode<T>(value);
+    LinkedListNode<T> *newNode = new LinkedListNode<T>(std::move(value));
     newNode->_next = node->_next;
     node->_next = newNode;
     if (node == _tail)
@@ -119,7 +156,7 @@ std::optional<T> LinkedList<T>::removeHead()
     {
         return std::nullopt;
     }
-    T value = _head->value;
+    T value = std::move(_head->value);
     LinkedListNode<T> *oldHead = _head;
     _head = _head->_next;
     if (_head == nullptr)
@@ -133,7 +170,7 @@ std::optional<T> LinkedList<T>::removeHead()
 
 
 template <typename T>
-bool LinkedList<T>::remove(T value)
+bool LinkedList<T>::remove(const T &value)
 {
     LinkedListNode<T> *current = _head;
     LinkedListNode<T> *previous = nullptr;
@@ -0,0 +1,69 @@
+// Range sums and maxima over a TreeMap<int64_t, double> keyed by timestamp:
+// aggregate(lo, hi) with an Aggregate<Monoid> policy against the old pattern
+// of to_vector() and a linear scan, and against walking range(lo, hi).
+//
+//   g++ -std=c++17 -O2 -Ilib bench/AggregateBench.cpp -o aggregate_bench
+//   ./aggregate_bench [n = 1000000]
+
+#include <algorithm>
+#include <cstdint>
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+int main(int argc, char **argv)
+{
+    using PlainMap = TreeMap<int64_t, double>;
+    using SumMap = TreeMap<int64_t, double, DefaultComparator<int64_t>, Aggregate<SumMonoid<double>>>;
+    using MaxMap = TreeMap<int64_t, double, DefaultComparator<int64_t>, Aggregate<MaxMonoid<double>>>;
+
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t queries = 1000;
+    std::vector<int> random = random_ints(n);
+
+    PlainMap plain;
+    SumMap sums;
+    MaxMap maxes;
+    double plain_insert_ns = time_ns([&] {
+        for (size_t i = 0; i < n; ++i) plain.insert(static_cast<int64_t>(i) * 1000, random[i] % 1000);
+    });
+    double sum_insert_ns = time_ns([&] {
+        for (size_t i = 0; i < n; ++i) sums.insert(static_cast<int64_t>(i) * 1000, random[i] % 1000);
+    });
+    for (size_t i = 0; i < n; ++i) maxes.insert(static_cast<int64_t>(i) * 1000, random[i] % 1000);
+    report("insert, plain", plain_insert_ns / n, "ns/op");
+    report("insert, Aggregate<SumMonoid>", sum_insert_ns / n, "ns/op");
+
+    // windows covering a random 1% to 50% of the keys
+    std::vector<std::pair<int64_t, int64_t>> windows;
+    for (size_t i = 0; i < queries; ++i) {
+        int64_t lo = static_cast<int64_t>(static_cast<uint32_t>(random[i]) % (n / 2)) * 1000;
+        int64_t width = static_cast<int64_t>(n / 100 + static_cast<uint32_t>(random[i + 1]) % (n / 2)) * 1000;
+        windows.push_back({lo, lo + width});
+    }
+
+    double total = 0;
+    double scan_ns = time_ns([&] {
+        for (size_t i = 0; i < 10; ++i) {
+            for (const auto &[key, value] : plain.to_vector()) {
+                if (key >= windows[i].first && key <= windows[i].second) total += value;
+            }
+        }
+    });
+    double range_ns = time_ns([&] {
+        for (const auto &[lo, hi] : windows) {
+            for (const auto &entry : plain.range(lo, hi)) total += entry.second;
+        }
+    });
+    double sum_ns = time_ns([&] {
+        for (const auto &[lo, hi] : windows) total += sums.aggregate(lo, hi);
+    });
+    double max_ns = time_ns([&] {
+        for (const auto &[lo, hi] : windows) total += maxes.aggregate(lo, hi);
+    });
+    report("window sum via to_vector() scan", scan_ns / 10, "ns/query");
+    report("window sum via range()", range_ns / queries, "ns/query");
+    report("window sum via aggregate()", sum_ns / queries, "ns/query");
+    report("window max via aggregate()", max_ns / queries, "ns/query");
+    do_not_optimize(total);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Heap allocations and time per operation for TreeMap<std::string, std::string>
+// when entries are moved in and keys are looked up without building an entry,
+// next to the old pattern of copying `std::make_pair(key, value)` around.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/AllocationBench.cpp -o allocation_bench
+
+#include <cstdlib>
+#include <new>
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+static size_t heap_allocations = 0;
+
+void *operator new(size_t size)
+{
+    heap_allocations++;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+using Entry = std::pair<std::string, std::string>;
+using EntrySet = TreeSet<Entry, EntryComparator<std::string, std::string, DefaultComparator<std::string>>>;
+
+template <typename F>
+void measure(const std::string &name, size_t n, F &&fn)
+{
+    size_t before = heap_allocations;
+    double ns = time_ns(fn);
+    report(name + ", heap allocations", double(heap_allocations - before) / n, "per op");
+    report(name + ", time", ns / n, "ns/op");
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 200000;
+    std::vector<std::string> keys = random_strings(n);
+    std::vector<std::string> values = random_strings(n, 7);
+
+    // the old TreeMap::insert: copy into a pair, probe, then add a copy
+    EntrySet old_tree;
+    measure("insert, copy pair (before)", n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            std::string key = keys[i], value = values[i];
+            Entry entry = std::make_pair(key, value);
+            do_not_optimize(old_tree.get(entry));
+            old_tree.add(entry);
+        }
+    });
+
+    TreeMap<std::string, std::string> map;
+    measure("insert, moved in (after)", n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            std::string key = keys[i], value = values[i];
+            map.insert(std::move(key), std::move(value));
+        }
+    });
+
+    size_t hits = 0;
+    measure("contains, dummy pair (before)", n, [&] {
+        for (const std::string &key : keys) hits += old_tree.contains(std::make_pair(key, std::string{}));
+    });
+    measure("contains, bare key (after)", n, [&] {
+        for (const std::string &key : keys) hits += map.contains(key);
+    });
+    do_not_optimize(hits);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Red-black TreeMap versus the adaptive radix tree ArtMap, on URL-like
+// string keys that share a long prefix and on random uint64 keys: insert,
+// lookup of present and absent keys, full in-order iteration, and range
+// scans of about 100 entries.
+//
+//   g++ -std=c++17 -O2 -march=native -Ilib bench/ArtBench.cpp -o art_bench
+//   ./art_bench [n = 1000000]
+
+#include <algorithm>
+#include "ArtMap.cpp"
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+template <typename Map, typename K>
+void run(const std::string &name, const std::vector<K> &keys, const std::vector<K> &absent)
+{
+    Map map;
+    double insert_ns = time_ns([&] {
+        for (size_t i = 0; i < keys.size(); ++i) map.insert(keys[i], static_cast<int>(i));
+    });
+
+    std::vector<K> present = keys;
+    std::shuffle(present.begin(), present.end(), std::mt19937(3));
+    size_t hits = 0;
+    double hit_ns = time_ns([&] {
+        for (const K &k : present) hits += map.get(k).has_value();
+    });
+    double miss_ns = time_ns([&] {
+        for (const K &k : absent) hits += map.contains(k);
+    });
+
+    int64_t sum = 0;
+    double iterate_ns = time_ns([&] {
+        for (const auto &entry : map) sum += entry.second;
+    });
+
+    // each scan starts at a random key and reads the next 100 or so entries
+    std::vector<K> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+    const size_t scans = 10000;
+    double scan_ns = time_ns([&] {
+        for (size_t i = 0; i < scans; ++i) {
+            size_t from = (i * 7919) % (sorted.size() - 100);
+            for (const auto &entry : map.range(sorted[from], sorted[from + 99])) sum += entry.second;
+        }
+    });
+    do_not_optimize(hits);
+    do_not_optimize(sum);
+
+    report(name + " insert", insert_ns / keys.size(), "ns/op");
+    report(name + " get, present", hit_ns / keys.size(), "ns/op");
+    report(name + " contains, absent", miss_ns / absent.size(), "ns/op");
+    report(name + " iterate", iterate_ns / keys.size(), "ns/op");
+    report(name + " range scan of 100", scan_ns / scans / 1000, "us");
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::vector<std::string> words = random_strings(2 * n);
+    std::vector<std::string> strings(words.begin(), words.begin() + n);
+    std::vector<std::string> absent_strings(words.begin() + n, words.end());
+    run<TreeMap<std::string, int>>("TreeMap<string>", strings, absent_strings);
+    run<ArtMap<std::string, int>>("ArtMap<string>", strings, absent_strings);
+    {
+        ArtMap<std::string, int> map;
+        for (const auto &s : strings) map.insert(s, 0);
+        report("ArtMap<string> bytes per entry", map.bytes_per_element(), "B");
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> numbers(n), absent_numbers(n);
+    for (auto &k : numbers) k = rng();
+    for (auto &k : absent_numbers) k = rng();
+    run<TreeMap<uint64_t, int>>("TreeMap<uint64_t>", numbers, absent_numbers);
+    run<ArtMap<uint64_t, int>>("ArtMap<uint64_t>", numbers, absent_numbers);
+    {
+        ArtMap<uint64_t, int> map;
+        for (uint64_t k : numbers) map.insert(k, 0);
+        report("ArtMap<uint64_t> bytes per entry", map.bytes_per_element(), "B");
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Red-black TreeSet versus the B+-tree BTreeSet on random int64 keys:
+// insert, lookup (half hits, half misses) and full in-order iteration.
+//
+//   g++ -std=c++17 -O2 -march=native -Ilib bench/BTreeBench.cpp -o btree_bench
+
+#include "Bench.hpp"
+#include "BTreeSet.cpp"
+#include "TreeSet.cpp"
+
+template <typename Set>
+void run(const char *name, const std::vector<int64_t> &keys, const std::vector<int64_t> &probes)
+{
+    Set s;
+    double insert_ns = time_ns([&] {
+        for (int64_t k : keys) s.add(k);
+    });
+
+    size_t hits = 0;
+    double lookup_ns = time_ns([&] {
+        for (int64_t k : probes) hits += s.contains(k);
+    });
+
+    int64_t sum = 0;
+    double iterate_ns = time_ns([&] {
+        for (int64_t k : s) sum += k;
+    });
+    do_not_optimize(hits);
+    do_not_optimize(sum);
+
+    report(std::string(name) + " insert", insert_ns / keys.size(), "ns/op");
+    report(std::string(name) + " contains", lookup_ns / probes.size(), "ns/op");
+    report(std::string(name) + " iterate", iterate_ns / s.size(), "ns/element");
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    std::mt19937_64 rng(42);
+    std::vector<int64_t> keys(n);
+    for (auto &k : keys) k = static_cast<int64_t>(rng() >> 1);
+    std::vector<int64_t> probes(n);
+    for (size_t i = 0; i < n; ++i) probes[i] = (i % 2) ? keys[rng() % n] : static_cast<int64_t>(rng() >> 1);
+
+    run<TreeSet<int64_t>>("red-black TreeSet", keys, probes);
+    run<BTreeSet<int64_t>>("B+-tree BTreeSet", keys, probes);
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Throughput of TreeSet<int64_t>::contains in a loop against contains_many,
+// which interleaves BATCH_WIDTH descents with software prefetch, for sizes
+// from 1K keys upward. Half of the probes are present.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/BatchLookupBench.cpp -o batch_lookup_bench
+//   ./batch_lookup_bench [max_keys = 10000000]
+
+#include <cstdint>
+#include <memory>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+static const size_t LOOKUPS = 2000000;
+
+int main(int argc, char **argv)
+{
+    const size_t max_keys = argc > 1 ? std::stoull(argv[1]) : 10000000;
+
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        std::vector<int64_t> keys;
+        for (int x : random_ints(n)) keys.push_back(2 * static_cast<int64_t>(static_cast<uint32_t>(x)));
+        TreeSet<int64_t> tree;
+        for (int64_t key : keys) tree.add(key); // random order, so nodes are scattered
+        std::vector<int64_t> probes;
+        for (int x : random_ints(LOOKUPS, 7)) {
+            uint32_t r = static_cast<uint32_t>(x);
+            probes.push_back(keys[r % n] + (r >> 31));
+        }
+        std::string suffix = ", n=" + std::to_string(n);
+
+        size_t hits = 0;
+        double scalar_ns = time_ns([&] {
+            for (int64_t p : probes) hits += tree.contains(p);
+        });
+        report("contains loop" + suffix, LOOKUPS / scalar_ns * 1e3, "M lookups/s");
+
+        std::unique_ptr<bool[]> found(new bool[LOOKUPS]);
+        double batch_ns = time_ns([&] { tree.contains_many(probes.data(), LOOKUPS, found.get()); });
+        for (size_t i = 0; i < LOOKUPS; ++i) hits += found[i];
+        report("contains_many" + suffix, LOOKUPS / batch_ns * 1e3, "M lookups/s");
+        report("speedup" + suffix, scalar_ns / batch_ns, "x");
+        do_not_optimize(hits);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/// @brief run `fn` once and return the elapsed wall time
+/// @return elapsed time in nanoseconds
+template <typename F>
+double time_ns(F &&fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+}
+
+/// @brief print one result row as `name  value unit`
+inline void report(const std::string &name, double value, const char *unit)
+{
+    std::printf("%-48s %12.2f %s\n", name.c_str(), value, unit);
+}
+
+/// @brief `n` uniformly random integers from a fixed seed
+inline std::vector<int> random_ints(size_t n, uint32_t seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::vector<int> v(n);
+    for (auto &x : v) {
+        x = static_cast<int>(rng());
+    }
+    return v;
+}
+
+/// @brief `n` random lowercase strings sharing a common prefix, like URL paths
+inline std::vector<std::string> random_strings(size_t n, uint32_t seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::vector<std::string> v(n);
+    for (auto &s : v) {
+        s = "/api/v1/items/";
+        for (int i = 0; i < 12; ++i) {
+            s.push_back(static_cast<char>('a' + rng() % 26));
+        }
+    }
+    return v;
+}
+
+/// @brief keeps the optimizer from discarding a computed value
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
@@ -0,0 +1,34 @@
+// Startup cost of building a TreeSet from a snapshot: repeated add() versus
+// the sort-and-bulk-build constructor, on unsorted and sorted input.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/BulkLoadBench.cpp -o bulk_load_bench
+
+#include <algorithm>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    std::vector<int> unsorted = random_ints(n);
+    std::vector<int> sorted = unsorted;
+    std::sort(sorted.begin(), sorted.end());
+
+    for (const auto *input : { &unsorted, &sorted }) {
+        const char *label = input == &unsorted ? "unsorted" : "sorted";
+
+        double add_ns = time_ns([&] {
+            TreeSet<int> s;
+            for (int x : *input) s.add(x);
+            do_not_optimize(s.size());
+        });
+        double bulk_ns = time_ns([&] {
+            TreeSet<int> s(*input);
+            do_not_optimize(s.size());
+        });
+        report(std::string("repeated add, ") + label, add_ns / 1e6, "ms");
+        report(std::string("bulk build, ") + label, bulk_ns / 1e6, "ms");
+        report("speedup", add_ns / bulk_ns, "x");
+    }
+    return 0;
+}
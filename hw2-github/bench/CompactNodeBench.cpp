@@ -0,0 +1,58 @@
+// Bytes per node and per element, random insert and contains() for
+// TreeSet<int64_t> with the three node layouts: WideNode (three pointers and
+// a color field, the default), PackedColorNode (color in the parent pointer)
+// and CompactNode (32-bit arena indices, color in the parent index). Bytes per
+// element count free slots and, for CompactNode, each arena page's share of
+// its chunk.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/CompactNodeBench.cpp -o compact_node_bench
+//   ./compact_node_bench [max_keys = 10000000]
+
+#include <cstdint>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+static const size_t LOOKUPS = 2000000;
+
+template <typename Layout>
+void run(const std::string &name, const std::vector<int64_t> &keys, const std::vector<int64_t> &probes)
+{
+    using Set = TreeSet<int64_t, DefaultComparator<int64_t>, NoAugment, Layout>;
+    std::string suffix = ", n=" + std::to_string(keys.size());
+
+    Set set;
+    double insert_ns = time_ns([&] {
+        for (int64_t key : keys) set.add(key);
+    });
+    report(name + " insert" + suffix, insert_ns / keys.size(), "ns/op");
+    report(name + " bytes per element" + suffix, set.bytes_per_element(), "bytes");
+
+    size_t hits = 0;
+    double contains_ns = time_ns([&] {
+        for (int64_t p : probes) hits += set.contains(p);
+    });
+    report(name + " contains" + suffix, contains_ns / probes.size(), "ns/lookup");
+    do_not_optimize(hits);
+}
+
+int main(int argc, char **argv)
+{
+    const size_t max_keys = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    report("WideNode bytes per node", TreeSet<int64_t>::bytes_per_node(), "bytes");
+    report("PackedColorNode bytes per node",
+           TreeSet<int64_t, DefaultComparator<int64_t>, NoAugment, PackedColorNode>::bytes_per_node(), "bytes");
+    report("CompactNode bytes per node",
+           TreeSet<int64_t, DefaultComparator<int64_t>, NoAugment, CompactNode>::bytes_per_node(), "bytes");
+
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        std::vector<int64_t> keys;
+        for (int x : random_ints(n)) keys.push_back(static_cast<uint32_t>(x));
+        std::vector<int64_t> probes;
+        for (int x : random_ints(LOOKUPS, 7)) probes.push_back(keys[static_cast<uint32_t>(x) % n]);
+
+        run<WideNode>("WideNode", keys, probes);
+        run<PackedColorNode>("PackedColorNode", keys, probes);
+        run<CompactNode>("CompactNode", keys, probes);
+    }
+    return 0;
+}
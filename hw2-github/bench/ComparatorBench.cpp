@@ -0,0 +1,68 @@
+// Per-lookup cost of the inlined default comparator versus the type-erased
+// std::function<int(T, T)> comparator that copies both arguments, and, for
+// TreeMap, a runtime key comparator that takes them by reference.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/ComparatorBench.cpp -o comparator_bench
+
+#include <functional>
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    {
+        std::vector<int> keys = random_ints(n);
+        std::function<int(int, int)> runtime = [](int a, int b) { return (a < b) ? -1 : (a > b) ? 1 : 0; };
+        TreeSet<int> erased(keys, runtime);
+        TreeSet<int> inlined(keys);
+
+        size_t hits = 0;
+        double erased_ns = time_ns([&] {
+            for (int k : keys) hits += erased.contains(k);
+        });
+        double inlined_ns = time_ns([&] {
+            for (int k : keys) hits += inlined.contains(k);
+        });
+        do_not_optimize(hits);
+        report("TreeSet<int> contains, std::function", erased_ns / n, "ns/lookup");
+        report("TreeSet<int> contains, inlined", inlined_ns / n, "ns/lookup");
+        report("speedup", erased_ns / inlined_ns, "x");
+    }
+
+    {
+        using Entry = std::pair<std::string, std::string>;
+        std::vector<std::string> keys = random_strings(n);
+        std::vector<Entry> entries;
+        for (const auto &k : keys) entries.emplace_back(k, k);
+
+        // what TreeMap did before: a set of pairs behind a by-value comparator
+        std::function<int(Entry, Entry)> runtime = [](Entry a, Entry b) {
+            return (a.first < b.first) ? -1 : (a.first > b.first) ? 1 : 0;
+        };
+        TreeSet<Entry> erased(entries, runtime);
+        TreeMap<std::string, std::string> inlined(entries);
+        // a runtime key comparator, which std::function now calls by reference
+        TreeMap<std::string, std::string> wrapped(entries, [](const std::string &a, const std::string &b) {
+            return (a < b) ? -1 : (a > b) ? 1 : 0;
+        });
+
+        size_t hits = 0;
+        double erased_ns = time_ns([&] {
+            for (const auto &k : keys) hits += erased.contains(Entry(k, std::string{}));
+        });
+        double wrapped_ns = time_ns([&] {
+            for (const auto &k : keys) hits += wrapped.contains(k);
+        });
+        double inlined_ns = time_ns([&] {
+            for (const auto &k : keys) hits += inlined.contains(k);
+        });
+        do_not_optimize(hits);
+        report("TreeMap<string, string> contains, std::function", erased_ns / n, "ns/lookup");
+        report("TreeMap<string, string> contains, key fn by ref", wrapped_ns / n, "ns/lookup");
+        report("TreeMap<string, string> contains, inlined", inlined_ns / n, "ns/lookup");
+        report("speedup", erased_ns / inlined_ns, "x");
+    }
+    return 0;
+}
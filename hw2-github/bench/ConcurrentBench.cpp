@@ -0,0 +1,99 @@
+// Throughput of ConcurrentSkipList<int> against a TreeSet<int> behind one
+// std::mutex, from 1 to `max_threads` threads at 90%, 50% and 10% reads.
+// Writes are half adds and half removes of random keys from a range twice the
+// prefilled size, so the set stays about the same size. Both sets see the
+// same per-thread key streams. Speedups need as many cores as threads: with
+// fewer, the skip list only shows what its locking costs next to one mutex.
+//
+//   g++ -std=c++17 -O2 -march=native -pthread -Ilib bench/ConcurrentBench.cpp -o concurrent_bench
+//   ./concurrent_bench [n = 1000000] [ops_per_thread = 1000000] [max_threads = 16]
+
+#include <mutex>
+#include <thread>
+#include "Bench.hpp"
+#include "ConcurrentSkipList.cpp"
+#include "TreeSet.cpp"
+
+/// TreeSet with every call under one lock, the baseline to beat
+class LockedTreeSet
+{
+private:
+    TreeSet<int> _set;
+    mutable std::mutex _mutex;
+
+public:
+    void add(int value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _set.add(value);
+    }
+    bool remove(int value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _set.remove(value);
+    }
+    bool contains(int value) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _set.contains(value);
+    }
+};
+
+/// @return million operations per second over all threads
+template <typename Set>
+double run(Set &set, unsigned threads, size_t ops, unsigned read_percent, int range)
+{
+    std::vector<std::thread> workers;
+    std::vector<size_t> hits(threads);
+    double ns = time_ns([&] {
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(t + 1);
+                size_t found = 0;
+                for (size_t i = 0; i < ops; ++i) {
+                    int key = static_cast<int>(rng() % range);
+                    unsigned dice = rng() % 100;
+                    if (dice < read_percent) {
+                        found += set.contains(key);
+                    } else if (dice % 2) {
+                        set.add(key);
+                    } else {
+                        found += set.remove(key);
+                    }
+                }
+                hits[t] = found;
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    });
+    do_not_optimize(hits);
+    return threads * ops / ns * 1000;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t ops = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const unsigned max_threads = argc > 3 ? std::stoul(argv[3]) : 16;
+    const int range = static_cast<int>(2 * n);
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    std::vector<int> prefill;
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < n; ++i) {
+        prefill.push_back(static_cast<int>(rng() % range));
+    }
+
+    for (unsigned read_percent : { 90u, 50u, 10u }) {
+        std::printf("-- %u%% reads\n", read_percent);
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            LockedTreeSet locked;
+            for (int v : prefill) locked.add(v);
+            ConcurrentSkipList<int> skip(prefill);
+
+            std::string suffix = ", " + std::to_string(threads) + " threads";
+            report("mutex + TreeSet" + suffix, run(locked, threads, ops, read_percent, range), "Mops/s");
+            report("ConcurrentSkipList" + suffix, run(skip, threads, ops, read_percent, range), "Mops/s");
+        }
+    }
+    return 0;
+}
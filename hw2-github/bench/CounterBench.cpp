@@ -0,0 +1,34 @@
+// Word counting with TreeMap: `get` followed by `insert` walks the tree twice,
+// `map[key] += 1` walks it once and allocates only for new keys.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/CounterBench.cpp -o counter_bench
+
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    // 1000 distinct words, so almost every update hits an existing key
+    std::vector<std::string> distinct = random_strings(1000);
+    std::vector<std::string> words;
+    for (int x : random_ints(n)) {
+        words.push_back(distinct[static_cast<unsigned>(x) % distinct.size()]);
+    }
+
+    TreeMap<std::string, int> twice;
+    double twice_ns = time_ns([&] {
+        for (const std::string &w : words) twice.insert(w, twice.get(w).value_or(0) + 1);
+    });
+
+    TreeMap<std::string, int> once;
+    double once_ns = time_ns([&] {
+        for (const std::string &w : words) once[w] += 1;
+    });
+
+    do_not_optimize(once.get(distinct[0]));
+    report("get + insert", twice_ns / n, "ns/update");
+    report("operator[]", once_ns / n, "ns/update");
+    report("speedup", twice_ns / once_ns, "x");
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Bloom filter front-end of TreeSet<int> and TreeMap<std::string, int>.
+// Reports the measured false-positive rate and filter memory per element
+// for a few sizes, then lookup time for absent and present keys with and
+// without the filter, one at a time and batched with contains_many.
+//
+//   g++ -std=c++17 -O2 -pthread -Ilib bench/FilterBench.cpp -o filter_bench
+//   ./filter_bench [n = 1000000]
+
+#include <algorithm>
+#include <memory>
+#include "Bench.hpp"
+#include "TreeMap.cpp"
+
+// an absent element that reaches the comparator got past the filter
+struct CountingCompare
+{
+    static inline size_t calls = 0;
+    int operator()(int a, int b) const {
+        calls++;
+        return (a > b) - (a < b);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    // evens are present, odds absent
+    std::vector<int> evens, odds;
+    for (size_t i = 0; i < n; ++i) {
+        evens.push_back(static_cast<int>(2 * i));
+        odds.push_back(static_cast<int>(2 * i + 1));
+    }
+    std::vector<int> present = evens, absent = odds;
+    std::shuffle(present.begin(), present.end(), std::mt19937(1));
+    std::shuffle(absent.begin(), absent.end(), std::mt19937(2));
+
+    for (double bits : {6.0, 10.0, 16.0}) {
+        TreeSet<int, CountingCompare> s(evens);
+        s.enable_filter(bits);
+        size_t passed = 0;
+        for (int x : absent) {
+            size_t before = CountingCompare::calls;
+            s.contains(x);
+            passed += CountingCompare::calls != before;
+        }
+        std::string suffix = ", " + std::to_string(static_cast<int>(bits)) + " bits/element";
+        report("false positives" + suffix, 100.0 * passed / n, "%");
+        report("filter bytes per element" + suffix, double(s.filter_bytes()) / n, "B");
+    }
+
+    auto lookups = [&](const char *name, auto &set, const std::vector<int> &keys) {
+        size_t found = 0;
+        double ns = time_ns([&] {
+            for (int x : keys) found += set.contains(x);
+        });
+        report(name, ns / keys.size(), "ns/op");
+        do_not_optimize(found);
+    };
+    {
+        TreeSet<int> plain(evens);
+        TreeSet<int> filtered(evens);
+        filtered.enable_filter();
+        lookups("TreeSet<int> contains, absent", plain, absent);
+        lookups("TreeSet<int> contains, absent, filter", filtered, absent);
+        lookups("TreeSet<int> contains, present", plain, present);
+        lookups("TreeSet<int> contains, present, filter", filtered, present);
+
+        std::unique_ptr<bool[]> found(new bool[n]);
+        auto batch = [&](const char *name, auto &set, const std::vector<int> &keys) {
+            double ns = time_ns([&] { set.contains_many(keys.data(), keys.size(), found.get()); });
+            report(name, ns / keys.size(), "ns/op");
+            do_not_optimize(found[0]);
+        };
+        batch("TreeSet<int> contains_many, absent", plain, absent);
+        batch("TreeSet<int> contains_many, absent, filter", filtered, absent);
+        batch("TreeSet<int> contains_many, present, filter", filtered, present);
+    }
+
+    {
+        std::vector<std::string> words = random_strings(2 * n);
+        TreeMap<std::string, int> plain, filtered;
+        for (size_t i = 0; i < n; ++i) {
+            plain.insert(words[i], static_cast<int>(i));
+        }
+        filtered = plain;
+        filtered.enable_filter();
+        auto gets = [&](const char *name, auto &map, size_t from) {
+            size_t found = 0;
+            double ns = time_ns([&] {
+                for (size_t i = from; i < from + n; ++i) found += map.get(words[i]).has_value();
+            });
+            report(name, ns / n, "ns/op");
+            do_not_optimize(found);
+        };
+        gets("TreeMap<string, int> get, absent", plain, n);
+        gets("TreeMap<string, int> get, absent, filter", filtered, n);
+        gets("TreeMap<string, int> get, present", plain, 0);
+        gets("TreeMap<string, int> get, present, filter", filtered, 0);
+    }
+    return 0;
+}
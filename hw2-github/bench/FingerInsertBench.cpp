@@ -0,0 +1,74 @@
+// Comparator calls and time per insert into TreeSet<int> for sorted, reverse,
+// clustered (short increasing runs starting at random places) and random
+// streams. `add` starts next to the previous insertion point; `add(end(), x)`
+// hints the end; std::set::insert is the reference descent from the root.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/FingerInsertBench.cpp -o finger_insert_bench
+//   ./finger_insert_bench [n = 1000000]
+
+#include <set>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+static size_t comparisons = 0;
+
+struct CountingCompare
+{
+    int operator()(int a, int b) const {
+        comparisons++;
+        return (a < b) ? -1 : (a > b) ? 1 : 0;
+    }
+};
+
+struct CountingLess
+{
+    bool operator()(int a, int b) const {
+        comparisons++;
+        return a < b;
+    }
+};
+
+template <typename F>
+void measure(const std::string &name, size_t n, F &&fn)
+{
+    comparisons = 0;
+    double ns = time_ns(fn);
+    report(name + ", comparisons", double(comparisons) / n, "per insert");
+    report(name + ", time", ns / n, "ns/insert");
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::vector<std::pair<std::string, std::vector<int>>> streams(4);
+    streams[0].first = "sorted";
+    streams[1].first = "reverse";
+    streams[2].first = "clustered";
+    streams[3].first = "random";
+    std::vector<int> random = random_ints(n);
+    for (size_t i = 0; i < n; ++i) {
+        streams[0].second.push_back(static_cast<int>(i));
+        streams[1].second.push_back(static_cast<int>(n - i));
+        // runs of 64 consecutive keys, each run starting at a random key
+        streams[2].second.push_back(random[i / 64 * 64] / 128 * 128 + static_cast<int>(i % 64));
+        streams[3].second.push_back(random[i]);
+    }
+
+    for (const auto &[name, keys] : streams) {
+        TreeSet<int, CountingCompare> finger;
+        measure(name + ", add", n, [&] {
+            for (int key : keys) finger.add(key);
+        });
+        TreeSet<int, CountingCompare> hinted;
+        measure(name + ", add(end(), x)", n, [&] {
+            for (int key : keys) hinted.add(hinted.end(), key);
+        });
+        std::set<int, CountingLess> reference;
+        measure(name + ", std::set::insert", n, [&] {
+            for (int key : keys) reference.insert(key);
+        });
+        do_not_optimize(finger.size() + hinted.size() + reference.size());
+    }
+    return 0;
+}
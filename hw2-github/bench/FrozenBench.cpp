@@ -0,0 +1,51 @@
+// contains() on a pointer-based TreeSet<int64_t>, binary search over a sorted
+// vector, and the Eytzinger FrozenTreeSet, for sizes from 1K keys upward.
+// Pointer trees above `pointer_limit` keys are skipped (about 48 bytes a node).
+//
+//   g++ -std=c++17 -O2 -Ilib bench/FrozenBench.cpp -o frozen_bench
+//   ./frozen_bench [max_keys = 100000000] [pointer_limit = 10000000]
+
+#include <algorithm>
+#include <cstdint>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+static const size_t LOOKUPS = 2000000;
+
+int main(int argc, char **argv)
+{
+    const size_t max_keys = argc > 1 ? std::stoull(argv[1]) : 100000000;
+    const size_t pointer_limit = argc > 2 ? std::stoull(argv[2]) : 10000000;
+
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        // even keys, looked up with random keys of which half are present
+        std::vector<int64_t> keys(n);
+        for (size_t i = 0; i < n; ++i) keys[i] = 2 * static_cast<int64_t>(i);
+        std::vector<int64_t> probes;
+        for (int x : random_ints(LOOKUPS)) probes.push_back(static_cast<uint32_t>(x) % (2 * n));
+
+        size_t hits = 0;
+        std::string suffix = ", n=" + std::to_string(n);
+        double tree_ns = 0;
+        if (n <= pointer_limit) {
+            TreeSet<int64_t> tree(keys);
+            tree_ns = time_ns([&] {
+                for (int64_t p : probes) hits += tree.contains(p);
+            });
+            report("TreeSet contains" + suffix, tree_ns / LOOKUPS, "ns/lookup");
+        }
+        double sorted_ns = time_ns([&] {
+            for (int64_t p : probes) hits += std::binary_search(keys.begin(), keys.end(), p);
+        });
+        FrozenTreeSet<int64_t> frozen(keys);
+        std::vector<int64_t>().swap(keys);
+        double frozen_ns = time_ns([&] {
+            for (int64_t p : probes) hits += frozen.contains(p);
+        });
+        do_not_optimize(hits);
+        report("sorted vector binary_search" + suffix, sorted_ns / LOOKUPS, "ns/lookup");
+        report("FrozenTreeSet contains" + suffix, frozen_ns / LOOKUPS, "ns/lookup");
+        if (tree_ns > 0) report("speedup over TreeSet" + suffix, tree_ns / frozen_ns, "x");
+    }
+    return 0;
+}
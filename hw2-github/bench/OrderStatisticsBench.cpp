@@ -0,0 +1,66 @@
+// Memory overhead and latency of the OrderStatistics augmentation:
+// insert cost, select(k) versus to_vector()[k], and count_range(lo, hi)
+// versus a linear scan.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/OrderStatisticsBench.cpp -o order_statistics_bench
+
+#include <algorithm>
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+int main(int argc, char **argv)
+{
+    using PlainSet = TreeSet<int>;
+    using RankedSet = TreeSet<int, DefaultComparator<int>, OrderStatistics>;
+
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t queries = 1000;
+    std::vector<int> keys = random_ints(n);
+
+    report("bytes per node, plain", PlainSet::bytes_per_node(), "B");
+    report("bytes per node, order statistics", RankedSet::bytes_per_node(), "B");
+
+    PlainSet plain;
+    RankedSet ranked;
+    double plain_insert_ns = time_ns([&] {
+        for (int k : keys) plain.add(k);
+    });
+    double ranked_insert_ns = time_ns([&] {
+        for (int k : keys) ranked.add(k);
+    });
+    report("add, plain", plain_insert_ns / n, "ns/op");
+    report("add, order statistics", ranked_insert_ns / n, "ns/op");
+
+    std::vector<size_t> positions(queries);
+    for (size_t i = 0; i < queries; ++i) positions[i] = (i * 7919) % ranked.size();
+
+    long long sum = 0;
+    double scan_select_ns = time_ns([&] {
+        for (size_t i = 0; i < 10; ++i) sum += plain.to_vector()[positions[i]];
+    });
+    double select_ns = time_ns([&] {
+        for (size_t k : positions) sum += *ranked.select(k);
+    });
+    report("k-th smallest via to_vector()", scan_select_ns / 10, "ns/query");
+    report("k-th smallest via select()", select_ns / queries, "ns/query");
+
+    size_t count = 0;
+    double scan_count_ns = time_ns([&] {
+        for (size_t i = 0; i < 10; ++i) {
+            int lo = keys[i], hi = lo / 2 + (1 << 29);
+            for (int x : plain) count += (x >= lo && x <= hi);
+        }
+    });
+    double count_ns = time_ns([&] {
+        for (size_t i = 0; i < queries; ++i) {
+            int lo = keys[i], hi = lo / 2 + (1 << 29);
+            count += ranked.count_range(lo, hi);
+        }
+    });
+    report("count in [lo, hi] via scan", scan_count_ns / 10, "ns/query");
+    report("count in [lo, hi] via count_range()", count_ns / queries, "ns/query");
+
+    do_not_optimize(sum);
+    do_not_optimize(count);
+    return 0;
+}
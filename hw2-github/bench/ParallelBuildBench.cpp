@@ -0,0 +1,35 @@
+// Scaling of TreeSet::build (parallel sort, dedupe and subtree construction)
+// and TreeSet::to_vector(threads) from 1 to 32 threads on unsorted ints.
+//
+//   g++ -std=c++17 -O2 -pthread -Ilib bench/ParallelBuildBench.cpp -o parallel_build_bench
+//   ./parallel_build_bench [n = 10000000] [max_threads = 32]
+
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const unsigned max_threads = argc > 2 ? std::stoul(argv[2]) : 32;
+    std::vector<int> items = random_ints(n);
+
+    double build_base = 0, export_base = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        TreeSet<int> s;
+        double build_ns = time_ns([&] { s.build(items, threads); });
+        std::vector<int> out;
+        double export_ns = time_ns([&] { out = s.to_vector(threads); });
+        do_not_optimize(out.back());
+        if (threads == 1) {
+            build_base = build_ns;
+            export_base = export_ns;
+        }
+
+        std::string suffix = ", " + std::to_string(threads) + " threads";
+        report("build" + suffix, build_ns / 1e6, "ms");
+        report("build speedup" + suffix, build_base / build_ns, "x");
+        report("to_vector" + suffix, export_ns / 1e6, "ms");
+        report("to_vector speedup" + suffix, export_base / export_ns, "x");
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// TreeSet<uint32_t> versus the compressed RoaringSet<uint32_t> on three
+// shapes of data: one dense range of IDs, random IDs at half density, and
+// sparse random IDs. Reports memory per element, add and contains speed, and
+// the throughput of union (+) and intersection (&) of two such sets.
+// Adding sparse IDs one at a time to a RoaringSet is slow, because each new
+// chunk is inserted into a sorted vector; the bulk constructor avoids that.
+//
+//   g++ -std=c++17 -O2 -march=native -Ilib bench/RoaringBench.cpp -o roaring_bench
+//   ./roaring_bench [n = 1000000]
+
+#include <algorithm>
+#include "Bench.hpp"
+#include "RoaringSet.cpp"
+#include "TreeSet.cpp"
+
+template <typename Set>
+void run(const std::string &name, const std::vector<uint32_t> &a, const std::vector<uint32_t> &b, double bytes)
+{
+    Set x;
+    double add_ns = time_ns([&] {
+        for (uint32_t v : a) x.add(v);
+    });
+    Set built;
+    double build_ns = time_ns([&] { built = Set(a); });
+    const Set sa(a), sb(b);
+
+    size_t hits = 0;
+    double contains_ns = time_ns([&] {
+        for (uint32_t v : b) hits += sa.contains(v);
+    });
+    size_t sizes = 0;
+    double union_ns = time_ns([&] { sizes += (sa + sb).size(); });
+    double intersect_ns = time_ns([&] { sizes += (sa & sb).size(); });
+    do_not_optimize(hits);
+    do_not_optimize(sizes);
+
+    report(name + " bytes per element", bytes, "B");
+    report(name + " add", add_ns / a.size(), "ns/op");
+    report(name + " build from vector", build_ns / a.size(), "ns/element");
+    report(name + " contains", contains_ns / b.size(), "ns/op");
+    report(name + " a + b", (a.size() + b.size()) / union_ns * 1000, "M elements/s");
+    report(name + " a & b", (a.size() + b.size()) / intersect_ns * 1000, "M elements/s");
+}
+
+void compare(const std::string &shape, std::vector<uint32_t> a, std::vector<uint32_t> b)
+{
+    std::printf("-- %s, |a| = %zu, |b| = %zu\n", shape.c_str(), a.size(), b.size());
+    using Node = BinaryTreeNode<uint32_t, NoAugment, WideNode>;
+    run<TreeSet<uint32_t>>("TreeSet", a, b, NodePool<Node>::bytes_per_node());
+    run<RoaringSet<uint32_t>>("RoaringSet", a, b, RoaringSet<uint32_t>(a).bytes_per_element());
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    std::mt19937 rng(42);
+
+    // two overlapping ranges of consecutive IDs
+    std::vector<uint32_t> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<uint32_t>(i);
+        b[i] = static_cast<uint32_t>(i + n / 2);
+    }
+    compare("dense ranges", a, b);
+
+    // every ID in [0, 2n) with probability 1/2
+    a.clear();
+    b.clear();
+    for (uint32_t v = 0; v < 2 * n; ++v) {
+        if (rng() % 2) a.push_back(v);
+        if (rng() % 2) b.push_back(v);
+    }
+    std::shuffle(a.begin(), a.end(), rng);
+    std::shuffle(b.begin(), b.end(), rng);
+    compare("random, half density", a, b);
+
+    // n random IDs from the whole 32-bit range, sharing half of them
+    a.resize(n);
+    b.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<uint32_t>(rng());
+        b[i] = i % 2 ? a[i] : static_cast<uint32_t>(rng());
+    }
+    compare("sparse random", a, b);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// Contention benchmark for multi-threaded counters: every thread increments
+// random keys, drawn uniformly or with a hot set taking 90% of the traffic.
+// Compares one TreeMap behind a single std::mutex with ShardedTreeMap at
+// several shard counts, from 1 to `max_threads` threads, and times a merged
+// to_vector() of the result. Shards only pay off once threads run on
+// separate cores; on fewer cores this shows the cost of the extra hashing.
+//
+//   g++ -std=c++17 -O2 -march=native -pthread -Ilib bench/ShardedBench.cpp -o sharded_bench
+//   ./sharded_bench [keys = 100000] [ops_per_thread = 1000000] [max_threads = 16]
+
+#include <mutex>
+#include <thread>
+#include "Bench.hpp"
+#include "ShardedTreeMap.cpp"
+
+/// TreeMap with every call under one lock, the baseline
+class LockedTreeMap
+{
+private:
+    TreeMap<int, long> _map;
+    std::mutex _mutex;
+
+public:
+    void increment(int key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_map.find_or_insert(key);
+    }
+    size_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _map.size();
+    }
+};
+
+void increment(LockedTreeMap &map, int key) { map.increment(key); }
+void increment(ShardedTreeMap<int, long> &map, int key) {
+    map.update(key, [](long &count) { ++count; });
+}
+
+/// @return million increments per second over all threads
+template <typename Map>
+double run(Map &map, unsigned threads, size_t ops, int keys, bool skewed)
+{
+    std::vector<std::thread> workers;
+    double ns = time_ns([&] {
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(t + 1);
+                const int hot = std::max(1, keys / 100);
+                for (size_t i = 0; i < ops; ++i) {
+                    int key = skewed && rng() % 10 ? static_cast<int>(rng() % hot) : static_cast<int>(rng() % keys);
+                    increment(map, key);
+                }
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    });
+    do_not_optimize(map.size());
+    return threads * ops / ns * 1000;
+}
+
+int main(int argc, char **argv)
+{
+    const int keys = argc > 1 ? std::stoi(argv[1]) : 100000;
+    const size_t ops = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const unsigned max_threads = argc > 3 ? std::stoul(argv[3]) : 16;
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+    for (bool skewed : { false, true }) {
+        std::printf("-- %s\n", skewed ? "skewed keys, 1% of them get 90% of increments" : "uniform keys");
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            std::string suffix = ", " + std::to_string(threads) + " threads";
+            LockedTreeMap locked;
+            report("mutex + TreeMap" + suffix, run(locked, threads, ops, keys, skewed), "M increments/s");
+            for (size_t shards : { 4, 16, 64 }) {
+                ShardedTreeMap<int, long> sharded(shards);
+                std::string name = "ShardedTreeMap, " + std::to_string(shards) + " shards" + suffix;
+                report(name, run(sharded, threads, ops, keys, skewed), "M increments/s");
+            }
+        }
+    }
+
+    ShardedTreeMap<int, long> sharded;
+    run(sharded, 1, ops, keys, false);
+    std::vector<std::pair<int, long>> entries;
+    double merge_ns = time_ns([&] { entries = sharded.to_vector(); });
+    do_not_optimize(entries.back());
+    report("to_vector, " + std::to_string(sharded.shard_count()) + "-way merge", merge_ns / entries.size(), "ns/entry");
+    return 0;
+}
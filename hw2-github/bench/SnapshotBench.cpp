@@ -0,0 +1,100 @@
+// Read throughput of a TreeSet behind a mutex versus PersistentTreeSet
+// snapshots, with one writer adding and removing keys the whole time.
+// Each reader takes a snapshot (or the lock) per batch of 64 lookups. The
+// writer's rate is reported too: with fewer cores than threads, a reader
+// descheduled while holding the mutex stalls the writer, which flatters the
+// mutex's read rate.
+//
+//   g++ -std=c++17 -O2 -pthread -Ilib bench/SnapshotBench.cpp -o snapshot_bench
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "Bench.hpp"
+#include "PersistentTreeSet.cpp"
+#include "TreeSet.cpp"
+
+static const size_t N = 100000;
+static const int BATCH = 64;
+static const auto DURATION = std::chrono::milliseconds(300);
+
+struct Rates {
+    double lookups; // per second, summed over all readers
+    double writes;  // per second
+};
+
+template <typename Writer, typename Reader>
+Rates run(unsigned readers, Writer write, Reader read)
+{
+    std::atomic<bool> done{false};
+    std::atomic<size_t> lookups{0};
+    std::atomic<size_t> writes{0};
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] {
+        uint32_t i = 0;
+        for (; !done; ++i) write(i);
+        writes = i;
+    });
+    for (unsigned t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<int> keys = random_ints(BATCH * 16, t + 1);
+            size_t count = 0, hits = 0;
+            for (size_t round = 0; !done; ++round) {
+                hits += read(&keys[(round % 16) * BATCH]);
+                count += BATCH;
+            }
+            do_not_optimize(hits);
+            lookups += count;
+        });
+    }
+    std::this_thread::sleep_for(DURATION);
+    done = true;
+    for (auto &thread : threads) thread.join();
+    double ms = std::chrono::duration<double, std::milli>(DURATION).count();
+    return {lookups * 1e3 / ms, writes * 1e3 / ms};
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned max_readers = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> keys = random_ints(N);
+
+    for (unsigned readers = 1; readers <= max_readers; readers *= 2) {
+        TreeSet<int> locked(keys);
+        std::mutex mutex;
+        Rates locked_rate = run(
+            readers,
+            [&](uint32_t i) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (i & 1) locked.remove(keys[i % N]);
+                else locked.add(keys[i % N]);
+            },
+            [&](const int *batch) {
+                std::lock_guard<std::mutex> lock(mutex);
+                size_t hits = 0;
+                for (int b = 0; b < BATCH; ++b) hits += locked.contains(batch[b]);
+                return hits;
+            });
+
+        PersistentTreeSet<int> persistent(keys);
+        Rates snapshot_rate = run(
+            readers,
+            [&](uint32_t i) {
+                if (i & 1) persistent.remove(keys[i % N]);
+                else persistent.add(keys[i % N]);
+            },
+            [&](const int *batch) {
+                auto snapshot = persistent.snapshot();
+                size_t hits = 0;
+                for (int b = 0; b < BATCH; ++b) hits += snapshot.contains(batch[b]);
+                return hits;
+            });
+
+        std::string suffix = ", " + std::to_string(readers) + " readers";
+        report("mutex TreeSet" + suffix, locked_rate.lookups / 1e6, "M lookups/s");
+        report("mutex TreeSet writer" + suffix, locked_rate.writes / 1e3, "K writes/s");
+        report("PersistentTreeSet snapshots" + suffix, snapshot_rate.lookups / 1e6, "M lookups/s");
+        report("PersistentTreeSet writer" + suffix, snapshot_rate.writes / 1e3, "K writes/s");
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Split/join primitives of TreeSet<int> and the set operations built on them.
+// `join` and a `split` with a small side cost O(log n). With a much smaller
+// operand, the split/join `unite`, `intersect` and `subtract` are compared
+// with the operators, which probe the larger set once per element; for
+// operands of similar size, with the merge behind `+`, on 1 and `threads`
+// threads.
+//
+//   g++ -std=c++17 -O2 -pthread -Ilib bench/SplitJoinBench.cpp -o split_join_bench
+//   ./split_join_bench [n = 1000000] [threads = 4]
+
+#include "Bench.hpp"
+#include "TreeSet.cpp"
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const unsigned threads = argc > 2 ? std::stoul(argv[2]) : 4;
+
+    std::vector<int> evens, odds;
+    for (size_t i = 0; i < n; ++i) {
+        evens.push_back(static_cast<int>(2 * i));
+        odds.push_back(static_cast<int>(2 * i + 1));
+    }
+    const TreeSet<int> large(evens);
+
+    // split off the last 1000 elements and join them back, n / 1000 times
+    {
+        TreeSet<int> s = large;
+        const size_t rounds = 1000;
+        double split_ns = 0, join_ns = 0;
+        for (size_t r = 0; r < rounds; ++r) {
+            int key = static_cast<int>(2 * (n - 1000 - r));
+            TreeSet<int> tail;
+            split_ns += time_ns([&] { tail = s.split(key); });
+            join_ns += time_ns([&] { s = TreeSet<int>::join(std::move(s), key - 1, std::move(tail)); });
+            s.remove(key - 1);
+        }
+        report("split(key), 1000 elements split off", split_ns / rounds / 1000, "us");
+        report("join(left, pivot, right)", join_ns / rounds / 1000, "us");
+        do_not_optimize(s.size());
+    }
+
+    // lopsided operands: m random elements against n
+    for (size_t m : {size_t(100), size_t(10000)}) {
+        std::vector<int> random = random_ints(m);
+        for (int &x : random) x = static_cast<int>(static_cast<unsigned>(x) % (2 * n));
+        const TreeSet<int> small(random);
+        std::string suffix = ", m = " + std::to_string(m);
+        size_t sizes = 0;
+
+        TreeSet<int> probed = large;
+        report("large += small" + suffix, time_ns([&] { probed += small; }) / 1000, "us");
+        TreeSet<int> joined = large;
+        report("large.unite(small)" + suffix, time_ns([&] { joined.unite(small); }) / 1000, "us");
+        report("small & large" + suffix, time_ns([&] { sizes += (small & large).size(); }) / 1000, "us");
+        report("copy of small, intersect(large)" + suffix, time_ns([&] {
+                   TreeSet<int> result = small;
+                   sizes += result.intersect(large).size();
+               }) / 1000, "us");
+        report("small - large" + suffix, time_ns([&] { sizes += (small - large).size(); }) / 1000, "us");
+        report("copy of small, subtract(large)" + suffix, time_ns([&] {
+                   TreeSet<int> result = small;
+                   sizes += result.subtract(large).size();
+               }) / 1000, "us");
+        do_not_optimize(sizes + probed.size() + joined.size());
+    }
+
+    // operands of the same size: merge versus split/join on 1 and `threads` threads
+    const TreeSet<int> other(odds);
+    report("large + other (merge and rebuild)", time_ns([&] { do_not_optimize((large + other).size()); }) / 1e6, "ms");
+    for (unsigned t : {1u, threads}) {
+        std::string suffix = ", " + std::to_string(t) + " threads";
+        TreeSet<int> u = large;
+        report("unite" + suffix, time_ns([&] { u.unite(other, t); }) / 1e6, "ms");
+        TreeSet<int> i = u;
+        report("intersect" + suffix, time_ns([&] { i.intersect(large, t); }) / 1e6, "ms");
+        report("subtract" + suffix, time_ns([&] { u.subtract(large, t); }) / 1e6, "ms");
+        do_not_optimize(u.size() + i.size());
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Startup cost of a TreeMap<int64_t, int64_t>: inserting every entry one by
+// one (parsing a text source excluded), against loading a sorted-run file
+// written by TreeMap::save, and against serving reads from the mapped file
+// with MappedTreeMap. The file is read right after being written, so it is
+// warm in the page cache; cold starts add the disk read.
+//
+//   g++ -std=c++17 -O2 -Ilib bench/StartupBench.cpp -o startup_bench -pthread
+//   ./startup_bench [n = 10000000] [path = /tmp/startup_bench.run] [threads = hardware]
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "Bench.hpp"
+#include "MappedTreeSet.cpp"
+#include "TreeMap.cpp"
+
+static const size_t LOOKUPS = 1000;
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    const std::string path = argc > 2 ? argv[2] : "/tmp/startup_bench.run";
+    const unsigned threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<int> random = random_ints(n);
+    std::vector<int64_t> probes;
+    for (int x : random_ints(LOOKUPS, 7)) probes.push_back(static_cast<uint32_t>(x));
+    std::string suffix = ", n=" + std::to_string(n);
+    int64_t checksum = 0;
+
+    {
+        TreeMap<int64_t, int64_t> map;
+        double insert_ns = time_ns([&] {
+            for (size_t i = 0; i < n; ++i) map.insert(static_cast<uint32_t>(random[i]), static_cast<int64_t>(i));
+        });
+        report("insert one by one" + suffix, insert_ns / 1e6, "ms");
+        double save_ns = time_ns([&] { map.save(path); });
+        report("save" + suffix, save_ns / 1e6, "ms");
+    }
+
+    for (unsigned t : { 1u, threads }) {
+        TreeMap<int64_t, int64_t> map;
+        double load_ns = time_ns([&] { map.load(path, t); });
+        report("load and build, threads=" + std::to_string(t) + suffix, load_ns / 1e6, "ms");
+        for (int64_t p : probes) checksum += map.get(p).value_or(0);
+        if (t == threads) break;
+    }
+
+    double open_ns = time_ns([&] {
+        MappedTreeMap<int64_t, int64_t> mapped(path);
+        for (int64_t p : probes) checksum += mapped.get(p).value_or(0);
+    });
+    report("map file and serve " + std::to_string(LOOKUPS) + " reads" + suffix, open_ns / 1e6, "ms");
+
+    do_not_optimize(checksum);
+    std::remove(path.c_str());
+    return 0;
+}
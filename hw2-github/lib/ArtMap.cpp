@@ -0,0 +1,902 @@
+#ifndef ART_MAP_CPP
+#define ART_MAP_CPP
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include "ArtMap.hpp"
+
+// Constructor
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes>::ArtMap() : _root(nullptr), _first(nullptr), _last(nullptr), _size(0) {}
+
+// Constructor - initial items, the last value wins for repeated keys
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes>::ArtMap(const std::vector<std::pair<TKey, TValue>> &items) : ArtMap() {
+    for (const auto &item : items) {
+        insert(item.first, item.second);
+    }
+}
+
+// Copy constructor
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes>::ArtMap(const ArtMap &other) : ArtMap() {
+    for (const auto &entry : other) {
+        insert(entry.first, entry.second);
+    }
+}
+
+// Move constructor
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes>::ArtMap(ArtMap &&other) noexcept
+    : _root(other._root), _first(other._first), _last(other._last), _size(other._size),
+      _leaves(std::move(other._leaves)), _nodes4(std::move(other._nodes4)), _nodes16(std::move(other._nodes16)),
+      _nodes48(std::move(other._nodes48)), _nodes256(std::move(other._nodes256)) {
+    other._root = nullptr;
+    other._first = nullptr;
+    other._last = nullptr;
+    other._size = 0;
+}
+
+// Copy assignment
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes> &ArtMap<TKey, TValue, KeyBytes>::operator=(const ArtMap &other) {
+    if (this != &other) {
+        ArtMap copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Move assignment
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes> &ArtMap<TKey, TValue, KeyBytes>::operator=(ArtMap &&other) noexcept {
+    if (this != &other) {
+        clear();
+        _root = other._root;
+        _first = other._first;
+        _last = other._last;
+        _size = other._size;
+        _leaves = std::move(other._leaves);
+        _nodes4 = std::move(other._nodes4);
+        _nodes16 = std::move(other._nodes16);
+        _nodes48 = std::move(other._nodes48);
+        _nodes256 = std::move(other._nodes256);
+        other._root = nullptr;
+        other._first = nullptr;
+        other._last = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+// Destructor
+template <typename TKey, typename TValue, typename KeyBytes>
+ArtMap<TKey, TValue, KeyBytes>::~ArtMap() {
+    clear();
+}
+
+// Lexicographic comparison of unsigned bytes, shorter first on a tie
+template <typename TKey, typename TValue, typename KeyBytes>
+int ArtMap<TKey, TValue, KeyBytes>::compare_bytes(ArtBytes a, ArtBytes b) {
+    size_t common = std::min(a.size, b.size);
+    int cmp = common ? std::memcmp(a.data, b.data, common) : 0;
+    if (cmp != 0) return cmp;
+    return (a.size < b.size) ? -1 : (a.size > b.size) ? 1 : 0;
+}
+
+// Leaf from the pool
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::create_leaf(const TKey &key, TValue value) {
+    return new (_leaves.allocate()) Leaf{{key, std::move(value)}};
+}
+
+// Leaf back to the pool
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::destroy_leaf(Leaf *leaf) {
+    leaf->~Leaf();
+    _leaves.deallocate(leaf);
+}
+
+// Inner node from the pool of its type
+template <typename TKey, typename TValue, typename KeyBytes>
+template <typename N>
+N *ArtMap<TKey, TValue, KeyBytes>::create_node() {
+    if constexpr (std::is_same<N, Node4>::value) {
+        return new (_nodes4.allocate()) Node4();
+    } else if constexpr (std::is_same<N, Node16>::value) {
+        return new (_nodes16.allocate()) Node16();
+    } else if constexpr (std::is_same<N, Node48>::value) {
+        return new (_nodes48.allocate()) Node48();
+    } else {
+        return new (_nodes256.allocate()) Node256();
+    }
+}
+
+// Inner node back to the pool of its type; nodes hold no resources of their own
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::destroy_node(Node *node) {
+    switch (node->_type) {
+    case Node4Type:
+        _nodes4.deallocate(node);
+        break;
+    case Node16Type:
+        _nodes16.deallocate(node);
+        break;
+    case Node48Type:
+        _nodes48.deallocate(node);
+        break;
+    case Node256Type:
+        _nodes256.deallocate(node);
+        break;
+    }
+}
+
+// Splices a leaf into the ordered leaf list
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::link_before(Leaf *leaf, Leaf *next) {
+    Leaf *prev = next ? next->_prev : _last;
+    leaf->_prev = prev;
+    leaf->_next = next;
+    (prev ? prev->_next : _first) = leaf;
+    (next ? next->_prev : _last) = leaf;
+}
+
+// Takes a leaf out of the ordered leaf list
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::unlink(Leaf *leaf) {
+    (leaf->_prev ? leaf->_prev->_next : _first) = leaf->_next;
+    (leaf->_next ? leaf->_next->_prev : _last) = leaf->_prev;
+}
+
+// Leftmost leaf: an end leaf comes before every child
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::min_leaf(const Node *child) {
+    while (!is_leaf(child)) {
+        if (child->_end) return child->_end;
+        child = next_child(child, -1);
+    }
+    return as_leaf(child);
+}
+
+// Rightmost leaf
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::max_leaf(const Node *child) {
+    while (!is_leaf(child)) {
+        if (child->_count == 0) return child->_end;
+        child = previous_child(child, 256);
+    }
+    return as_leaf(child);
+}
+
+// Child slot for a byte
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Node **ArtMap<TKey, TValue, KeyBytes>::find_child(const Node *node, uint8_t byte) {
+    switch (node->_type) {
+    case Node4Type: {
+        Node4 *n = static_cast<Node4 *>(const_cast<Node *>(node));
+        for (size_t i = 0; i < n->_count; ++i) {
+            if (n->_keys[i] == byte) return &n->_children[i];
+        }
+        return nullptr;
+    }
+    case Node16Type: {
+        Node16 *n = static_cast<Node16 *>(const_cast<Node *>(node));
+        size_t pos = 0;
+#if defined(__GNUC__)
+        // count the keys below `byte` in one 16-byte compare; each true lane is -1
+        typedef uint8_t Vec __attribute__((vector_size(16)));
+        Vec keys, needle, lanes, count;
+        std::memcpy(&keys, n->_keys, sizeof(keys));
+        for (uint8_t lane = 0; lane < 16; ++lane) {
+            needle[lane] = byte;
+            lanes[lane] = lane;
+            count[lane] = static_cast<uint8_t>(n->_count);
+        }
+        auto below = (keys < needle) & (lanes < count);
+        for (size_t lane = 0; lane < 16; ++lane) {
+            pos -= below[lane];
+        }
+#else
+        while (pos < n->_count && n->_keys[pos] < byte) {
+            ++pos;
+        }
+#endif
+        return (pos < n->_count && n->_keys[pos] == byte) ? &n->_children[pos] : nullptr;
+    }
+    case Node48Type: {
+        Node48 *n = static_cast<Node48 *>(const_cast<Node *>(node));
+        return n->_index[byte] ? &n->_children[n->_index[byte] - 1] : nullptr;
+    }
+    default: {
+        Node256 *n = static_cast<Node256 *>(const_cast<Node *>(node));
+        return n->_children[byte] ? &n->_children[byte] : nullptr;
+    }
+    }
+}
+
+// Smallest child under a byte greater than `after`
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Node *ArtMap<TKey, TValue, KeyBytes>::next_child(const Node *node, int after, uint8_t *byte) {
+    switch (node->_type) {
+    case Node4Type:
+    case Node16Type: {
+        const uint8_t *keys = node->_type == Node4Type ? static_cast<const Node4 *>(node)->_keys
+                                                       : static_cast<const Node16 *>(node)->_keys;
+        Node *const *children = node->_type == Node4Type ? static_cast<const Node4 *>(node)->_children
+                                                         : static_cast<const Node16 *>(node)->_children;
+        for (size_t i = 0; i < node->_count; ++i) {
+            if (keys[i] > after) {
+                if (byte) *byte = keys[i];
+                return children[i];
+            }
+        }
+        return nullptr;
+    }
+    case Node48Type: {
+        const Node48 *n = static_cast<const Node48 *>(node);
+        for (int b = after + 1; b < 256; ++b) {
+            if (n->_index[b]) {
+                if (byte) *byte = static_cast<uint8_t>(b);
+                return n->_children[n->_index[b] - 1];
+            }
+        }
+        return nullptr;
+    }
+    default: {
+        const Node256 *n = static_cast<const Node256 *>(node);
+        for (int b = after + 1; b < 256; ++b) {
+            if (n->_children[b]) {
+                if (byte) *byte = static_cast<uint8_t>(b);
+                return n->_children[b];
+            }
+        }
+        return nullptr;
+    }
+    }
+}
+
+// Largest child under a byte less than `before`
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Node *ArtMap<TKey, TValue, KeyBytes>::previous_child(const Node *node, int before) {
+    switch (node->_type) {
+    case Node4Type:
+    case Node16Type: {
+        const uint8_t *keys = node->_type == Node4Type ? static_cast<const Node4 *>(node)->_keys
+                                                       : static_cast<const Node16 *>(node)->_keys;
+        Node *const *children = node->_type == Node4Type ? static_cast<const Node4 *>(node)->_children
+                                                         : static_cast<const Node16 *>(node)->_children;
+        for (size_t i = node->_count; i-- > 0;) {
+            if (keys[i] < before) return children[i];
+        }
+        return nullptr;
+    }
+    case Node48Type: {
+        const Node48 *n = static_cast<const Node48 *>(node);
+        for (int b = before - 1; b >= 0; --b) {
+            if (n->_index[b]) return n->_children[n->_index[b] - 1];
+        }
+        return nullptr;
+    }
+    default: {
+        const Node256 *n = static_cast<const Node256 *>(node);
+        for (int b = before - 1; b >= 0; --b) {
+            if (n->_children[b]) return n->_children[b];
+        }
+        return nullptr;
+    }
+    }
+}
+
+// Prefix and end leaf of `from`
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::copy_header(Node *to, const Node *from) {
+    std::memcpy(to->_prefix, from->_prefix, MAX_PREFIX);
+    to->_prefix_length = from->_prefix_length;
+    to->_end = from->_end;
+}
+
+// Adds a child, moving a full node into the next larger type first
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::add_child(Node *&ref, uint8_t byte, Node *child) {
+    Node *node = ref;
+    if (node->_type == Node4Type && node->_count == 4) {
+        Node4 *old = static_cast<Node4 *>(node);
+        Node16 *grown = create_node<Node16>();
+        copy_header(grown, old);
+        std::memcpy(grown->_keys, old->_keys, sizeof(old->_keys));
+        std::memcpy(grown->_children, old->_children, sizeof(old->_children));
+        grown->_count = 4;
+        destroy_node(old);
+        ref = node = grown;
+    } else if (node->_type == Node16Type && node->_count == 16) {
+        Node16 *old = static_cast<Node16 *>(node);
+        Node48 *grown = create_node<Node48>();
+        copy_header(grown, old);
+        for (size_t i = 0; i < 16; ++i) {
+            grown->_index[old->_keys[i]] = static_cast<uint8_t>(i + 1);
+            grown->_children[i] = old->_children[i];
+        }
+        grown->_count = 16;
+        destroy_node(old);
+        ref = node = grown;
+    } else if (node->_type == Node48Type && node->_count == 48) {
+        Node48 *old = static_cast<Node48 *>(node);
+        Node256 *grown = create_node<Node256>();
+        copy_header(grown, old);
+        for (size_t b = 0; b < 256; ++b) {
+            if (old->_index[b]) grown->_children[b] = old->_children[old->_index[b] - 1];
+        }
+        grown->_count = 48;
+        destroy_node(old);
+        ref = node = grown;
+    }
+
+    switch (node->_type) {
+    case Node4Type:
+    case Node16Type: {
+        uint8_t *keys = node->_type == Node4Type ? static_cast<Node4 *>(node)->_keys : static_cast<Node16 *>(node)->_keys;
+        Node **children = node->_type == Node4Type ? static_cast<Node4 *>(node)->_children
+                                                   : static_cast<Node16 *>(node)->_children;
+        size_t pos = 0;
+        while (pos < node->_count && keys[pos] < byte) {
+            ++pos;
+        }
+        std::memmove(keys + pos + 1, keys + pos, node->_count - pos);
+        std::memmove(children + pos + 1, children + pos, (node->_count - pos) * sizeof(Node *));
+        keys[pos] = byte;
+        children[pos] = child;
+        break;
+    }
+    case Node48Type: {
+        Node48 *n = static_cast<Node48 *>(node);
+        n->_children[n->_count] = child;
+        n->_index[byte] = static_cast<uint8_t>(n->_count + 1);
+        break;
+    }
+    default:
+        static_cast<Node256 *>(node)->_children[byte] = child;
+        break;
+    }
+    node->_count++;
+}
+
+// Removes a child, moving a sparse node into the next smaller type
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::remove_child(Node *&ref, uint8_t byte) {
+    Node *node = ref;
+    switch (node->_type) {
+    case Node4Type:
+    case Node16Type: {
+        uint8_t *keys = node->_type == Node4Type ? static_cast<Node4 *>(node)->_keys : static_cast<Node16 *>(node)->_keys;
+        Node **children = node->_type == Node4Type ? static_cast<Node4 *>(node)->_children
+                                                   : static_cast<Node16 *>(node)->_children;
+        size_t pos = static_cast<size_t>(find_child(node, byte) - children);
+        std::memmove(keys + pos, keys + pos + 1, node->_count - pos - 1);
+        std::memmove(children + pos, children + pos + 1, (node->_count - pos - 1) * sizeof(Node *));
+        break;
+    }
+    case Node48Type: {
+        // keep the children dense by moving the last one into the hole
+        Node48 *n = static_cast<Node48 *>(node);
+        uint8_t slot = n->_index[byte] - 1;
+        uint8_t last = static_cast<uint8_t>(n->_count - 1);
+        n->_index[byte] = 0;
+        if (slot != last) {
+            n->_children[slot] = n->_children[last];
+            for (size_t b = 0; b < 256; ++b) {
+                if (n->_index[b] == last + 1) {
+                    n->_index[b] = slot + 1;
+                    break;
+                }
+            }
+        }
+        break;
+    }
+    default:
+        static_cast<Node256 *>(node)->_children[byte] = nullptr;
+        break;
+    }
+    node->_count--;
+
+    // shrink a little below the size the node grew at, so that a key added
+    // and removed at the boundary does not convert the node every time
+    if (node->_type == Node256Type && node->_count <= 36) {
+        Node256 *old = static_cast<Node256 *>(node);
+        Node48 *shrunk = create_node<Node48>();
+        copy_header(shrunk, old);
+        for (size_t b = 0; b < 256; ++b) {
+            if (old->_children[b]) {
+                shrunk->_children[shrunk->_count] = old->_children[b];
+                shrunk->_index[b] = static_cast<uint8_t>(++shrunk->_count);
+            }
+        }
+        destroy_node(old);
+        ref = shrunk;
+    } else if (node->_type == Node48Type && node->_count <= 12) {
+        Node48 *old = static_cast<Node48 *>(node);
+        Node16 *shrunk = create_node<Node16>();
+        copy_header(shrunk, old);
+        for (size_t b = 0; b < 256; ++b) {
+            if (old->_index[b]) {
+                shrunk->_keys[shrunk->_count] = static_cast<uint8_t>(b);
+                shrunk->_children[shrunk->_count++] = old->_children[old->_index[b] - 1];
+            }
+        }
+        destroy_node(old);
+        ref = shrunk;
+    } else if (node->_type == Node16Type && node->_count <= 3) {
+        Node16 *old = static_cast<Node16 *>(node);
+        Node4 *shrunk = create_node<Node4>();
+        copy_header(shrunk, old);
+        std::memcpy(shrunk->_keys, old->_keys, old->_count);
+        std::memcpy(shrunk->_children, old->_children, old->_count * sizeof(Node *));
+        shrunk->_count = old->_count;
+        destroy_node(old);
+        ref = shrunk;
+    } else if (entries(node) <= 1) {
+        collapse(ref);
+    }
+}
+
+// A node left with one entry is replaced by it; an inner child takes over
+// the node's prefix and the byte it hung under
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::collapse(Node *&ref) {
+    Node *node = ref;
+    if (node->_count == 0) {
+        ref = tag(node->_end);
+        destroy_node(node);
+        return;
+    }
+    uint8_t byte = 0;
+    Node *child = next_child(node, -1, &byte);
+    if (!is_leaf(child)) {
+        uint8_t prefix[MAX_PREFIX];
+        size_t length = std::min<size_t>(node->_prefix_length, MAX_PREFIX);
+        std::memcpy(prefix, node->_prefix, length);
+        if (length < MAX_PREFIX) {
+            prefix[length++] = byte;
+        }
+        size_t rest = std::min<size_t>(child->_prefix_length, MAX_PREFIX - length);
+        std::memcpy(prefix + length, child->_prefix, rest);
+        std::memcpy(child->_prefix, prefix, length + rest);
+        child->_prefix_length += node->_prefix_length + 1;
+    }
+    ref = child;
+    destroy_node(node);
+}
+
+// Full prefix comparison; bytes past the stored ones come from a leaf below
+template <typename TKey, typename TValue, typename KeyBytes>
+int ArtMap<TKey, TValue, KeyBytes>::compare_prefix(const Node *node, ArtBytes key, size_t depth, size_t &matched) {
+    const uint8_t *prefix = node->_prefix;
+    uint8_t buffer[KeyBytes::BUFFER];
+    if (node->_prefix_length > MAX_PREFIX) {
+        prefix = key_bytes(min_leaf(node)->_entry.first, buffer).data + depth;
+    }
+    for (matched = 0; matched < node->_prefix_length; ++matched) {
+        if (depth + matched == key.size) return -1; // key is a proper prefix of every key below
+        int diff = int(key.data[depth + matched]) - int(prefix[matched]);
+        if (diff != 0) return diff;
+    }
+    return 0;
+}
+
+// Recursive insertion. The new leaf is linked into the leaf list next to
+// the neighbour found where it is attached, so no second descent is needed.
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::insert(Node *&ref, ArtBytes key, size_t depth,
+                                                                                      const TKey &original, TValue &value,
+                                                                                      bool &created) {
+    if (!ref) {
+        Leaf *leaf = create_leaf(original, std::move(value));
+        link_before(leaf, nullptr);
+        ref = tag(leaf);
+        created = true;
+        return leaf;
+    }
+
+    if (is_leaf(ref)) {
+        // two keys in one slot: a Node4 over their common prefix holds both
+        Leaf *old = as_leaf(ref);
+        uint8_t buffer[KeyBytes::BUFFER];
+        ArtBytes old_key = key_bytes(old->_entry.first, buffer);
+        int cmp = compare_bytes(key, old_key);
+        if (cmp == 0) return old;
+
+        size_t common = 0;
+        while (depth + common < key.size && depth + common < old_key.size &&
+               key.data[depth + common] == old_key.data[depth + common]) {
+            ++common;
+        }
+        Node4 *node = create_node<Node4>();
+        node->_prefix_length = static_cast<uint32_t>(common);
+        std::memcpy(node->_prefix, key.data + depth, std::min(common, MAX_PREFIX));
+        Leaf *leaf = create_leaf(original, std::move(value));
+        link_before(leaf, cmp < 0 ? old : old->_next);
+
+        Node *split = node;
+        size_t at = depth + common;
+        for (Leaf *l : {old, leaf}) {
+            ArtBytes bytes = l == old ? old_key : key;
+            if (bytes.size == at) {
+                node->_end = l;
+            } else {
+                add_child(split, bytes.data[at], tag(l));
+            }
+        }
+        ref = split;
+        created = true;
+        return leaf;
+    }
+
+    Node *node = ref;
+    size_t matched = 0;
+    int cmp = compare_prefix(node, key, depth, matched);
+    if (cmp != 0) {
+        // the key leaves the prefix part way: split it at `matched`
+        Node4 *parent = create_node<Node4>();
+        parent->_prefix_length = static_cast<uint32_t>(matched);
+        std::memcpy(parent->_prefix, node->_prefix, std::min(matched, MAX_PREFIX));
+
+        Leaf *leaf = create_leaf(original, std::move(value));
+        link_before(leaf, cmp < 0 ? min_leaf(node) : max_leaf(node)->_next);
+
+        uint8_t buffer[KeyBytes::BUFFER];
+        const uint8_t *prefix = node->_prefix;
+        if (node->_prefix_length > MAX_PREFIX) {
+            prefix = key_bytes(min_leaf(node)->_entry.first, buffer).data + depth;
+        }
+        uint8_t byte = prefix[matched];
+        size_t rest = node->_prefix_length - matched - 1;
+        std::memmove(node->_prefix, prefix + matched + 1, std::min(rest, MAX_PREFIX));
+        node->_prefix_length = static_cast<uint32_t>(rest);
+
+        Node *split = parent;
+        add_child(split, byte, node);
+        if (key.size == depth + matched) {
+            parent->_end = leaf;
+        } else {
+            add_child(split, key.data[depth + matched], tag(leaf));
+        }
+        ref = split;
+        created = true;
+        return leaf;
+    }
+
+    depth += node->_prefix_length;
+    if (depth == key.size) {
+        if (node->_end) return node->_end;
+        Leaf *leaf = create_leaf(original, std::move(value));
+        link_before(leaf, min_leaf(next_child(node, -1)));
+        node->_end = leaf;
+        created = true;
+        return leaf;
+    }
+
+    Node **child = find_child(node, key.data[depth]);
+    if (child) {
+        return insert(*child, key, depth + 1, original, value, created);
+    }
+    Leaf *leaf = create_leaf(original, std::move(value));
+    Node *next = next_child(node, key.data[depth]);
+    link_before(leaf, next ? min_leaf(next) : max_leaf(node)->_next);
+    add_child(ref, key.data[depth], tag(leaf));
+    created = true;
+    return leaf;
+}
+
+// Recursive removal; nodes shrink and collapse on the way back
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::remove(Node *&ref, ArtBytes key, size_t depth) {
+    uint8_t buffer[KeyBytes::BUFFER];
+    if (!ref) return nullptr;
+    if (is_leaf(ref)) {
+        Leaf *leaf = as_leaf(ref);
+        if (compare_bytes(key, key_bytes(leaf->_entry.first, buffer)) != 0) return nullptr;
+        ref = nullptr;
+        return leaf;
+    }
+
+    Node *node = ref;
+    if (key.size < depth + node->_prefix_length ||
+        std::memcmp(node->_prefix, key.data + depth, std::min<size_t>(node->_prefix_length, MAX_PREFIX)) != 0) {
+        return nullptr;
+    }
+    depth += node->_prefix_length;
+    if (depth == key.size) {
+        Leaf *leaf = node->_end;
+        if (!leaf || compare_bytes(key, key_bytes(leaf->_entry.first, buffer)) != 0) return nullptr;
+        node->_end = nullptr;
+        if (entries(node) <= 1) {
+            collapse(ref);
+        }
+        return leaf;
+    }
+
+    Node **child = find_child(node, key.data[depth]);
+    if (!child) return nullptr;
+    if (is_leaf(*child)) {
+        Leaf *leaf = as_leaf(*child);
+        if (compare_bytes(key, key_bytes(leaf->_entry.first, buffer)) != 0) return nullptr;
+        remove_child(ref, key.data[depth]);
+        return leaf;
+    }
+    return remove(*child, key, depth + 1);
+}
+
+// Lookup that checks only the stored prefix bytes on the way down and
+// compares the whole key once, at the leaf
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::find_leaf(const TKey &key) const {
+    uint8_t buffer[KeyBytes::BUFFER];
+    ArtBytes bytes = key_bytes(key, buffer);
+    const Node *node = _root;
+    size_t depth = 0;
+    while (node && !is_leaf(node)) {
+        if (bytes.size < depth + node->_prefix_length ||
+            std::memcmp(node->_prefix, bytes.data + depth, std::min<size_t>(node->_prefix_length, MAX_PREFIX)) != 0) {
+            return nullptr;
+        }
+        depth += node->_prefix_length;
+        if (depth == bytes.size) {
+            node = node->_end ? tag(node->_end) : nullptr;
+            break;
+        }
+        Node **child = find_child(node, bytes.data[depth]);
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    if (!node) return nullptr;
+    Leaf *leaf = as_leaf(node);
+    uint8_t leaf_buffer[KeyBytes::BUFFER];
+    return compare_bytes(bytes, key_bytes(leaf->_entry.first, leaf_buffer)) == 0 ? leaf : nullptr;
+}
+
+// Descends along `key`; where it leaves the tree, the answer is the
+// smallest leaf of the next subtree or the leaf after the last smaller one
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Leaf *ArtMap<TKey, TValue, KeyBytes>::lower_bound_leaf(ArtBytes key) const {
+    const Node *node = _root;
+    size_t depth = 0;
+    while (node) {
+        if (is_leaf(node)) {
+            // the slot holds the only leaf sharing key[0, depth), so nothing
+            // lies between a smaller leaf and `key`
+            Leaf *leaf = as_leaf(node);
+            uint8_t buffer[KeyBytes::BUFFER];
+            return compare_bytes(key_bytes(leaf->_entry.first, buffer), key) >= 0 ? leaf : leaf->_next;
+        }
+        size_t matched = 0;
+        int cmp = compare_prefix(node, key, depth, matched);
+        if (cmp < 0) return min_leaf(node);
+        if (cmp > 0) return max_leaf(node)->_next;
+        depth += node->_prefix_length;
+        if (depth == key.size) return min_leaf(node);
+        Node **child = find_child(node, key.data[depth]);
+        if (!child) {
+            Node *next = next_child(node, key.data[depth]);
+            return next ? min_leaf(next) : max_leaf(node)->_next;
+        }
+        node = *child;
+        depth++;
+    }
+    return nullptr;
+}
+
+// Returns map elements
+template <typename TKey, typename TValue, typename KeyBytes>
+size_t ArtMap<TKey, TValue, KeyBytes>::size() const {
+    return _size;
+}
+
+// Insert a key-value pair into the map
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::insert(TKey key, TValue value) {
+    uint8_t buffer[KeyBytes::BUFFER];
+    bool created = false;
+    Leaf *leaf = insert(_root, key_bytes(key, buffer), 0, key, value, created);
+    if (created) {
+        _size++;
+    } else {
+        leaf->_entry.second = std::move(value);
+    }
+}
+
+// Value of a key, inserting a value-initialized one first if absent
+template <typename TKey, typename TValue, typename KeyBytes>
+TValue &ArtMap<TKey, TValue, KeyBytes>::operator[](const TKey &key) {
+    uint8_t buffer[KeyBytes::BUFFER];
+    bool created = false;
+    TValue value{};
+    Leaf *leaf = insert(_root, key_bytes(key, buffer), 0, key, value, created);
+    if (created) {
+        _size++;
+    }
+    return leaf->_entry.second;
+}
+
+// Remove a key from the map
+template <typename TKey, typename TValue, typename KeyBytes>
+bool ArtMap<TKey, TValue, KeyBytes>::remove(const TKey &key) {
+    uint8_t buffer[KeyBytes::BUFFER];
+    Leaf *leaf = remove(_root, key_bytes(key, buffer), 0);
+    if (!leaf) return false;
+    unlink(leaf);
+    destroy_leaf(leaf);
+    _size--;
+    return true;
+}
+
+// Get key value
+template <typename TKey, typename TValue, typename KeyBytes>
+std::optional<TValue> ArtMap<TKey, TValue, KeyBytes>::get(const TKey &key) const {
+    Leaf *leaf = find_leaf(key);
+    return leaf ? std::optional<TValue>(leaf->_entry.second) : std::nullopt;
+}
+
+// Check if a key is in the map
+template <typename TKey, typename TValue, typename KeyBytes>
+bool ArtMap<TKey, TValue, KeyBytes>::contains(const TKey &key) const {
+    return find_leaf(key) != nullptr;
+}
+
+// Key-value pairs in key order
+template <typename TKey, typename TValue, typename KeyBytes>
+std::vector<std::pair<TKey, TValue>> ArtMap<TKey, TValue, KeyBytes>::to_vector() const {
+    std::vector<std::pair<TKey, TValue>> result;
+    result.reserve(_size);
+    for (const Leaf *leaf = _first; leaf; leaf = leaf->_next) {
+        result.push_back(leaf->_entry);
+    }
+    return result;
+}
+
+// Iterator to the smallest key
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::const_iterator ArtMap<TKey, TValue, KeyBytes>::begin() const {
+    return const_iterator(_first, this);
+}
+
+// Iterator past the largest key
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::const_iterator ArtMap<TKey, TValue, KeyBytes>::end() const {
+    return const_iterator(nullptr, this);
+}
+
+// First entry with key not less than key
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::const_iterator ArtMap<TKey, TValue, KeyBytes>::lower_bound(const TKey &key) const {
+    uint8_t buffer[KeyBytes::BUFFER];
+    return const_iterator(lower_bound_leaf(key_bytes(key, buffer)), this);
+}
+
+// First entry with key greater than key
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::const_iterator ArtMap<TKey, TValue, KeyBytes>::upper_bound(const TKey &key) const {
+    uint8_t buffer[KeyBytes::BUFFER];
+    uint8_t leaf_buffer[KeyBytes::BUFFER];
+    ArtBytes bytes = key_bytes(key, buffer);
+    Leaf *leaf = lower_bound_leaf(bytes);
+    if (leaf && compare_bytes(bytes, key_bytes(leaf->_entry.first, leaf_buffer)) == 0) {
+        leaf = leaf->_next;
+    }
+    return const_iterator(leaf, this);
+}
+
+// Entries equal to key
+template <typename TKey, typename TValue, typename KeyBytes>
+std::pair<typename ArtMap<TKey, TValue, KeyBytes>::const_iterator, typename ArtMap<TKey, TValue, KeyBytes>::const_iterator>
+ArtMap<TKey, TValue, KeyBytes>::equal_range(const TKey &key) const {
+    return {lower_bound(key), upper_bound(key)};
+}
+
+// Entries with keys in [lo, hi]
+template <typename TKey, typename TValue, typename KeyBytes>
+typename ArtMap<TKey, TValue, KeyBytes>::Range ArtMap<TKey, TValue, KeyBytes>::range(const TKey &lo, const TKey &hi) const {
+    uint8_t lo_buffer[KeyBytes::BUFFER];
+    uint8_t hi_buffer[KeyBytes::BUFFER];
+    if (compare_bytes(key_bytes(lo, lo_buffer), key_bytes(hi, hi_buffer)) > 0) return Range(end(), end());
+    return Range(lower_bound(lo), upper_bound(hi));
+}
+
+// Check if the map is empty
+template <typename TKey, typename TValue, typename KeyBytes>
+bool ArtMap<TKey, TValue, KeyBytes>::is_empty() const {
+    return _size == 0;
+}
+
+// Recursive invariant check; leaves are visited in tree order and must
+// appear in the same order in the leaf list
+template <typename TKey, typename TValue, typename KeyBytes>
+bool ArtMap<TKey, TValue, KeyBytes>::check(const Node *child, size_t depth, std::vector<uint8_t> &path,
+                                           const Leaf *&previous, size_t &count) const {
+    uint8_t buffer[KeyBytes::BUFFER];
+    uint8_t previous_buffer[KeyBytes::BUFFER];
+    if (is_leaf(child)) {
+        const Leaf *leaf = as_leaf(child);
+        ArtBytes bytes = key_bytes(leaf->_entry.first, buffer);
+        if (bytes.size < path.size() || (!path.empty() && std::memcmp(bytes.data, path.data(), path.size()) != 0)) {
+            return false;
+        }
+        if (leaf->_prev != previous || (previous ? previous->_next : _first) != leaf) return false;
+        if (previous && compare_bytes(key_bytes(previous->_entry.first, previous_buffer), bytes) >= 0) return false;
+        previous = leaf;
+        count++;
+        return true;
+    }
+
+    static constexpr size_t CAPACITY[] = {4, 16, 48, 256};
+    if (child->_count > CAPACITY[child->_type] || entries(child) < 2) return false;
+
+    // the prefix must match the leaves below, stored bytes included
+    ArtBytes below = key_bytes(min_leaf(child)->_entry.first, buffer);
+    if (below.size < depth + child->_prefix_length) return false;
+    if (std::memcmp(child->_prefix, below.data + depth, std::min<size_t>(child->_prefix_length, MAX_PREFIX)) != 0) {
+        return false;
+    }
+    size_t base = path.size();
+    path.insert(path.end(), below.data + depth, below.data + depth + child->_prefix_length);
+    depth += child->_prefix_length;
+
+    bool ok = true;
+    if (child->_end) {
+        ok = key_bytes(child->_end->_entry.first, buffer).size == depth && check(tag(child->_end), depth, path, previous, count);
+    }
+    size_t children = 0;
+    uint8_t byte = 0;
+    for (const Node *next = next_child(child, -1, &byte); ok && next; next = next_child(child, byte, &byte)) {
+        path.push_back(byte);
+        ok = check(next, depth + 1, path, previous, count);
+        path.pop_back();
+        children++;
+    }
+    path.resize(base);
+    return ok && children == child->_count;
+}
+
+// Validates the radix tree and the leaf list
+template <typename TKey, typename TValue, typename KeyBytes>
+bool ArtMap<TKey, TValue, KeyBytes>::is_valid() const {
+    if (!_root) return _size == 0 && !_first && !_last;
+    std::vector<uint8_t> path;
+    const Leaf *previous = nullptr;
+    size_t count = 0;
+    // a lone leaf at the root is fine, an inner root needs two entries like any node
+    if (!check(_root, 0, path, previous, count)) return false;
+    return previous == _last && count == _size;
+}
+
+// Node and leaf bytes per entry
+template <typename TKey, typename TValue, typename KeyBytes>
+double ArtMap<TKey, TValue, KeyBytes>::bytes_per_element() const {
+    if (_size == 0) return 0;
+    size_t bytes = _leaves.live() * NodePool<Leaf>::bytes_per_node() + _nodes4.live() * NodePool<Node4>::bytes_per_node() +
+                   _nodes16.live() * NodePool<Node16>::bytes_per_node() +
+                   _nodes48.live() * NodePool<Node48>::bytes_per_node() +
+                   _nodes256.live() * NodePool<Node256>::bytes_per_node();
+    return static_cast<double>(bytes) / _size;
+}
+
+// Clear the map
+template <typename TKey, typename TValue, typename KeyBytes>
+void ArtMap<TKey, TValue, KeyBytes>::clear() {
+    if (!std::is_trivially_destructible<Leaf>::value) {
+        for (Leaf *leaf = _first; leaf;) {
+            Leaf *next = leaf->_next;
+            leaf->~Leaf();
+            leaf = next;
+        }
+    }
+    _leaves.release();
+    _nodes4.release();
+    _nodes16.release();
+    _nodes48.release();
+    _nodes256.release();
+    _root = nullptr;
+    _first = nullptr;
+    _last = nullptr;
+    _size = 0;
+}
+#endif
@@ -0,0 +1,325 @@
+#ifndef ART_MAP_HPP
+#define ART_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "NodePool.hpp"
+#include "TreeSet.hpp"
+
+/// @brief a key as bytes whose order, compared as unsigned bytes, is the key order
+struct ArtBytes
+{
+    const uint8_t *data;
+    size_t size;
+};
+
+/// @brief how `ArtMap` turns keys into `ArtBytes`
+/// A specialization provides `BUFFER`, the scratch bytes `bytes` may write
+/// to, and `static ArtBytes bytes(const TKey &key, uint8_t *buffer)`. The
+/// bytes of two keys must compare like the keys do. Provided for
+/// `std::string` and the integer types; other key types need their own.
+template <typename TKey, typename = void>
+struct ArtKeyBytes;
+
+/// @brief strings are their own bytes: `std::string::operator<` compares
+///        characters as unsigned bytes too
+template <>
+struct ArtKeyBytes<std::string>
+{
+    static constexpr size_t BUFFER = 1;
+    static ArtBytes bytes(const std::string &key, uint8_t *) {
+        return {reinterpret_cast<const uint8_t *>(key.data()), key.size()};
+    }
+};
+
+/// @brief integers are stored big-endian, with the sign bit flipped for
+///        signed types so that negative numbers come first
+template <typename TKey>
+struct ArtKeyBytes<TKey, std::enable_if_t<std::is_integral<TKey>::value && !std::is_same<TKey, bool>::value>>
+{
+    static constexpr size_t BUFFER = sizeof(TKey);
+    static ArtBytes bytes(const TKey &key, uint8_t *buffer) {
+        using Unsigned = std::make_unsigned_t<TKey>;
+        Unsigned bits = static_cast<Unsigned>(key);
+        if (std::is_signed<TKey>::value) {
+            bits ^= Unsigned(1) << (8 * sizeof(TKey) - 1);
+        }
+        for (size_t i = sizeof(TKey); i-- > 0;) {
+            buffer[i] = static_cast<uint8_t>(bits);
+            bits = static_cast<Unsigned>(bits >> 7 >> 1); // one shift by 8 is undefined for 1-byte types
+        }
+        return {buffer, sizeof(TKey)};
+    }
+};
+
+/// @brief ordered map backed by an adaptive radix tree, with the interface of `TreeMap`
+/// Keys are walked byte by byte, so a lookup reads each key byte once
+/// instead of comparing whole keys at every level, and keys sharing a prefix
+/// share the nodes for it. Inner nodes hold 4, 16, 48 or 256 children and
+/// grow or shrink between those sizes; runs of single-child nodes are
+/// collapsed into a prefix stored in the node below them. Entries live in
+/// leaves that are linked in key order for iteration.
+/// @tparam TKey type of the keys
+/// @tparam TValue type of the mapped values
+/// @tparam KeyBytes how keys map to bytes, see `ArtKeyBytes`
+template <typename TKey, typename TValue, typename KeyBytes = ArtKeyBytes<TKey>>
+class ArtMap
+{
+private:
+    enum NodeType : uint8_t { Node4Type, Node16Type, Node48Type, Node256Type };
+
+    static constexpr size_t MAX_PREFIX = 12;
+
+    struct Leaf {
+        std::pair<TKey, TValue> _entry;
+        Leaf *_prev = nullptr;
+        Leaf *_next = nullptr;
+    };
+
+    /// An inner node at depth d covers key bytes [d, d + `_prefix_length`)
+    /// with its prefix, of which only the first `MAX_PREFIX` are stored; the
+    /// rest are read from a leaf below when needed. A key ending right after
+    /// the prefix is kept in `_end`, its children are indexed by the next byte.
+    struct Node {
+        NodeType _type;
+        uint8_t _prefix[MAX_PREFIX] = {};
+        uint16_t _count = 0;
+        uint32_t _prefix_length = 0;
+        Leaf *_end = nullptr;
+        explicit Node(NodeType type) : _type(type) {}
+    };
+
+    /// keys sorted, `_children[i]` under `_keys[i]`
+    struct Node4 : Node {
+        uint8_t _keys[4];
+        Node *_children[4];
+        Node4() : Node(Node4Type) {}
+    };
+
+    /// keys sorted, `_children[i]` under `_keys[i]`
+    struct Node16 : Node {
+        uint8_t _keys[16] = {}; // searched 16 at a time, so never left uninitialized
+        Node *_children[16];
+        Node16() : Node(Node16Type) {}
+    };
+
+    /// `_index[byte]` is one more than the slot of the child under `byte`, or 0
+    struct Node48 : Node {
+        uint8_t _index[256] = {};
+        Node *_children[48];
+        Node48() : Node(Node48Type) {}
+    };
+
+    struct Node256 : Node {
+        Node *_children[256] = {};
+        Node256() : Node(Node256Type) {}
+    };
+
+    static_assert(alignof(Leaf) >= 2, "leaf pointers are tagged in their low bit");
+
+    Node *_root;
+    Leaf *_first;
+    Leaf *_last;
+    size_t _size;
+    NodePool<Leaf> _leaves;
+    NodePool<Node4> _nodes4;
+    NodePool<Node16> _nodes16;
+    NodePool<Node48> _nodes48;
+    NodePool<Node256> _nodes256;
+
+    // children are inner nodes, or leaves tagged with the low pointer bit
+    static bool is_leaf(const Node *child) { return reinterpret_cast<uintptr_t>(child) & 1; }
+    static Leaf *as_leaf(const Node *child) { return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(child) & ~uintptr_t(1)); }
+    static Node *tag(Leaf *leaf) { return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(leaf) | 1); }
+
+    static ArtBytes key_bytes(const TKey &key, uint8_t *buffer) { return KeyBytes::bytes(key, buffer); }
+
+    /// @brief compare two byte strings
+    /// @return negative, zero or positive as `a` is less than, equal to or greater than `b`
+    static int compare_bytes(ArtBytes a, ArtBytes b);
+
+    Leaf *create_leaf(const TKey &key, TValue value);
+    void destroy_leaf(Leaf *leaf);
+    template <typename N>
+    N *create_node();
+    void destroy_node(Node *node);
+
+    /// @brief link `leaf` into the leaf list just before `next`, or last if `next` is null
+    void link_before(Leaf *leaf, Leaf *next);
+    void unlink(Leaf *leaf);
+
+    /// @brief smallest and largest leaf under `child`
+    static Leaf *min_leaf(const Node *child);
+    static Leaf *max_leaf(const Node *child);
+
+    /// @brief slot of the child under `byte`, or null if there is none
+    static Node **find_child(const Node *node, uint8_t byte);
+
+    /// @brief first child under a byte greater than `after`, or null
+    /// @param byte set to the byte of the child, if not null
+    static Node *next_child(const Node *node, int after, uint8_t *byte = nullptr);
+
+    /// @brief last child under a byte less than `before`, or null
+    static Node *previous_child(const Node *node, int before);
+
+    /// @brief number of children and end leaf of a node
+    static size_t entries(const Node *node) { return node->_count + (node->_end ? 1 : 0); }
+
+    /// @brief add a child under a byte not yet in `ref`, growing `ref` into a
+    ///        larger node type if it is full
+    void add_child(Node *&ref, uint8_t byte, Node *child);
+
+    /// @brief remove the child under `byte` from `ref`, shrinking `ref` into
+    ///        a smaller node type, or collapsing it, once it is sparse enough
+    void remove_child(Node *&ref, uint8_t byte);
+
+    /// @brief replace `ref` by its only entry when it has no other
+    void collapse(Node *&ref);
+
+    /// @brief copy the header of `from` into `to`, which must be empty
+    static void copy_header(Node *to, const Node *from);
+
+    /// @brief compare the prefix of `node`, at `depth`, with `key`
+    /// @param matched set to the number of prefix bytes equal in both
+    /// @return 0 if `key` continues with the whole prefix, otherwise negative
+    ///         or positive as `key` is less or greater than every key under `node`
+    static int compare_prefix(const Node *node, ArtBytes key, size_t depth, size_t &matched);
+
+    /// @brief insert a leaf for `key` under `ref`, at `depth`, unless one exists
+    /// @param created set to true if a new leaf was made
+    /// @return the leaf of `key`
+    Leaf *insert(Node *&ref, ArtBytes key, size_t depth, const TKey &original, TValue &value, bool &created);
+
+    /// @brief unlink the leaf of `key` from under `ref`, at `depth`
+    /// @return the leaf, or null if `key` is absent
+    Leaf *remove(Node *&ref, ArtBytes key, size_t depth);
+
+    /// @brief the leaf with `key`, or null
+    Leaf *find_leaf(const TKey &key) const;
+
+    /// @brief the first leaf whose key is not less than `key`, or null
+    Leaf *lower_bound_leaf(ArtBytes key) const;
+
+    /// @brief check node occupancy, key order and prefixes of a subtree
+    /// @param count incremented for every leaf
+    bool check(const Node *child, size_t depth, std::vector<uint8_t> &path, const Leaf *&previous, size_t &count) const;
+
+public:
+    /// @brief bidirectional iterator over the key-value pairs in key order
+    class const_iterator
+    {
+    private:
+        friend class ArtMap;
+        const Leaf *_leaf;
+        const ArtMap *_map;
+
+        const_iterator(const Leaf *leaf, const ArtMap *map) : _leaf(leaf), _map(map) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<TKey, TValue>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() : _leaf(nullptr), _map(nullptr) {}
+
+        reference operator*() const { return _leaf->_entry; }
+        pointer operator->() const { return &_leaf->_entry; }
+
+        const_iterator &operator++() {
+            _leaf = _leaf->_next;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // decrementing end() lands on the largest key
+        const_iterator &operator--() {
+            _leaf = _leaf ? _leaf->_prev : _map->_last;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const { return _leaf == other._leaf; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = const_iterator;
+    using Range = IteratorRange<const_iterator>;
+
+    ArtMap();
+
+    /// @brief build a map from `items`; the last value wins for repeated keys
+    ArtMap(const std::vector<std::pair<TKey, TValue>> &items);
+    ArtMap(const ArtMap &other);
+    ArtMap(ArtMap &&other) noexcept;
+    ArtMap &operator=(const ArtMap &other);
+    ArtMap &operator=(ArtMap &&other) noexcept;
+
+    /// @brief Returns the number of elements in the map.
+    size_t size() const;
+
+    /// @brief insert a key-value pair, replacing the value if the key exists
+    void insert(TKey key, TValue value);
+
+    /// @brief the value of `key`, value-initialized first if the key is new
+    TValue &operator[](const TKey &key);
+
+    /// @brief remove a key and its value from the map
+    /// @return true if the key was in the map, otherwise false
+    bool remove(const TKey &key);
+
+    /// @brief get the value of a key, or std::nullopt if absent
+    std::optional<TValue> get(const TKey &key) const;
+
+    /// @brief check if a key is in the map
+    bool contains(const TKey &key) const;
+
+    /// @brief a sorted vector containing all kv-pair in the map
+    std::vector<std::pair<TKey, TValue>> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// @brief first entry whose key is not less than `key`
+    const_iterator lower_bound(const TKey &key) const;
+
+    /// @brief first entry whose key is greater than `key`
+    const_iterator upper_bound(const TKey &key) const;
+
+    /// @brief the entries with key `key`, as `{lower_bound, upper_bound}`
+    std::pair<const_iterator, const_iterator> equal_range(const TKey &key) const;
+
+    /// @brief view of the entries whose key k satisfies lo <= k <= hi, in order
+    Range range(const TKey &lo, const TKey &hi) const;
+
+    /// @brief check if the map is empty
+    bool is_empty() const;
+
+    /// @brief check the radix tree invariants: node occupancy, prefixes
+    ///        matching the leaves below, and a leaf list in increasing key
+    ///        order that holds every leaf of the tree
+    bool is_valid() const;
+
+    /// @brief bytes of node and leaf storage in use, per entry
+    double bytes_per_element() const;
+
+    /// @brief remove every element in the map
+    void clear();
+    ~ArtMap();
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef AUGMENT_HPP
+#define AUGMENT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+// Augmentation policies decide what extra data every tree node carries.
+// A policy provides
+//   - `data<T>`, the struct stored in each node (nodes inherit from it),
+//   - `update(self, value, left, right)`, which recomputes a node's data from
+//     its own value and its children's data (null for a missing child),
+//   - `enabled`, false only when there is nothing to maintain,
+//   - `has_subtree_size`, true when `data<T>` has a `_subtree_size` field,
+//   - `has_aggregate`, true when `data<T>` has an `_aggregate` field,
+//   - `reads_values`, true when the data depends on the values and not only
+//     on the shape, so values must not change behind the tree's back.
+// TreeSet calls `update` bottom-up whenever the shape of a subtree changes.
+
+/// @brief augmentation policy that stores nothing in tree nodes
+struct NoAugment
+{
+    static constexpr bool enabled = false;
+    static constexpr bool has_subtree_size = false;
+    static constexpr bool has_aggregate = false;
+    static constexpr bool reads_values = false;
+
+    template <typename T>
+    struct data {};
+
+    template <typename T>
+    static void update(data<T> &, const T &, const data<T> *, const data<T> *) {}
+};
+
+/// @brief augmentation policy that keeps the size of every subtree,
+///        which lets a TreeSet answer rank and select queries in O(log n)
+struct OrderStatistics
+{
+    static constexpr bool enabled = true;
+    static constexpr bool has_subtree_size = true;
+    static constexpr bool has_aggregate = false;
+    static constexpr bool reads_values = false;
+
+    template <typename T>
+    struct data {
+        size_t _subtree_size = 1;
+    };
+
+    template <typename T>
+    static void update(data<T> &self, const T &, const data<T> *left, const data<T> *right) {
+        self._subtree_size = 1 + (left ? left->_subtree_size : 0) + (right ? right->_subtree_size : 0);
+    }
+};
+
+// Monoids for `Aggregate`. A monoid provides
+//   - `value_type`, the type of an aggregate,
+//   - `identity()`, the aggregate of no elements,
+//   - `lift(x)`, the aggregate of one element's operand (see `aggregate_operand`),
+//   - `combine(a, b)`, the aggregate of a run followed by another; it must be
+//     associative, but need not be commutative.
+
+/// @brief what a monoid sees of an element: the mapped value of a map entry,
+///        or the element itself
+template <typename T>
+const T &aggregate_operand(const T &element) { return element; }
+
+template <typename K, typename V>
+const V &aggregate_operand(const std::pair<K, V> &entry) { return entry.second; }
+
+/// @brief sum of the operands
+template <typename V>
+struct SumMonoid
+{
+    using value_type = V;
+    static V identity() { return V(); }
+    static V lift(const V &x) { return x; }
+    static V combine(const V &a, const V &b) { return a + b; }
+};
+
+/// @brief smallest operand, or the largest `V` for an empty range
+template <typename V>
+struct MinMonoid
+{
+    using value_type = V;
+    static V identity() { return std::numeric_limits<V>::max(); }
+    static V lift(const V &x) { return x; }
+    static V combine(const V &a, const V &b) { return std::min(a, b); }
+};
+
+/// @brief largest operand, or the lowest `V` for an empty range
+template <typename V>
+struct MaxMonoid
+{
+    using value_type = V;
+    static V identity() { return std::numeric_limits<V>::lowest(); }
+    static V lift(const V &x) { return x; }
+    static V combine(const V &a, const V &b) { return std::max(a, b); }
+};
+
+/// @brief number of elements
+struct CountMonoid
+{
+    using value_type = size_t;
+    static size_t identity() { return 0; }
+    template <typename V>
+    static size_t lift(const V &) { return 1; }
+    static size_t combine(size_t a, size_t b) { return a + b; }
+};
+
+/// @brief augmentation policy that keeps `Monoid` combined over every
+///        subtree, which lets a TreeSet or TreeMap fold any key range in O(log n)
+template <typename Monoid>
+struct Aggregate
+{
+    static constexpr bool enabled = true;
+    static constexpr bool has_subtree_size = false;
+    static constexpr bool has_aggregate = true;
+    static constexpr bool reads_values = true;
+
+    using monoid = Monoid;
+    using value_type = typename Monoid::value_type;
+
+    template <typename T>
+    struct data {
+        value_type _aggregate = Monoid::identity();
+    };
+
+    template <typename T>
+    static void update(data<T> &self, const T &value, const data<T> *left, const data<T> *right) {
+        value_type aggregate = Monoid::lift(aggregate_operand(value));
+        if (left) aggregate = Monoid::combine(left->_aggregate, aggregate);
+        if (right) aggregate = Monoid::combine(aggregate, right->_aggregate);
+        self._aggregate = std::move(aggregate);
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef BTREE_MAP_CPP
+#define BTREE_MAP_CPP
+
+#include "BTreeMap.hpp"
+#include "BTreeSet.cpp"
+
+// Constructor
+template <typename TKey, typename TValue, typename Compare>
+BTreeMap<TKey, TValue, Compare>::BTreeMap() : _tree() {}
+
+// Constructor - initial items, the last value wins for repeated keys
+template <typename TKey, typename TValue, typename Compare>
+BTreeMap<TKey, TValue, Compare>::BTreeMap(const std::vector<std::pair<TKey, TValue>> &items) : _tree(items) {}
+
+// Constructor - key comparator
+template <typename TKey, typename TValue, typename Compare>
+BTreeMap<TKey, TValue, Compare>::BTreeMap(Compare comparator) : _tree(std::move(comparator)) {}
+
+// Returns map elements
+template <typename TKey, typename TValue, typename Compare>
+size_t BTreeMap<TKey, TValue, Compare>::size() const {
+    return _tree.size();
+}
+
+// Insert a key-value pair into the map
+template <typename TKey, typename TValue, typename Compare>
+void BTreeMap<TKey, TValue, Compare>::insert(TKey key, TValue value) {
+    _tree.add(std::make_pair(key, value));
+}
+
+// Get key value
+template <typename TKey, typename TValue, typename Compare>
+std::optional<TValue> BTreeMap<TKey, TValue, Compare>::get(TKey key) const {
+    auto result = _tree.get(std::make_pair(key, TValue{}));
+    return result ? std::optional<TValue>(result->second) : std::nullopt;
+}
+
+// Check if a key is in the map
+template <typename TKey, typename TValue, typename Compare>
+bool BTreeMap<TKey, TValue, Compare>::contains(TKey key) const {
+    return _tree.contains(std::make_pair(key, TValue{}));
+}
+
+// Key-value pairs in key order
+template <typename TKey, typename TValue, typename Compare>
+std::vector<std::pair<TKey, TValue>> BTreeMap<TKey, TValue, Compare>::to_vector() const {
+    return _tree.to_vector();
+}
+
+// Iterator to the smallest key
+template <typename TKey, typename TValue, typename Compare>
+typename BTreeMap<TKey, TValue, Compare>::const_iterator BTreeMap<TKey, TValue, Compare>::begin() const {
+    return _tree.begin();
+}
+
+// Iterator past the largest key
+template <typename TKey, typename TValue, typename Compare>
+typename BTreeMap<TKey, TValue, Compare>::const_iterator BTreeMap<TKey, TValue, Compare>::end() const {
+    return _tree.end();
+}
+
+// First entry with key not less than key
+template <typename TKey, typename TValue, typename Compare>
+typename BTreeMap<TKey, TValue, Compare>::const_iterator BTreeMap<TKey, TValue, Compare>::lower_bound(const TKey &key) const {
+    return _tree.lower_bound(std::make_pair(key, TValue{}));
+}
+
+// First entry with key greater than key
+template <typename TKey, typename TValue, typename Compare>
+typename BTreeMap<TKey, TValue, Compare>::const_iterator BTreeMap<TKey, TValue, Compare>::upper_bound(const TKey &key) const {
+    return _tree.upper_bound(std::make_pair(key, TValue{}));
+}
+
+// Entries with keys in [lo, hi]
+template <typename TKey, typename TValue, typename Compare>
+typename BTreeMap<TKey, TValue, Compare>::Range BTreeMap<TKey, TValue, Compare>::range(const TKey &lo, const TKey &hi) const {
+    return _tree.range(std::make_pair(lo, TValue{}), std::make_pair(hi, TValue{}));
+}
+
+// Check if the map is empty
+template <typename TKey, typename TValue, typename Compare>
+bool BTreeMap<TKey, TValue, Compare>::is_empty() const {
+    return _tree.is_empty();
+}
+
+// Clear the map
+template <typename TKey, typename TValue, typename Compare>
+void BTreeMap<TKey, TValue, Compare>::clear() {
+    _tree.clear();
+}
+#endif
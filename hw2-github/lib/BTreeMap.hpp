@@ -0,0 +1,66 @@
+#ifndef BTREE_MAP_HPP
+#define BTREE_MAP_HPP
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "BTreeSet.hpp"
+#include "TreeMap.hpp"
+
+/// @brief ordered map backed by a B+-tree, with the same interface as `TreeMap`
+/// @tparam TKey type of the keys
+/// @tparam TValue type of the mapped values
+/// @tparam Compare callable `int(const TKey &, const TKey &)` returning -1, 0 or 1
+template <typename TKey, typename TValue, typename Compare = DefaultComparator<TKey>>
+class BTreeMap
+{
+private:
+    using Tree = BTreeSet<std::pair<TKey, TValue>, EntryComparator<TKey, TValue, Compare>>;
+    Tree _tree;
+
+public:
+    /// @brief bidirectional iterator over the key-value pairs in key order
+    using const_iterator = typename Tree::const_iterator;
+    using iterator = const_iterator;
+    using Range = typename Tree::Range;
+
+    BTreeMap();
+    BTreeMap(const std::vector<std::pair<TKey, TValue>> &items);
+    BTreeMap(Compare comparator);
+
+    /// @brief Returns the number of elements in the map.
+    size_t size() const;
+
+    /// @brief insert a key-value pair, replacing the value if the key exists
+    void insert(TKey key, TValue value);
+
+    /// @brief get the value of a key, or std::nullopt if absent
+    std::optional<TValue> get(TKey key) const;
+
+    /// @brief check if a key is in the map
+    bool contains(TKey key) const;
+
+    /// @brief a sorted vector containing all kv-pair in the map
+    std::vector<std::pair<TKey, TValue>> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// @brief first entry whose key is not less than `key`
+    const_iterator lower_bound(const TKey &key) const;
+
+    /// @brief first entry whose key is greater than `key`
+    const_iterator upper_bound(const TKey &key) const;
+
+    /// @brief view of the entries whose key k satisfies lo <= k <= hi, in order
+    Range range(const TKey &lo, const TKey &hi) const;
+
+    /// @brief check if the map is empty
+    bool is_empty() const;
+
+    /// @brief remove every element in the map
+    void clear();
+};
+
+#endif
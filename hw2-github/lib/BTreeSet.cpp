@@ -0,0 +1,608 @@
+#ifndef BTREE_SET_CPP
+#define BTREE_SET_CPP
+
+#include "BTreeSet.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Constructor
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet() : BTreeSet(Compare()) {}
+
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet(const std::vector<T> &items) : BTreeSet() {
+    assign(items);
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet(Compare comparator)
+    : _root(nullptr), _first(nullptr), _last(nullptr), _comparator(std::move(comparator)), _size(0), _natural(false) {
+    if constexpr (std::is_same<Compare, DefaultComparator<T>>::value) {
+        _natural = _comparator.is_natural();
+    }
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet(const std::vector<T> &items, Compare comparator)
+    : BTreeSet(std::move(comparator)) {
+    assign(items);
+}
+
+// Copy constructor
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet(const BTreeSet &other) : BTreeSet(other._comparator) {
+    build_from_sorted(other.to_vector());
+}
+
+// Move constructor
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::BTreeSet(BTreeSet &&other) noexcept
+    : _root(other._root), _first(other._first), _last(other._last), _comparator(std::move(other._comparator)),
+      _size(other._size), _natural(other._natural), _leaves(std::move(other._leaves)),
+      _inners(std::move(other._inners)) {
+    other._root = nullptr;
+    other._first = nullptr;
+    other._last = nullptr;
+    other._size = 0;
+}
+
+// Copy assignment
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> &BTreeSet<T, Compare, NodeBytes>::operator=(const BTreeSet &other) {
+    if (this != &other) {
+        BTreeSet copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Move assignment
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> &BTreeSet<T, Compare, NodeBytes>::operator=(BTreeSet &&other) noexcept {
+    if (this != &other) {
+        clear();
+        _root = other._root;
+        _first = other._first;
+        _last = other._last;
+        _comparator = std::move(other._comparator);
+        _size = other._size;
+        _natural = other._natural;
+        _leaves = std::move(other._leaves);
+        _inners = std::move(other._inners);
+        other._root = nullptr;
+        other._first = nullptr;
+        other._last = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+// Node allocation
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::Leaf *BTreeSet<T, Compare, NodeBytes>::create_leaf() {
+    return new (_leaves.allocate()) Leaf();
+}
+
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::Inner *BTreeSet<T, Compare, NodeBytes>::create_inner() {
+    return new (_inners.allocate()) Inner();
+}
+
+// Runs the destructors of a subtree; storage goes back with the pools
+template <typename T, typename Compare, size_t NodeBytes>
+void BTreeSet<T, Compare, NodeBytes>::destroy_subtree(Node *node) {
+    if (node->_leaf) {
+        static_cast<Leaf *>(node)->~Leaf();
+        return;
+    }
+    Inner *inner = static_cast<Inner *>(node);
+    for (size_t i = 0; i <= inner->_count; ++i) {
+        destroy_subtree(inner->_children[i]);
+    }
+    inner->~Inner();
+}
+
+// Counts keys below value, with vector compares for arithmetic keys
+template <typename T, typename Compare, size_t NodeBytes>
+size_t BTreeSet<T, Compare, NodeBytes>::count_keys(const T *keys, size_t n, const T &value, bool inclusive) const {
+#if defined(__GNUC__)
+    constexpr bool vectorizable = (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+                                  std::is_same<T, float>::value || std::is_same<T, double>::value;
+    if constexpr (vectorizable) {
+        if (_natural) {
+            // compare 32 bytes of keys at a time; each true lane is -1
+            typedef T Vec __attribute__((vector_size(32)));
+            constexpr size_t LANES = 32 / sizeof(T);
+            Vec needle;
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                needle[lane] = value;
+            }
+            decltype(needle < needle) counts = {};
+            size_t i = 0;
+            for (; i + LANES <= n; i += LANES) {
+                Vec block;
+                std::memcpy(&block, keys + i, sizeof(block));
+                counts += inclusive ? (block <= needle) : (block < needle);
+            }
+            size_t count = 0;
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                count -= counts[lane];
+            }
+            for (; i < n; ++i) {
+                count += inclusive ? !(value < keys[i]) : keys[i] < value;
+            }
+            return count;
+        }
+    }
+#endif
+    // keys are sorted, so binary search with the comparator
+    size_t lo = 0;
+    size_t hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = _comparator(keys[mid], value);
+        if (cmp < 0 || (inclusive && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Descends to the leaf covering value
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::Leaf *BTreeSet<T, Compare, NodeBytes>::find_leaf(const T &value) const {
+    Node *node = _root;
+    if (!node) return nullptr;
+    while (!node->_leaf) {
+        Inner *inner = static_cast<Inner *>(node);
+        node = inner->_children[count_keys(inner->_keys, inner->_count, value, true)];
+    }
+    return static_cast<Leaf *>(node);
+}
+
+// Recursive insertion, splitting full nodes on the way back up
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::insert(Node *node, const T &value, Node *&split, T &separator) {
+    split = nullptr;
+    if (node->_leaf) {
+        Leaf *leaf = static_cast<Leaf *>(node);
+        size_t pos = count_keys(leaf->_keys, leaf->_count, value, false);
+        if (pos < leaf->_count && _comparator(leaf->_keys[pos], value) == 0) {
+            leaf->_keys[pos] = value;
+            return false;
+        }
+        if (leaf->_count == CAPACITY) {
+            Leaf *right = create_leaf();
+            size_t mid = CAPACITY / 2;
+            std::move(leaf->_keys + mid, leaf->_keys + CAPACITY, right->_keys);
+            right->_count = CAPACITY - mid;
+            leaf->_count = mid;
+            right->_prev = leaf;
+            right->_next = leaf->_next;
+            if (leaf->_next) {
+                leaf->_next->_prev = right;
+            } else {
+                _last = right;
+            }
+            leaf->_next = right;
+            split = right;
+            if (pos > mid) {
+                leaf = right;
+                pos -= mid;
+            }
+        }
+        std::move_backward(leaf->_keys + pos, leaf->_keys + leaf->_count, leaf->_keys + leaf->_count + 1);
+        leaf->_keys[pos] = value;
+        leaf->_count++;
+        if (split) {
+            separator = static_cast<Leaf *>(split)->_keys[0];
+        }
+        return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    size_t i = count_keys(inner->_keys, inner->_count, value, true);
+    Node *child_split;
+    T child_separator;
+    bool added = insert(inner->_children[i], value, child_split, child_separator);
+    if (!child_split) return added;
+
+    // put `child_separator` at key index j and `child_split` right after it
+    auto insert_child = [](Inner *target, size_t j, T &key, Node *child) {
+        std::move_backward(target->_keys + j, target->_keys + target->_count, target->_keys + target->_count + 1);
+        std::copy_backward(target->_children + j + 1, target->_children + target->_count + 1,
+                           target->_children + target->_count + 2);
+        target->_keys[j] = std::move(key);
+        target->_children[j + 1] = child;
+        target->_count++;
+    };
+
+    if (inner->_count < CAPACITY) {
+        insert_child(inner, i, child_separator, child_split);
+        return added;
+    }
+
+    // split: the left half keeps `mid` keys and one key moves up
+    Inner *right = create_inner();
+    size_t mid = CAPACITY / 2;
+    if (i == mid) {
+        separator = std::move(child_separator);
+        std::move(inner->_keys + mid, inner->_keys + CAPACITY, right->_keys);
+        right->_children[0] = child_split;
+        std::copy(inner->_children + mid + 1, inner->_children + CAPACITY + 1, right->_children + 1);
+        right->_count = CAPACITY - mid;
+        inner->_count = mid;
+    } else {
+        separator = std::move(inner->_keys[mid]);
+        std::move(inner->_keys + mid + 1, inner->_keys + CAPACITY, right->_keys);
+        std::copy(inner->_children + mid + 1, inner->_children + CAPACITY + 1, right->_children);
+        right->_count = CAPACITY - mid - 1;
+        inner->_count = mid;
+        if (i < mid) {
+            insert_child(inner, i, child_separator, child_split);
+        } else {
+            insert_child(right, i - mid - 1, child_separator, child_split);
+        }
+    }
+    split = right;
+    return added;
+}
+
+// Sorts and deduplicates values, then bulk-builds the tree
+template <typename T, typename Compare, size_t NodeBytes>
+void BTreeSet<T, Compare, NodeBytes>::assign(std::vector<T> values) {
+    auto less = [this](const T &a, const T &b) { return _comparator(a, b) < 0; };
+    if (!std::is_sorted(values.begin(), values.end(), less)) {
+        std::stable_sort(values.begin(), values.end(), less);
+    }
+    // keep the last of every run of equal values
+    auto out = values.begin();
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        auto next = std::next(it);
+        if (next == values.end() || _comparator(*it, *next) != 0) {
+            if (out != it) *out = std::move(*it);
+            ++out;
+        }
+    }
+    values.erase(out, values.end());
+    build_from_sorted(values);
+}
+
+// Packs sorted values into leaves, then builds the inner levels
+template <typename T, typename Compare, size_t NodeBytes>
+void BTreeSet<T, Compare, NodeBytes>::build_from_sorted(const std::vector<T> &values) {
+    clear();
+    size_t n = values.size();
+    if (n == 0) return;
+
+    // spread the values evenly so every leaf is at least half full
+    std::vector<Node *> level;
+    std::vector<const T *> level_min;
+    size_t leaves = (n + CAPACITY - 1) / CAPACITY;
+    size_t offset = 0;
+    Leaf *prev = nullptr;
+    for (size_t l = 0; l < leaves; ++l) {
+        size_t count = n / leaves + (l < n % leaves ? 1 : 0);
+        Leaf *leaf = create_leaf();
+        std::copy(values.begin() + offset, values.begin() + offset + count, leaf->_keys);
+        leaf->_count = count;
+        leaf->_prev = prev;
+        if (prev) {
+            prev->_next = leaf;
+        } else {
+            _first = leaf;
+        }
+        prev = leaf;
+        level.push_back(leaf);
+        level_min.push_back(&values[offset]);
+        offset += count;
+    }
+    _last = prev;
+
+    while (level.size() > 1) {
+        std::vector<Node *> parents;
+        std::vector<const T *> parents_min;
+        size_t groups = (level.size() + CAPACITY) / (CAPACITY + 1);
+        size_t k = 0;
+        for (size_t g = 0; g < groups; ++g) {
+            size_t children = level.size() / groups + (g < level.size() % groups ? 1 : 0);
+            Inner *inner = create_inner();
+            for (size_t c = 0; c < children; ++c) {
+                inner->_children[c] = level[k + c];
+                if (c > 0) {
+                    inner->_keys[c - 1] = *level_min[k + c];
+                }
+            }
+            inner->_count = children - 1;
+            parents.push_back(inner);
+            parents_min.push_back(level_min[k]);
+            k += children;
+        }
+        level.swap(parents);
+        level_min.swap(parents_min);
+    }
+    _root = level[0];
+    _size = n;
+}
+
+// Returns the number of elements in the tree
+template <typename T, typename Compare, size_t NodeBytes>
+size_t BTreeSet<T, Compare, NodeBytes>::size() const {
+    return _size;
+}
+
+// Adds a value to the set
+template <typename T, typename Compare, size_t NodeBytes>
+void BTreeSet<T, Compare, NodeBytes>::add(T value) {
+    if (!_root) {
+        _root = _first = _last = create_leaf();
+    }
+    Node *split;
+    T separator;
+    if (insert(_root, value, split, separator)) {
+        _size++;
+    }
+    if (split) {
+        // the root was split, so the tree grows by one level
+        Inner *root = create_inner();
+        root->_keys[0] = std::move(separator);
+        root->_children[0] = _root;
+        root->_children[1] = split;
+        root->_count = 1;
+        _root = root;
+    }
+}
+
+// Check if an element is in the set
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::contains(T value) const {
+    return get(value).has_value();
+}
+
+// Check if the set is empty
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::is_empty() const {
+    return _size == 0;
+}
+
+// Smallest value
+template <typename T, typename Compare, size_t NodeBytes>
+std::optional<T> BTreeSet<T, Compare, NodeBytes>::min() const {
+    if (_size == 0) return std::nullopt;
+    return _first->_keys[0];
+}
+
+// Largest value
+template <typename T, typename Compare, size_t NodeBytes>
+std::optional<T> BTreeSet<T, Compare, NodeBytes>::max() const {
+    if (_size == 0) return std::nullopt;
+    return _last->_keys[_last->_count - 1];
+}
+
+// Walks the leaf chain
+template <typename T, typename Compare, size_t NodeBytes>
+std::vector<T> BTreeSet<T, Compare, NodeBytes>::to_vector() const {
+    std::vector<T> result;
+    result.reserve(_size);
+    for (const Leaf *leaf = _first; leaf; leaf = leaf->_next) {
+        result.insert(result.end(), leaf->_keys, leaf->_keys + leaf->_count);
+    }
+    return result;
+}
+
+// Finds a value and returns it
+template <typename T, typename Compare, size_t NodeBytes>
+std::optional<T> BTreeSet<T, Compare, NodeBytes>::get(T value) const {
+    const Leaf *leaf = find_leaf(value);
+    if (!leaf) return std::nullopt;
+    size_t pos = count_keys(leaf->_keys, leaf->_count, value, false);
+    if (pos < leaf->_count && _comparator(leaf->_keys[pos], value) == 0) {
+        return leaf->_keys[pos];
+    }
+    return std::nullopt;
+}
+
+// Iterator to the smallest element
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::const_iterator BTreeSet<T, Compare, NodeBytes>::begin() const {
+    return const_iterator(_size ? _first : nullptr, 0, this);
+}
+
+// Iterator past the largest element
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::const_iterator BTreeSet<T, Compare, NodeBytes>::end() const {
+    return const_iterator(nullptr, 0, this);
+}
+
+// First element not less than value
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::const_iterator BTreeSet<T, Compare, NodeBytes>::lower_bound(const T &value) const {
+    const Leaf *leaf = find_leaf(value);
+    if (!leaf) return end();
+    return const_iterator(leaf, count_keys(leaf->_keys, leaf->_count, value, false), this);
+}
+
+// First element greater than value
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::const_iterator BTreeSet<T, Compare, NodeBytes>::upper_bound(const T &value) const {
+    const Leaf *leaf = find_leaf(value);
+    if (!leaf) return end();
+    return const_iterator(leaf, count_keys(leaf->_keys, leaf->_count, value, true), this);
+}
+
+// Elements equal to value
+template <typename T, typename Compare, size_t NodeBytes>
+std::pair<typename BTreeSet<T, Compare, NodeBytes>::const_iterator, typename BTreeSet<T, Compare, NodeBytes>::const_iterator>
+BTreeSet<T, Compare, NodeBytes>::equal_range(const T &value) const {
+    return {lower_bound(value), upper_bound(value)};
+}
+
+// Elements in [lo, hi]
+template <typename T, typename Compare, size_t NodeBytes>
+typename BTreeSet<T, Compare, NodeBytes>::Range BTreeSet<T, Compare, NodeBytes>::range(const T &lo, const T &hi) const {
+    if (_comparator(lo, hi) > 0) return Range(end(), end());
+    return Range(lower_bound(lo), upper_bound(hi));
+}
+
+// Lockstep in-order walk over both sets
+template <typename T, typename Compare, size_t NodeBytes>
+std::vector<T> BTreeSet<T, Compare, NodeBytes>::merge(const BTreeSet &other, SetOperation op) const {
+    bool keep_left = op != SetOperation::Intersection;
+    bool keep_right = op == SetOperation::Union || op == SetOperation::SymmetricDifference;
+
+    std::vector<T> result;
+    result.reserve(op == SetOperation::Intersection ? std::min(_size, other._size) : _size + other._size);
+
+    const_iterator a = begin(), a_end = end();
+    const_iterator b = other.begin(), b_end = other.end();
+    while (a != a_end && b != b_end) {
+        int cmp = _comparator(*a, *b);
+        if (cmp < 0) {
+            if (keep_left) result.push_back(*a);
+            ++a;
+        } else if (cmp > 0) {
+            if (keep_right) result.push_back(*b);
+            ++b;
+        } else {
+            if (op == SetOperation::Union) {
+                result.push_back(*b);
+            } else if (op == SetOperation::Intersection) {
+                result.push_back(*a);
+            }
+            ++a;
+            ++b;
+        }
+    }
+    if (keep_left) result.insert(result.end(), a, a_end);
+    if (keep_right) result.insert(result.end(), b, b_end);
+    return result;
+}
+
+// Set union
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> BTreeSet<T, Compare, NodeBytes>::operator+(const BTreeSet &other) const {
+    BTreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::Union));
+    return result;
+}
+
+// In-place set union
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> &BTreeSet<T, Compare, NodeBytes>::operator+=(const BTreeSet &other) {
+    if (this == &other) return *this;
+    // a handful of inserts beats rebuilding a much larger tree
+    if (other._size * 16 < _size) {
+        for (const T &value : other) {
+            add(value);
+        }
+    } else {
+        build_from_sorted(merge(other, SetOperation::Union));
+    }
+    return *this;
+}
+
+// Set intersection
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> BTreeSet<T, Compare, NodeBytes>::operator&(const BTreeSet &other) const {
+    BTreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::Intersection));
+    return result;
+}
+
+// Set difference
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> BTreeSet<T, Compare, NodeBytes>::operator-(const BTreeSet &other) const {
+    BTreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::Difference));
+    return result;
+}
+
+// Symmetric set difference
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes> BTreeSet<T, Compare, NodeBytes>::operator^(const BTreeSet &other) const {
+    BTreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::SymmetricDifference));
+    return result;
+}
+
+// Set equal
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::operator==(const BTreeSet &other) const {
+    if (_size != other._size) return false;
+    return std::equal(begin(), end(), other.begin());
+}
+
+// Set not equal
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::operator!=(const BTreeSet &other) const {
+    return !(*this == other);
+}
+
+// Checks one subtree against the B+-tree invariants
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::check(const Node *node, size_t depth, size_t &leaf_depth, const T *lo,
+                                            const T *hi) const {
+    size_t min_count = node == _root ? 1 : node->_leaf ? CAPACITY / 2 : CAPACITY / 2 - 1;
+    if (node->_count < min_count || node->_count > CAPACITY) return false;
+
+    const T *keys = node->_leaf ? static_cast<const Leaf *>(node)->_keys : static_cast<const Inner *>(node)->_keys;
+    for (size_t i = 0; i < node->_count; ++i) {
+        if (i > 0 && _comparator(keys[i - 1], keys[i]) >= 0) return false;
+        if (lo && _comparator(keys[i], *lo) < 0) return false;
+        if (hi && _comparator(keys[i], *hi) >= 0) return false;
+    }
+
+    if (node->_leaf) {
+        if (leaf_depth == 0) leaf_depth = depth;
+        return leaf_depth == depth;
+    }
+    const Inner *inner = static_cast<const Inner *>(node);
+    for (size_t c = 0; c <= inner->_count; ++c) {
+        const T *child_lo = c == 0 ? lo : &keys[c - 1];
+        const T *child_hi = c == inner->_count ? hi : &keys[c];
+        if (!check(inner->_children[c], depth + 1, leaf_depth, child_lo, child_hi)) return false;
+    }
+    return true;
+}
+
+// Checks the whole tree
+template <typename T, typename Compare, size_t NodeBytes>
+bool BTreeSet<T, Compare, NodeBytes>::is_balanced() const {
+    if (_size == 0) return true;
+    size_t leaf_depth = 0;
+    return check(_root, 1, leaf_depth, nullptr, nullptr);
+}
+
+// Node storage per element
+template <typename T, typename Compare, size_t NodeBytes>
+double BTreeSet<T, Compare, NodeBytes>::bytes_per_element() const {
+    if (_size == 0) return 0;
+    size_t bytes = _leaves.live() * NodePool<Leaf>::bytes_per_node() + _inners.live() * NodePool<Inner>::bytes_per_node();
+    return static_cast<double>(bytes) / _size;
+}
+
+// Clear the set
+template <typename T, typename Compare, size_t NodeBytes>
+void BTreeSet<T, Compare, NodeBytes>::clear() {
+    if (!std::is_trivially_destructible<T>::value && _root) {
+        destroy_subtree(_root);
+    }
+    _leaves.release();
+    _inners.release();
+    _root = nullptr;
+    _first = nullptr;
+    _last = nullptr;
+    _size = 0;
+}
+
+// Destructor
+template <typename T, typename Compare, size_t NodeBytes>
+BTreeSet<T, Compare, NodeBytes>::~BTreeSet() {
+    clear();
+}
+
+#endif
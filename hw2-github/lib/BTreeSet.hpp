@@ -0,0 +1,232 @@
+#ifndef BTREE_SET_HPP
+#define BTREE_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "NodePool.hpp"
+#include "TreeSet.hpp"
+
+/// @brief ordered set backed by a B+-tree with cache-line sized nodes
+/// Offers the same interface as `TreeSet`, so either can be picked with a
+/// template alias. Values live in leaves that are linked for iteration; inner
+/// nodes only hold separators. Lookups inside a node count keys with vector
+/// compares when `T` is arithmetic and the comparator is the natural order.
+/// @tparam T type of the elements
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1
+/// @tparam NodeBytes bytes of keys per node, rounded to whole keys; at most
+///         65535 keys, and under 4 KiB for 1-byte keys
+template <typename T, typename Compare = DefaultComparator<T>, size_t NodeBytes = 256>
+class BTreeSet
+{
+public:
+    static constexpr size_t CAPACITY = NodeBytes / sizeof(T) < 4 ? 4 : NodeBytes / sizeof(T);
+
+    static_assert(CAPACITY <= UINT16_MAX, "NodeBytes too large: key counts are 16-bit");
+    // count_keys counts matches in vector lanes as wide as T, one 32-byte
+    // block per step, so each signed lane has to hold CAPACITY / lanes
+    static_assert(sizeof(T) >= 4 || CAPACITY * sizeof(T) / 32 < (size_t(1) << (8 * sizeof(T) - 1)),
+                  "NodeBytes too large for keys this small: count_keys' lane counters would overflow");
+
+private:
+    struct Node {
+        uint16_t _count = 0;
+        bool _leaf;
+        explicit Node(bool leaf) : _leaf(leaf) {}
+    };
+
+    struct alignas(64) Leaf : Node {
+        T _keys[CAPACITY];
+        Leaf *_prev = nullptr;
+        Leaf *_next = nullptr;
+        Leaf() : Node(true) {}
+    };
+
+    /// `_keys[i]` is the smallest value under `_children[i + 1]`
+    struct alignas(64) Inner : Node {
+        T _keys[CAPACITY];
+        Node *_children[CAPACITY + 1];
+        Inner() : Node(false) {}
+    };
+
+    Node *_root;
+    Leaf *_first;
+    Leaf *_last;
+    Compare _comparator;
+    size_t _size;
+    bool _natural;
+    NodePool<Leaf> _leaves;
+    NodePool<Inner> _inners;
+
+    Leaf *create_leaf();
+    Inner *create_inner();
+    void destroy_subtree(Node *node);
+
+    /// @brief number of `keys[0, n)` that are less than (or, if `inclusive`,
+    ///        not greater than) `value`
+    size_t count_keys(const T *keys, size_t n, const T &value, bool inclusive) const;
+
+    /// @brief descend to the leaf whose key range covers `value`
+    Leaf *find_leaf(const T &value) const;
+
+    /// @brief insert `value` into the subtree rooted at `node`
+    /// @param split set to the new right sibling if `node` had to be split
+    /// @param separator set to the smallest value under `split`
+    /// @return true if a new element was added, false if one was replaced
+    bool insert(Node *node, const T &value, Node *&split, T &separator);
+
+    /// @brief replace the contents with `values`, sorted and deduplicated first
+    void assign(std::vector<T> values);
+
+    /// @brief replace the contents with a strictly increasing run in O(n)
+    void build_from_sorted(const std::vector<T> &values);
+
+    /// @brief check node occupancy, ordering and leaf depth of a subtree
+    bool check(const Node *node, size_t depth, size_t &leaf_depth, const T *lo, const T *hi) const;
+
+    enum class SetOperation { Union, Intersection, Difference, SymmetricDifference };
+
+    /// @brief walk both sets in order at once and collect the result of `op`
+    std::vector<T> merge(const BTreeSet &other, SetOperation op) const;
+
+public:
+    /// @brief bidirectional iterator over the set in order
+    class const_iterator
+    {
+    private:
+        friend class BTreeSet;
+        const Leaf *_leaf;
+        size_t _index;
+        const BTreeSet *_set;
+
+        const_iterator(const Leaf *leaf, size_t index, const BTreeSet *set) : _leaf(leaf), _index(index), _set(set) {
+            if (_leaf && _index == _leaf->_count) {
+                _leaf = _leaf->_next;
+                _index = 0;
+            }
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : _leaf(nullptr), _index(0), _set(nullptr) {}
+
+        reference operator*() const { return _leaf->_keys[_index]; }
+        pointer operator->() const { return &_leaf->_keys[_index]; }
+
+        const_iterator &operator++() {
+            if (++_index == _leaf->_count) {
+                _leaf = _leaf->_next;
+                _index = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // decrementing end() lands on the largest element
+        const_iterator &operator--() {
+            if (!_leaf) {
+                _leaf = _set->_last;
+                _index = _leaf->_count - 1;
+            } else if (_index == 0) {
+                _leaf = _leaf->_prev;
+                _index = _leaf->_count - 1;
+            } else {
+                --_index;
+            }
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _leaf == other._leaf && _index == other._index;
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = const_iterator;
+    using Range = IteratorRange<const_iterator>;
+
+    BTreeSet();
+    BTreeSet(const std::vector<T> &items);
+    BTreeSet(Compare comparator);
+    BTreeSet(const std::vector<T> &items, Compare comparator);
+    BTreeSet(const BTreeSet &other);
+    BTreeSet(BTreeSet &&other) noexcept;
+    BTreeSet &operator=(const BTreeSet &other);
+    BTreeSet &operator=(BTreeSet &&other) noexcept;
+
+    /// @brief Returns the number of elements in the tree.
+    size_t size() const;
+
+    /// @brief adds a value to the set, replacing an equal element if present
+    void add(T value);
+
+    /// @brief check if a element is in the set
+    bool contains(T value) const;
+
+    /// @brief check if the set is empty
+    bool is_empty() const;
+
+    /// @brief the smallest value in the set, or std::nullopt if empty
+    std::optional<T> min() const;
+
+    /// @brief the largest value in the set, or std::nullopt if empty
+    std::optional<T> max() const;
+
+    /// @brief a sorted vector containing all values in the set
+    std::vector<T> to_vector() const;
+
+    /// @brief finds a value and return it, or std::nullopt if absent
+    std::optional<T> get(T value) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// @brief first element that is not less than `value`
+    const_iterator lower_bound(const T &value) const;
+
+    /// @brief first element that is greater than `value`
+    const_iterator upper_bound(const T &value) const;
+
+    /// @brief the elements equal to `value`, as `{lower_bound, upper_bound}`
+    std::pair<const_iterator, const_iterator> equal_range(const T &value) const;
+
+    /// @brief view of the elements x with lo <= x <= hi, in order
+    Range range(const T &lo, const T &hi) const;
+
+    BTreeSet operator+(const BTreeSet &other) const;
+    BTreeSet &operator+=(const BTreeSet &other);
+    BTreeSet operator&(const BTreeSet &other) const;
+    BTreeSet operator-(const BTreeSet &other) const;
+    BTreeSet operator^(const BTreeSet &other) const;
+    bool operator==(const BTreeSet &other) const;
+    bool operator!=(const BTreeSet &other) const;
+
+    /// @brief check the B+-tree invariants: ordered keys, node occupancy and
+    ///        all leaves at the same depth
+    bool is_balanced() const;
+
+    /// @brief bytes of node storage used per element, averaged over all nodes
+    double bytes_per_element() const;
+
+    /// @brief remove every element in the set
+    void clear();
+    ~BTreeSet();
+};
+
+#endif
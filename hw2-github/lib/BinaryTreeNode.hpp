@@ -3,87 +3,127 @@
 
 // DO NOT CHANGE THIS FILE
 #include <stdlib.h>     /* abs */
-
-enum Color { Red, Black };
-
-template <typename T>
-class BinaryTreeNode
+#include <utility>
+#include <vector>
+#include "Augment.hpp"
+#include "NodeLayout.hpp"
+
+template <typename T, typename Augment = NoAugment, typename Layout = WideNode>
+class BinaryTreeNode : private Layout::template links<BinaryTreeNode<T, Augment, Layout>>,
+                       private Augment::template data<T>
 {
 private:
     // make constructors and `_next` field only available to `TreeSet` class
     // to avoid instantiating node and mutating `_next` outside `TreeSet` class.
 
-    template <typename U>
+    template <typename U, typename Compare, typename A, typename L>
     friend class TreeSet;
 
-    BinaryTreeNode<T> *_left;
-    BinaryTreeNode<T> *_right;
-    BinaryTreeNode<T> *_parent = nullptr;
-    Color _color;
-
+    // links and color are stored as `Layout` decides, see NodeLayout.hpp
+    using Links = typename Layout::template links<BinaryTreeNode>;
+    using Links::_left;
+    using Links::_right;
+    using Links::_parent;
+    using Links::color;
+    using Links::set_color;
 
-    explicit BinaryTreeNode(T value) :
-        _left(nullptr), _right(nullptr), value(value), _color(Red) {}
+    explicit BinaryTreeNode(T value) : value(std::move(value)) {}
 
-    BinaryTreeNode(T value, Color color) :
-        _left(nullptr), _right(nullptr), value(value), _color(color) {}
+    BinaryTreeNode(T value, Color color) : value(std::move(value)) { set_color(color); }
 
-    BinaryTreeNode(T value, BinaryTreeNode<T> *left, BinaryTreeNode<T> *right) :
-        _left(left), _right(right), value(value) {}
-
-    BinaryTreeNode(T value, BinaryTreeNode<T> *left, BinaryTreeNode<T> *right, Color color) :
-        _left(left), _right(right), value(value), _color(color) {}
+    BinaryTreeNode(T value, BinaryTreeNode *left, BinaryTreeNode *right) : value(std::move(value)) {
+        _left = left;
+        _right = right;
+    }
 
-    int black_height() const {
-        int left_black_height = _left ? _left->black_height() : 0;
-        int right_black_height = _right ? _right->black_height() : 0;
-        return (_color == Black ? 1 : 0) + std::max(left_black_height, right_black_height);
+    BinaryTreeNode(T value, BinaryTreeNode *left, BinaryTreeNode *right, Color color) : value(std::move(value)) {
+        _left = left;
+        _right = right;
+        set_color(color);
     }
 
+    template <typename... Args>
+    explicit BinaryTreeNode(std::in_place_t, Args &&...args) : value(std::forward<Args>(args)...) {}
+
 public:
     T value;
-    BinaryTreeNode<T> *left() { return _left; }
-    BinaryTreeNode<T> *right() { return _right; }
+    BinaryTreeNode *left() { return _left; }
+    BinaryTreeNode *right() { return _right; }
 
     /// @brief check if the tree is balanced
     /// @return true if the tree is balanced, otherwise false
     /// @note see defintion "Red-Black properties" on textbook 13.1 P.331-332
     bool is_rbtree() const {
-        // Property 1: Every node is either Red or Black
-        if (_color != Red && _color != Black)
-        {
-            return false;
-        }
+        return is_rbtree([](const T &, const T &) { return true; });
+    }
 
+    /// @brief check the red-black properties, the parent links, and that
+    ///        `less(a, b)` holds for every pair of neighbouring values
+    /// @note O(n) in one in-order pass with an explicit stack, so deep or
+    ///       large trees cannot overflow the call stack
+    template <typename Less>
+    bool is_rbtree(Less less) const {
         // Property 2: The root is Black
-        if (_parent == nullptr && _color != Black)
+        if (_parent == nullptr && color() != Black)
         {
             return false;
         }
 
-        // Property 3: All leaves (nullptr) are Black - this is covered implicitly
-
-        // Property 4: If a node is Red, then both its children are Black
-        if (_color == Red)
+        // each entry is a node still to visit with the black nodes from
+        // `this` down to it, itself included
+        std::vector<std::pair<const BinaryTreeNode *, int>> stack;
+        const BinaryTreeNode *node = this;
+        const BinaryTreeNode *previous = nullptr;
+        int blacks = 0;
+        int leaf_blacks = -1;
+        while (node || !stack.empty())
         {
-            if ((_left && _left->_color != Black) || (_right && _right->_color != Black))
+            for (; node; node = node->_left)
+            {
+                // Property 1: Every node is either Red or Black
+                if (node->color() != Red && node->color() != Black)
+                {
+                    return false;
+                }
+                // Property 4: If a node is Red, then both its children are Black
+                if (node->color() == Red &&
+                    ((node->_left && node->_left->color() != Black) || (node->_right && node->_right->color() != Black)))
+                {
+                    return false;
+                }
+                if ((node->_left && node->_left->_parent != node) || (node->_right && node->_right->_parent != node))
+                {
+                    return false;
+                }
+                blacks += node->color() == Black ? 1 : 0;
+                stack.push_back({node, blacks});
+            }
+            node = stack.back().first;
+            blacks = stack.back().second;
+            stack.pop_back();
+            if (previous && !less(previous->value, node->value))
             {
                 return false;
             }
-        }
+            previous = node;
 
-        // Property 5: Every path from a node to a descendant nullptr contains the same number of Black nodes
-        int left_black_height = _left ? _left->black_height() : 0;
-        int right_black_height = _right ? _right->black_height() : 0;
-        if (left_black_height != right_black_height)
-        {
-            return false;
+            // Property 5: Every path from a node to a descendant nullptr contains the same number of Black nodes.
+            // Property 3: All leaves (nullptr) are Black - this is covered implicitly
+            // A node with a missing child ends such a path.
+            if (!node->_left || !node->_right)
+            {
+                if (leaf_blacks < 0)
+                {
+                    leaf_blacks = blacks;
+                }
+                else if (leaf_blacks != blacks)
+                {
+                    return false;
+                }
+            }
+            node = node->_right;
         }
-
-        bool left_balanced = _left ? _left->is_rbtree() : true;
-        bool right_balanced = _right ? _right->is_rbtree() : true;
-
-        return left_balanced && right_balanced;
+        return true;
     }
 
 };
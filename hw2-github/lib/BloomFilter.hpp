@@ -0,0 +1,144 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// @brief hash of the elements a filter is kept for
+/// Uses `std::hash<T>` by default. Any callable `size_t(const T &)` can be
+/// supplied instead, and must be when `std::hash<T>` does not exist or does
+/// not agree with the container's comparator: elements that compare equal
+/// have to hash equal.
+template <typename T>
+class FilterHash
+{
+private:
+    std::function<size_t(const T &)> _fn;
+
+public:
+    FilterHash() = default;
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, FilterHash>::value &&
+                                          std::is_invocable_r<size_t, F &, const T &>::value>>
+    FilterHash(F fn) : _fn(std::move(fn)) {}
+
+    /// @brief whether there is a hash to call: a supplied one or `std::hash<T>`
+    bool usable() const { return _fn || std::is_default_constructible<std::hash<T>>::value; }
+
+    size_t operator()(const T &x) const {
+        if (_fn) return _fn(x);
+        if constexpr (std::is_default_constructible<std::hash<T>>::value) {
+            return std::hash<T>{}(x);
+        } else {
+            return 0; // not reached: containers check `usable()` first
+        }
+    }
+};
+
+/// @brief Bloom filter whose bits for one key all lie in a single 64-byte block
+/// A query reads one cache line. Keys are added as 64-bit hashes, which are
+/// remixed first, so weak hashes such as the identity `std::hash<int>` are
+/// fine. There is no removal; rebuild from the live keys instead.
+class BlockedBloomFilter
+{
+private:
+    struct alignas(64) Block {
+        uint64_t words[8];
+    };
+
+    static constexpr unsigned BLOCK_BITS = 512;
+
+    std::vector<Block> _blocks;
+    unsigned _hashes = 1;
+    size_t _capacity = 0;
+    size_t _count = 0;
+
+    // splitmix64 finalizer
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    const Block &block_of(uint64_t h) const {
+        return _blocks[static_cast<size_t>((static_cast<unsigned __int128>(h) * _blocks.size()) >> 64)];
+    }
+
+    // bit i of the key within its block: 9 bits of a second mix per probe,
+    // remixed once seven probes have used up the 63 usable bits
+    template <typename Visit>
+    void for_each_bit(uint64_t h, Visit &&visit) const {
+        uint64_t bits = mix(h ^ 0x9e3779b97f4a7c15ULL);
+        for (unsigned i = 0; i < _hashes; ++i) {
+            if (i > 0 && i % 7 == 0) {
+                bits = mix(bits);
+            }
+            unsigned bit = static_cast<unsigned>(bits >> (9 * (i % 7))) & (BLOCK_BITS - 1);
+            if (!visit(bit >> 6, uint64_t(1) << (bit & 63))) return;
+        }
+    }
+
+public:
+    BlockedBloomFilter() { reset(0, 10); }
+
+    /// @brief an empty filter for up to `capacity` keys
+    /// @param bits_per_key memory per key of capacity; about 10 gives 1%
+    ///        false positives, each 5 more divide that by about 10
+    BlockedBloomFilter(size_t capacity, double bits_per_key) { reset(capacity, bits_per_key); }
+
+    /// @brief drop every key and resize for up to `capacity` keys
+    void reset(size_t capacity, double bits_per_key) {
+        bits_per_key = std::max(bits_per_key, 1.0);
+        size_t bits = static_cast<size_t>(std::ceil(std::max<size_t>(capacity, 1) * bits_per_key));
+        _blocks.assign((bits + BLOCK_BITS - 1) / BLOCK_BITS, Block{});
+        // k = ln 2 * bits per key minimizes false positives for a plain Bloom filter
+        _hashes = static_cast<unsigned>(std::clamp(std::lround(bits_per_key * 0.6931), 1L, 16L));
+        _capacity = capacity;
+        _count = 0;
+    }
+
+    /// @brief add the key with hash `hash`
+    void insert(uint64_t hash) {
+        uint64_t h = mix(hash);
+        Block &block = const_cast<Block &>(block_of(h));
+        for_each_bit(h, [&](unsigned word, uint64_t bit) {
+            block.words[word] |= bit;
+            return true;
+        });
+        _count++;
+    }
+
+    /// @brief whether a key with hash `hash` may have been added
+    /// @return false only if it certainly was not
+    bool may_contain(uint64_t hash) const {
+        uint64_t h = mix(hash);
+        const Block &block = block_of(h);
+        bool found = true;
+        for_each_bit(h, [&](unsigned word, uint64_t bit) {
+            found = (block.words[word] & bit) != 0;
+            return found;
+        });
+        return found;
+    }
+
+    /// @brief number of keys the filter was sized for
+    size_t capacity() const { return _capacity; }
+
+    /// @brief number of `insert` calls since the last reset
+    size_t count() const { return _count; }
+
+    /// @brief bytes of filter bits
+    size_t bytes() const { return _blocks.size() * sizeof(Block); }
+};
+
+#endif
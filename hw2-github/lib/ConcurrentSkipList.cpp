@@ -0,0 +1,373 @@
+#ifndef CONCURRENT_SKIP_LIST_CPP
+#define CONCURRENT_SKIP_LIST_CPP
+
+#include <functional>
+#include <new>
+#include "ConcurrentSkipList.hpp"
+
+// Constructor
+template <typename T, typename Compare>
+ConcurrentSkipList<T, Compare>::ConcurrentSkipList() : ConcurrentSkipList(Compare()) {}
+
+// Constructor with a custom comparator
+template <typename T, typename Compare>
+ConcurrentSkipList<T, Compare>::ConcurrentSkipList(Compare comparator)
+    : _head(allocate_node(MAX_LEVEL - 1)), _comparator(std::move(comparator)), _size(0) {
+    _head->fully_linked.store(true, std::memory_order_relaxed);
+}
+
+// Constructor - adds the items one by one
+template <typename T, typename Compare>
+ConcurrentSkipList<T, Compare>::ConcurrentSkipList(const std::vector<T> &items) : ConcurrentSkipList() {
+    for (const T &item : items) {
+        add(item);
+    }
+}
+
+// Allocate a node with exactly `level + 1` links after it
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::Node *ConcurrentSkipList<T, Compare>::allocate_node(int level) {
+    using Link = typename Node::Link;
+    void *memory = ::operator new(LINKS_OFFSET + (level + 1) * sizeof(Link));
+    Node *node = new (memory) Node(level);
+    for (int l = 0; l <= level; ++l) {
+        new (node->next() + l) Link(nullptr);
+    }
+    return node;
+}
+
+// Free a node whose value is already gone, or the head
+template <typename T, typename Compare>
+void ConcurrentSkipList<T, Compare>::free_node(Node *node) {
+    node->~Node();
+    ::operator delete(node);
+}
+
+// Allocate a node and copy value into it
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::Node *ConcurrentSkipList<T, Compare>::create_node(const T &value, int level) {
+    Node *node = allocate_node(level);
+    new (&node->value) T(value);
+    return node;
+}
+
+// Destroy a node's value and free it
+template <typename T, typename Compare>
+void ConcurrentSkipList<T, Compare>::destroy_node(void *node) {
+    Node *n = static_cast<Node *>(node);
+    n->value.~T();
+    free_node(n);
+}
+
+// Geometric level from a per-thread xorshift generator
+template <typename T, typename Compare>
+int ConcurrentSkipList<T, Compare>::random_level() {
+    thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    int level = 0;
+    for (uint64_t bits = state; level < MAX_LEVEL - 1 && (bits & 1); bits >>= 1) {
+        ++level;
+    }
+    return level;
+}
+
+// Descend from the top level, recording the last node before `value` on each
+template <typename T, typename Compare>
+int ConcurrentSkipList<T, Compare>::find(const T &value, Node **preds, Node **succs) const {
+    int found = -1;
+    Node *pred = _head;
+    for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+        Node *curr = pred->next()[level].load(std::memory_order_acquire);
+        while (curr && _comparator(curr->value, value) < 0) {
+            pred = curr;
+            curr = pred->next()[level].load(std::memory_order_acquire);
+        }
+        if (found == -1 && curr && _comparator(curr->value, value) == 0) {
+            found = level;
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return found;
+}
+
+// Same descent as `find`, stopping at the first level that holds `value`
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::Node *ConcurrentSkipList<T, Compare>::find_live(const T &value) const {
+    Node *pred = _head;
+    for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+        Node *curr = pred->next()[level].load(std::memory_order_acquire);
+        int cmp = 1;
+        while (curr && (cmp = _comparator(curr->value, value)) < 0) {
+            pred = curr;
+            curr = pred->next()[level].load(std::memory_order_acquire);
+        }
+        if (curr && cmp == 0) {
+            return is_live(curr) ? curr : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+// Walk the bottom level past removed and half-inserted nodes
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::Node *ConcurrentSkipList<T, Compare>::skip_dead(Node *node) {
+    while (node && !is_live(node)) {
+        node = node->next()[0].load(std::memory_order_acquire);
+    }
+    return node;
+}
+
+// Size
+template <typename T, typename Compare>
+size_t ConcurrentSkipList<T, Compare>::size() const {
+    return _size.load(std::memory_order_relaxed);
+}
+
+// Add - lock the predecessors bottom-up, check nothing changed around them, link bottom-up
+template <typename T, typename Compare>
+bool ConcurrentSkipList<T, Compare>::add(const T &value) {
+    const int top = random_level();
+    Node *preds[MAX_LEVEL];
+    Node *succs[MAX_LEVEL];
+    EpochReclaimer::Guard guard;
+    while (true) {
+        int found = find(value, preds, succs);
+        if (found != -1) {
+            Node *existing = succs[found];
+            if (!existing->marked.load(std::memory_order_acquire)) {
+                // an equal add is linking it; it counts once it is complete
+                while (!existing->fully_linked.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                return false;
+            }
+            continue; // being removed; retry once it is unlinked
+        }
+
+        bool valid = true;
+        int locked = -1;
+        Node *last = nullptr;
+        for (int level = 0; valid && level <= top; ++level) {
+            Node *pred = preds[level], *succ = succs[level];
+            if (pred != last) {
+                pred->lock.lock();
+                last = pred;
+            }
+            locked = level;
+            valid = !pred->marked.load(std::memory_order_acquire) &&
+                    (!succ || !succ->marked.load(std::memory_order_acquire)) &&
+                    pred->next()[level].load(std::memory_order_acquire) == succ;
+        }
+        if (valid) {
+            Node *node = create_node(value, top);
+            for (int level = 0; level <= top; ++level) {
+                node->next()[level].store(succs[level], std::memory_order_relaxed);
+            }
+            for (int level = 0; level <= top; ++level) {
+                preds[level]->next()[level].store(node, std::memory_order_release);
+            }
+            _size.fetch_add(1, std::memory_order_relaxed);
+            node->fully_linked.store(true, std::memory_order_release);
+        }
+        last = nullptr;
+        for (int level = 0; level <= locked; ++level) {
+            if (preds[level] != last) {
+                preds[level]->lock.unlock();
+                last = preds[level];
+            }
+        }
+        if (valid) return true;
+    }
+}
+
+// Remove - mark the node under its lock, then unlink it top-down under the predecessors' locks
+template <typename T, typename Compare>
+bool ConcurrentSkipList<T, Compare>::remove(const T &value) {
+    Node *preds[MAX_LEVEL];
+    Node *succs[MAX_LEVEL];
+    Node *victim = nullptr;
+    EpochReclaimer::Guard guard;
+    while (true) {
+        int found = find(value, preds, succs);
+        if (!victim) {
+            // only a complete node found at its own top level may be removed
+            if (found == -1) return false;
+            Node *node = succs[found];
+            if (!node->fully_linked.load(std::memory_order_acquire) || node->top_level != found ||
+                node->marked.load(std::memory_order_acquire)) {
+                return false;
+            }
+            node->lock.lock();
+            if (node->marked.load(std::memory_order_relaxed)) {
+                node->lock.unlock();
+                return false;
+            }
+            node->marked.store(true, std::memory_order_release);
+            victim = node;
+        }
+
+        const int top = victim->top_level;
+        bool valid = true;
+        int locked = -1;
+        Node *last = nullptr;
+        for (int level = 0; valid && level <= top; ++level) {
+            Node *pred = preds[level];
+            if (pred != last) {
+                pred->lock.lock();
+                last = pred;
+            }
+            locked = level;
+            valid = !pred->marked.load(std::memory_order_acquire) &&
+                    pred->next()[level].load(std::memory_order_acquire) == victim;
+        }
+        if (valid) {
+            for (int level = top; level >= 0; --level) {
+                preds[level]->next()[level].store(victim->next()[level].load(std::memory_order_relaxed),
+                                                std::memory_order_release);
+            }
+            victim->lock.unlock();
+            _size.fetch_sub(1, std::memory_order_relaxed);
+        }
+        last = nullptr;
+        for (int level = 0; level <= locked; ++level) {
+            if (preds[level] != last) {
+                preds[level]->lock.unlock();
+                last = preds[level];
+            }
+        }
+        if (valid) {
+            EpochReclaimer::instance().retire(victim, &destroy_node);
+            return true;
+        }
+    }
+}
+
+// Contains
+template <typename T, typename Compare>
+bool ConcurrentSkipList<T, Compare>::contains(const T &value) const {
+    EpochReclaimer::Guard guard;
+    return find_live(value) != nullptr;
+}
+
+// Get - the copy is taken while the node is still protected
+template <typename T, typename Compare>
+std::optional<T> ConcurrentSkipList<T, Compare>::get(const T &value) const {
+    EpochReclaimer::Guard guard;
+    Node *node = find_live(value);
+    if (!node) return std::nullopt;
+    return node->value;
+}
+
+// Is empty
+template <typename T, typename Compare>
+bool ConcurrentSkipList<T, Compare>::is_empty() const {
+    EpochReclaimer::Guard guard;
+    return skip_dead(_head->next()[0].load(std::memory_order_acquire)) == nullptr;
+}
+
+// Min
+template <typename T, typename Compare>
+std::optional<T> ConcurrentSkipList<T, Compare>::min() const {
+    EpochReclaimer::Guard guard;
+    Node *node = skip_dead(_head->next()[0].load(std::memory_order_acquire));
+    if (!node) return std::nullopt;
+    return node->value;
+}
+
+// Max - descend to the last node; if it is dead, search again for the last node before it
+template <typename T, typename Compare>
+std::optional<T> ConcurrentSkipList<T, Compare>::max() const {
+    EpochReclaimer::Guard guard;
+    Node *bound = nullptr;
+    while (true) {
+        Node *pred = _head;
+        for (int level = MAX_LEVEL - 1; level >= 0; --level) {
+            Node *next;
+            while ((next = pred->next()[level].load(std::memory_order_acquire)) &&
+                   (!bound || _comparator(next->value, bound->value) < 0)) {
+                pred = next;
+            }
+        }
+        if (pred == _head) return std::nullopt;
+        if (is_live(pred)) return pred->value;
+        bound = pred;
+    }
+}
+
+// To vector
+template <typename T, typename Compare>
+std::vector<T> ConcurrentSkipList<T, Compare>::to_vector() const {
+    std::vector<T> result;
+    result.reserve(size());
+    for (const T &value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Begin - pins the thread before the first link is read
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::const_iterator ConcurrentSkipList<T, Compare>::begin() const {
+    const_iterator it;
+    it._guard.emplace();
+    it._node = skip_dead(_head->next()[0].load(std::memory_order_acquire));
+    return it;
+}
+
+// End
+template <typename T, typename Compare>
+typename ConcurrentSkipList<T, Compare>::const_iterator ConcurrentSkipList<T, Compare>::end() const {
+    return const_iterator();
+}
+
+// Is valid - every level sorted and a subsequence of the level below
+template <typename T, typename Compare>
+bool ConcurrentSkipList<T, Compare>::is_valid() const {
+    EpochReclaimer::Guard guard;
+    size_t count = 0;
+    for (Node *node = _head->next()[0].load(); node; node = node->next()[0].load()) {
+        if (!is_live(node)) return false;
+        Node *next = node->next()[0].load();
+        if (next && _comparator(node->value, next->value) >= 0) return false;
+        ++count;
+    }
+    if (count != size()) return false;
+    for (int level = 1; level < MAX_LEVEL; ++level) {
+        Node *below = _head->next()[level - 1].load();
+        for (Node *node = _head->next()[level].load(); node; node = node->next()[level].load()) {
+            if (node->top_level < level) return false;
+            while (below && below != node) {
+                below = below->next()[level - 1].load();
+            }
+            if (!below) return false;
+        }
+    }
+    return true;
+}
+
+// Clear - frees the nodes at once, as no other thread may be using them
+template <typename T, typename Compare>
+void ConcurrentSkipList<T, Compare>::clear() {
+    Node *node = _head->next()[0].load();
+    while (node) {
+        Node *next = node->next()[0].load();
+        destroy_node(node);
+        node = next;
+    }
+    for (int level = 0; level < MAX_LEVEL; ++level) {
+        _head->next()[level].store(nullptr);
+    }
+    _size.store(0);
+}
+
+// Destructor
+template <typename T, typename Compare>
+ConcurrentSkipList<T, Compare>::~ConcurrentSkipList() {
+    clear();
+    free_node(_head);
+}
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef CONCURRENT_SKIP_LIST_HPP
+#define CONCURRENT_SKIP_LIST_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "EpochReclaimer.hpp"
+#include "TreeSet.hpp"
+
+/// @brief ordered set that any number of threads may read and write at once
+/// A lazy skip list (Herlihy, Lev, Luchangco and Shavit): `contains`, `get`,
+/// `min`, `max` and iteration take no locks, while `add` and `remove` lock
+/// only the few predecessor nodes they relink. A removed node is first
+/// marked, so readers skip it, then unlinked, then handed to the
+/// `EpochReclaimer`, which frees it once no reader can still be on it.
+/// Offers the `TreeSet` interface except for the operations that need a
+/// consistent view of the whole set (set algebra, rank, erase_range).
+/// @tparam T type of the elements; values are never modified after insertion
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1,
+///         safe to call from several threads at once
+template <typename T, typename Compare = DefaultComparator<T>>
+class ConcurrentSkipList
+{
+private:
+    static constexpr int MAX_LEVEL = 24; // 2^24 elements per top-level node on average
+
+    /// test-and-test-and-set lock that yields instead of spinning long,
+    /// since holders are often descheduled when threads outnumber cores
+    class SpinLock
+    {
+    private:
+        std::atomic<bool> _locked{false};
+
+    public:
+        void lock() {
+            for (unsigned spins = 0; _locked.exchange(true, std::memory_order_acquire); ++spins) {
+                while (_locked.load(std::memory_order_relaxed)) {
+                    if (spins++ > 16) std::this_thread::yield();
+                }
+            }
+        }
+        void unlock() { _locked.store(false, std::memory_order_release); }
+    };
+
+    /// followed in the same allocation by `top_level + 1` links, see `next()`
+    struct Node {
+        union {
+            T value; // constructed by `create_node`; the head has none
+        };
+        int top_level;
+        std::atomic<bool> marked{false};       // logically removed
+        std::atomic<bool> fully_linked{false}; // linked at every level
+        SpinLock lock;
+
+        using Link = std::atomic<Node *>;
+
+        explicit Node(int level) : top_level(level) {}
+        ~Node() {} // `value` is destroyed by `destroy_node`
+
+        /// @brief the links, one per level from 0 to `top_level`
+        Link *next() { return reinterpret_cast<Link *>(reinterpret_cast<char *>(this) + LINKS_OFFSET); }
+    };
+
+    /// where the links start, past the node and aligned for them
+    static constexpr size_t LINKS_OFFSET =
+        (sizeof(Node) + alignof(typename Node::Link) - 1) / alignof(typename Node::Link) * alignof(typename Node::Link);
+
+    Node *_head; // sentinel at every level; the tail is nullptr
+    Compare _comparator;
+    std::atomic<size_t> _size;
+
+    /// @brief a node with null links and no value
+    static Node *allocate_node(int level);
+    static void free_node(Node *node);
+
+    static Node *create_node(const T &value, int level);
+    /// @brief destroy the value and free the node; also the reclaimer callback
+    static void destroy_node(void *node);
+
+    /// @brief a random level, 0 with probability 1/2, 1 with 1/4, and so on
+    static int random_level();
+
+    /// @brief fill `preds` and `succs` with the nodes around `value` at every level
+    /// @return the highest level at which a node equal to `value` was found, or -1
+    int find(const T &value, Node **preds, Node **succs) const;
+
+    /// @brief the live node equal to `value`, or null; the caller must be pinned
+    Node *find_live(const T &value) const;
+
+    /// @brief a node that is linked everywhere and not removed
+    static bool is_live(const Node *node) {
+        return node->fully_linked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire);
+    }
+
+    /// @brief first live node at or after `node` on the bottom level
+    static Node *skip_dead(Node *node);
+
+public:
+    /// @brief forward iterator over the set in order; weakly consistent
+    /// Sees every element present for the whole iteration, and may or may
+    /// not see elements added or removed meanwhile. Keeps its thread pinned
+    /// (see `EpochReclaimer`) until destroyed, so it must stay on the thread
+    /// that made it, and long-lived iterators hold back reclamation.
+    class const_iterator
+    {
+    private:
+        friend class ConcurrentSkipList;
+        Node *_node;
+        std::optional<EpochReclaimer::Guard> _guard; // empty for end()
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : _node(nullptr) {}
+
+        reference operator*() const { return _node->value; }
+        pointer operator->() const { return &_node->value; }
+
+        const_iterator &operator++() {
+            _node = skip_dead(_node->next()[0].load(std::memory_order_acquire));
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const { return _node == other._node; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = const_iterator;
+
+    ConcurrentSkipList();
+    ConcurrentSkipList(Compare comparator);
+    ConcurrentSkipList(const std::vector<T> &items);
+    ConcurrentSkipList(const ConcurrentSkipList &) = delete;
+    ConcurrentSkipList &operator=(const ConcurrentSkipList &) = delete;
+
+    /// @brief the number of elements
+    /// @note exact when no thread is writing, otherwise a recent count
+    size_t size() const;
+
+    /// @brief adds a value to the set unless an equal one is already there
+    /// @return true if `value` was added
+    /// @note unlike `TreeSet::add`, an equal element is not replaced, since
+    ///       readers on other threads may be looking at it
+    bool add(const T &value);
+
+    /// @brief removes a value from the set
+    /// @return true if this call removed it
+    bool remove(const T &value);
+
+    /// @brief check if a element is in the set; wait-free
+    bool contains(const T &value) const;
+
+    /// @brief finds an element equal to `value` and returns a copy of it
+    std::optional<T> get(const T &value) const;
+
+    /// @brief check if the set is empty
+    bool is_empty() const;
+
+    /// @brief the smallest element, or std::nullopt if empty
+    std::optional<T> min() const;
+
+    /// @brief the largest element, or std::nullopt if empty
+    std::optional<T> max() const;
+
+    /// @brief the elements in order, see `const_iterator` for consistency
+    std::vector<T> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// @brief check that every level is sorted, holds only nodes that are on
+    ///        the level below, and that the bottom level matches `size()`
+    /// @note only meaningful while no thread is writing
+    bool is_valid() const;
+
+    /// @brief remove every element
+    /// @note not safe while other threads use the set
+    void clear();
+    ~ConcurrentSkipList();
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef EPOCH_RECLAIMER_HPP
+#define EPOCH_RECLAIMER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/// @brief epoch-based reclamation of nodes unlinked from concurrent containers
+/// A thread pins the current epoch for as long as it may hold pointers into
+/// a shared structure. Unlinked nodes are retired rather than freed, and a
+/// node retired in epoch e is freed once the global epoch reaches e + 2: by
+/// then every thread that was pinned when it was unlinked has unpinned. The
+/// epoch only advances when every pinned thread has seen the current one, so
+/// a thread that stays pinned delays reclamation (but never blocks anyone).
+/// There is one process-wide instance; each thread gets a record on first
+/// use, which is handed to the next new thread once it exits.
+class EpochReclaimer
+{
+private:
+    static constexpr size_t COLLECT_EVERY = 64; // retirements between reclamation attempts
+
+    struct Retired {
+        void *node;
+        void (*free)(void *);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) Record {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> pinned{false};
+        std::atomic<bool> in_use{false};
+        unsigned depth = 0; // nested pins of the owning thread
+        std::vector<Retired> retired;
+        Record *next = nullptr;
+    };
+
+    std::atomic<uint64_t> _epoch{2};
+    std::atomic<Record *> _records{nullptr};
+
+    EpochReclaimer() = default;
+
+    ~EpochReclaimer() {
+        // runs at exit, after every other thread has finished
+        for (Record *record = _records.load(); record;) {
+            for (const Retired &r : record->retired) {
+                r.free(r.node);
+            }
+            Record *next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    /// @brief this thread's record, claimed on first use and released at thread exit
+    Record *record() {
+        struct Owner {
+            Record *record = nullptr;
+            ~Owner() {
+                if (record) record->in_use.store(false, std::memory_order_release);
+            }
+        };
+        thread_local Owner owner;
+        if (!owner.record) {
+            owner.record = claim();
+        }
+        return owner.record;
+    }
+
+    Record *claim() {
+        for (Record *record = _records.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) && record->in_use.compare_exchange_strong(expected, true)) {
+                return record;
+            }
+        }
+        Record *record = new Record();
+        record->in_use.store(true, std::memory_order_relaxed);
+        Record *head = _records.load(std::memory_order_relaxed);
+        do {
+            record->next = head;
+        } while (!_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+        return record;
+    }
+
+    /// @brief advance the epoch if every pinned thread has seen the current one
+    void try_advance() {
+        uint64_t epoch = _epoch.load();
+        for (Record *record = _records.load(std::memory_order_acquire); record; record = record->next) {
+            if (record->pinned.load() && record->epoch.load() != epoch) return;
+        }
+        _epoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    /// @brief free this thread's retired nodes that no pinned thread can see
+    void collect(Record *record) {
+        try_advance();
+        uint64_t safe = _epoch.load();
+        size_t kept = 0;
+        for (const Retired &r : record->retired) {
+            if (r.epoch + 2 <= safe) {
+                r.free(r.node);
+            } else {
+                record->retired[kept++] = r;
+            }
+        }
+        record->retired.resize(kept);
+    }
+
+public:
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    static EpochReclaimer &instance() {
+        static EpochReclaimer reclaimer;
+        return reclaimer;
+    }
+
+    /// @brief keeps the calling thread pinned while it exists; may be nested
+    /// and copied, but only used on the thread that made it
+    class Guard
+    {
+    private:
+        Record *_record;
+
+    public:
+        Guard() : _record(instance().record()) {
+            if (_record->depth++ == 0) {
+                _record->epoch.store(instance()._epoch.load());
+                _record->pinned.store(true);
+                // the announcement must be visible before any shared pointer is read
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+        Guard(const Guard &other) : _record(other._record) { _record->depth++; }
+        Guard &operator=(const Guard &) = default; // same thread, same record
+        ~Guard() {
+            if (--_record->depth == 0) {
+                _record->pinned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    /// @brief free `node` with `free(node)` once no thread can still reach it
+    /// @note the caller must have unlinked `node` already and be pinned
+    void retire(void *node, void (*free)(void *)) {
+        Record *record = this->record();
+        record->retired.push_back({node, free, _epoch.load()});
+        if (record->retired.size() % COLLECT_EVERY == 0) {
+            collect(record);
+        }
+    }
+
+    /// @brief number of nodes retired by this thread and not freed yet
+    size_t pending() { return record()->retired.size(); }
+};
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef FROZEN_TREE_SET_CPP
+#define FROZEN_TREE_SET_CPP
+
+#include <algorithm>
+#include <type_traits>
+#include "FrozenTreeSet.hpp"
+
+// Constructor
+template <typename T, typename Compare>
+FrozenTreeSet<T, Compare>::FrozenTreeSet() : FrozenTreeSet(std::vector<T>(), Compare()) {}
+
+// Constructor - initial items
+template <typename T, typename Compare>
+FrozenTreeSet<T, Compare>::FrozenTreeSet(const std::vector<T> &items) : FrozenTreeSet(items, Compare()) {}
+
+// Constructor - initial items and comparator
+template <typename T, typename Compare>
+FrozenTreeSet<T, Compare>::FrozenTreeSet(const std::vector<T> &items, Compare comparator)
+    : _size(0), _comparator(std::move(comparator)), _natural(false) {
+    if constexpr (std::is_same<Compare, DefaultComparator<T>>::value) {
+        _natural = _comparator.is_natural();
+    }
+    auto less = [this](const T &a, const T &b) { return _comparator(a, b) < 0; };
+    auto strictly_increasing = [&](const std::vector<T> &values) {
+        return std::adjacent_find(values.begin(), values.end(),
+                                  [&](const T &a, const T &b) { return !less(a, b); }) == values.end();
+    };
+
+    if (strictly_increasing(items)) {
+        _size = items.size();
+        _data.resize(_size + 1);
+        fill(items, 0, 1);
+        return;
+    }
+    std::vector<T> sorted = items;
+    std::stable_sort(sorted.begin(), sorted.end(), less);
+    // keep the last of each run of equal elements, as repeated adds would
+    auto out = sorted.begin();
+    for (auto it = sorted.begin(); it != sorted.end(); ++it) {
+        if (std::next(it) != sorted.end() && !less(*it, *std::next(it))) continue;
+        if (out != it) *out = std::move(*it);
+        ++out;
+    }
+    sorted.erase(out, sorted.end());
+    _size = sorted.size();
+    _data.resize(_size + 1);
+    fill(sorted, 0, 1);
+}
+
+// Index of the highest set bit
+template <typename T, typename Compare>
+int FrozenTreeSet<T, Compare>::floor_log2(size_t k) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(static_cast<unsigned long long>(k));
+#else
+    int log = 0;
+    while (k >>= 1) log++;
+    return log;
+#endif
+}
+
+// In-order successor: leftmost of the right subtree, else the first
+// ancestor reached from its left side
+template <typename T, typename Compare>
+size_t FrozenTreeSet<T, Compare>::next_index(size_t k) const {
+    if (2 * k + 1 <= _size) {
+        k = 2 * k + 1;
+        while (2 * k <= _size) k = 2 * k;
+        return k;
+    }
+    while (k & 1) k >>= 1;
+    return k >> 1;
+}
+
+// In-order predecessor, mirroring next_index
+template <typename T, typename Compare>
+size_t FrozenTreeSet<T, Compare>::prev_index(size_t k) const {
+    if (k == 0) {
+        k = _size ? 1 : 0;
+        while (k && 2 * k + 1 <= _size) k = 2 * k + 1;
+        return k;
+    }
+    if (2 * k <= _size) {
+        k = 2 * k;
+        while (2 * k + 1 <= _size) k = 2 * k + 1;
+        return k;
+    }
+    while (k > 1 && !(k & 1)) k >>= 1;
+    return k >> 1;
+}
+
+// Full levels below k plus its share of the partial last level
+template <typename T, typename Compare>
+size_t FrozenTreeSet<T, Compare>::subtree_size(size_t k) const {
+    if (k > _size) return 0;
+    int levels = floor_log2(_size) - floor_log2(k);
+    size_t full = (size_t(1) << levels) - 1;
+    size_t first = k << levels;
+    size_t last = first > _size ? 0 : std::min(_size - first + 1, size_t(1) << levels);
+    return full + last;
+}
+
+// In-order fill of the implicit tree
+template <typename T, typename Compare>
+size_t FrozenTreeSet<T, Compare>::fill(const std::vector<T> &sorted, size_t i, size_t k) {
+    if (k <= _size) {
+        i = fill(sorted, i, 2 * k);
+        _data[k] = sorted[i++];
+        i = fill(sorted, i, 2 * k + 1);
+    }
+    return i;
+}
+
+// Branch-free descent with prefetch
+template <typename T, typename Compare>
+template <bool Strict, typename K, typename Cmp>
+size_t FrozenTreeSet<T, Compare>::descend(const K &key, const Cmp &cmp) const {
+    // the 2^d descendants d levels down are contiguous; fetch the line that
+    // holds them while the levels in between are compared
+    constexpr size_t stride = sizeof(T) >= 64 ? 1 : 64 / sizeof(T);
+    const T *data = _data.data();
+    size_t k = 1;
+    while (k <= _size) {
+#if defined(__GNUC__)
+        __builtin_prefetch(reinterpret_cast<const char *>(data) + k * stride * sizeof(T));
+#endif
+        int c = cmp(key, data[k]);
+        k = 2 * k + (Strict ? c >= 0 : c > 0);
+    }
+    // drop the right turns taken after the answer, then the final left turn
+    while (k & 1) k >>= 1;
+    return k >> 1;
+}
+
+// Picks the inlined comparison when the order is natural
+template <typename T, typename Compare>
+template <bool Strict, typename K>
+size_t FrozenTreeSet<T, Compare>::bound_index(const K &key) const {
+    if constexpr (std::is_arithmetic<T>::value && std::is_same<K, T>::value) {
+        if (_natural) {
+            return descend<Strict>(key, [](const T &a, const T &b) { return int(a > b) - int(a < b); });
+        }
+    }
+    return descend<Strict>(key, _comparator);
+}
+
+// returns set elements
+template <typename T, typename Compare>
+size_t FrozenTreeSet<T, Compare>::size() const {
+    return _size;
+}
+
+// Check if the set is empty
+template <typename T, typename Compare>
+bool FrozenTreeSet<T, Compare>::is_empty() const {
+    return _size == 0;
+}
+
+// Check if key is in the set
+template <typename T, typename Compare>
+template <typename K>
+bool FrozenTreeSet<T, Compare>::contains(const K &key) const {
+    size_t k = bound_index<false>(key);
+    return k != 0 && _comparator(key, _data[k]) == 0;
+}
+
+// First element not less than key
+template <typename T, typename Compare>
+template <typename K>
+typename FrozenTreeSet<T, Compare>::const_iterator FrozenTreeSet<T, Compare>::lower_bound(const K &key) const {
+    return const_iterator(this, bound_index<false>(key));
+}
+
+// First element greater than key
+template <typename T, typename Compare>
+template <typename K>
+typename FrozenTreeSet<T, Compare>::const_iterator FrozenTreeSet<T, Compare>::upper_bound(const K &key) const {
+    return const_iterator(this, bound_index<true>(key));
+}
+
+// Number of elements less than key, adding up left subtrees passed on the way down
+template <typename T, typename Compare>
+template <typename K>
+size_t FrozenTreeSet<T, Compare>::rank(const K &key) const {
+    size_t k = 1;
+    size_t count = 0;
+    while (k <= _size) {
+        bool right = _comparator(key, _data[k]) > 0;
+        count += right ? subtree_size(2 * k) + 1 : 0;
+        k = 2 * k + right;
+    }
+    return count;
+}
+
+// Smallest value
+template <typename T, typename Compare>
+std::optional<T> FrozenTreeSet<T, Compare>::min() const {
+    if (_size == 0) return std::nullopt;
+    return *begin();
+}
+
+// Largest value
+template <typename T, typename Compare>
+std::optional<T> FrozenTreeSet<T, Compare>::max() const {
+    if (_size == 0) return std::nullopt;
+    return *--end();
+}
+
+// Values in order
+template <typename T, typename Compare>
+std::vector<T> FrozenTreeSet<T, Compare>::to_vector() const {
+    std::vector<T> result;
+    result.reserve(_size);
+    for (const T &value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Iterator to the smallest value
+template <typename T, typename Compare>
+typename FrozenTreeSet<T, Compare>::const_iterator FrozenTreeSet<T, Compare>::begin() const {
+    size_t k = _size ? 1 : 0;
+    while (k && 2 * k <= _size) k = 2 * k;
+    return const_iterator(this, k);
+}
+
+// Iterator past the largest value
+template <typename T, typename Compare>
+typename FrozenTreeSet<T, Compare>::const_iterator FrozenTreeSet<T, Compare>::end() const {
+    return const_iterator(this, 0);
+}
+
+#endif
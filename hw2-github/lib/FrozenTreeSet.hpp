@@ -0,0 +1,163 @@
+#ifndef FROZEN_TREE_SET_HPP
+#define FROZEN_TREE_SET_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <vector>
+#include "TreeSet.hpp"
+
+/// @brief allocator handing out storage aligned to a cache line
+template <typename T>
+struct CacheAlignedAllocator
+{
+    using value_type = T;
+    static constexpr std::align_val_t ALIGNMENT{64};
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U> &) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), ALIGNMENT)); }
+    void deallocate(T *p, size_t) { ::operator delete(p, ALIGNMENT); }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U> &) const { return false; }
+};
+
+/// @brief immutable ordered set stored as a flat array in Eytzinger order
+/// Element `k` (1-based) has its children at `2k` and `2k + 1`, so a search
+/// walks the array like a binary tree without pointers and the hot top levels
+/// share a few cache lines. Each step picks a child with a comparison instead
+/// of a branch and prefetches the cache line holding the descendants a few
+/// levels down. Built by `TreeSet::freeze()` or from a vector.
+/// @tparam T type of the elements; must be default constructible
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1
+template <typename T, typename Compare = DefaultComparator<T>>
+class FrozenTreeSet
+{
+private:
+    std::vector<T, CacheAlignedAllocator<T>> _data; // `_data[0]` is unused
+    size_t _size;
+    Compare _comparator;
+    bool _natural;
+
+    static int floor_log2(size_t k);
+
+    /// @brief Eytzinger index of the in-order successor of `k`, or 0
+    size_t next_index(size_t k) const;
+
+    /// @brief Eytzinger index of the in-order predecessor of `k` (end if 0), or 0
+    size_t prev_index(size_t k) const;
+
+    /// @brief number of elements in the implicit subtree rooted at `k`
+    size_t subtree_size(size_t k) const;
+
+    /// @brief fill the subtree rooted at `k` from `sorted[i...]` in order
+    /// @return index of the first element of `sorted` not used
+    size_t fill(const std::vector<T> &sorted, size_t i, size_t k);
+
+    /// @brief branch-free descent with `cmp(key, element)`
+    /// @return Eytzinger index of the first element not less than (or, if
+    ///         `Strict`, greater than) `key`, or 0 if there is none
+    template <bool Strict, typename K, typename Cmp>
+    size_t descend(const K &key, const Cmp &cmp) const;
+
+    template <bool Strict, typename K>
+    size_t bound_index(const K &key) const;
+
+public:
+    /// @brief bidirectional iterator over the set in order
+    class const_iterator
+    {
+    private:
+        friend class FrozenTreeSet;
+        const FrozenTreeSet *_set;
+        size_t _index; // 0 is end()
+
+        const_iterator(const FrozenTreeSet *set, size_t index) : _set(set), _index(index) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : _set(nullptr), _index(0) {}
+
+        reference operator*() const { return _set->_data[_index]; }
+        pointer operator->() const { return &_set->_data[_index]; }
+
+        const_iterator &operator++() {
+            _index = _set->next_index(_index);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // decrementing end() lands on the largest element
+        const_iterator &operator--() {
+            _index = _set->prev_index(_index);
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const { return _index == other._index; }
+        bool operator!=(const const_iterator &other) const { return _index != other._index; }
+    };
+
+    using iterator = const_iterator;
+
+    FrozenTreeSet();
+
+    /// @brief build from `items` in any order, keeping the last of equal elements
+    FrozenTreeSet(const std::vector<T> &items);
+    FrozenTreeSet(const std::vector<T> &items, Compare comparator);
+
+    /// @brief Returns the number of elements in the set.
+    size_t size() const;
+
+    /// @brief check if the set is empty
+    bool is_empty() const;
+
+    /// @brief check if an element equal to `key` is in the set
+    /// @param key a `T`, or any type the comparator can compare with `T`
+    template <typename K>
+    bool contains(const K &key) const;
+
+    /// @brief first element that is not less than `key`
+    template <typename K>
+    const_iterator lower_bound(const K &key) const;
+
+    /// @brief first element that is greater than `key`
+    template <typename K>
+    const_iterator upper_bound(const K &key) const;
+
+    /// @brief number of elements less than `key`, in O(log n)
+    template <typename K>
+    size_t rank(const K &key) const;
+
+    /// @brief the smallest value in the set, or std::nullopt if empty
+    std::optional<T> min() const;
+
+    /// @brief the largest value in the set, or std::nullopt if empty
+    std::optional<T> max() const;
+
+    /// @brief a sorted vector containing all values in the set
+    std::vector<T> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+#endif
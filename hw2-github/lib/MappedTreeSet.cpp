@@ -0,0 +1,140 @@
+#ifndef MAPPED_TREE_SET_CPP
+#define MAPPED_TREE_SET_CPP
+
+#include <algorithm>
+#include "MappedTreeSet.hpp"
+
+// Constructor - maps the file
+template <typename T, typename Compare>
+MappedTreeSet<T, Compare>::MappedTreeSet(const std::string &path, Compare comparator)
+    : _run(path), _comparator(std::move(comparator)) {}
+
+// returns set elements
+template <typename T, typename Compare>
+size_t MappedTreeSet<T, Compare>::size() const {
+    return _run.size();
+}
+
+// Check if the set is empty
+template <typename T, typename Compare>
+bool MappedTreeSet<T, Compare>::is_empty() const {
+    return _run.empty();
+}
+
+// Check if key is in the set
+template <typename T, typename Compare>
+template <typename K>
+bool MappedTreeSet<T, Compare>::contains(const K &key) const {
+    const T *it = lower_bound(key);
+    return it != end() && _comparator(key, *it) == 0;
+}
+
+// Element equal to key
+template <typename T, typename Compare>
+template <typename K>
+std::optional<T> MappedTreeSet<T, Compare>::get(const K &key) const {
+    const T *it = lower_bound(key);
+    if (it == end() || _comparator(key, *it) != 0) return std::nullopt;
+    return *it;
+}
+
+// First element not less than key
+template <typename T, typename Compare>
+template <typename K>
+typename MappedTreeSet<T, Compare>::const_iterator MappedTreeSet<T, Compare>::lower_bound(const K &key) const {
+    return std::lower_bound(begin(), end(), key, [this](const T &value, const K &k) { return _comparator(k, value) > 0; });
+}
+
+// First element greater than key
+template <typename T, typename Compare>
+template <typename K>
+typename MappedTreeSet<T, Compare>::const_iterator MappedTreeSet<T, Compare>::upper_bound(const K &key) const {
+    return std::upper_bound(begin(), end(), key, [this](const K &k, const T &value) { return _comparator(k, value) < 0; });
+}
+
+// Number of elements less than key
+template <typename T, typename Compare>
+template <typename K>
+size_t MappedTreeSet<T, Compare>::rank(const K &key) const {
+    return lower_bound(key) - begin();
+}
+
+// Values in order
+template <typename T, typename Compare>
+std::vector<T> MappedTreeSet<T, Compare>::to_vector() const {
+    return std::vector<T>(begin(), end());
+}
+
+// Pointer to the smallest value
+template <typename T, typename Compare>
+typename MappedTreeSet<T, Compare>::const_iterator MappedTreeSet<T, Compare>::begin() const {
+    return _run.begin();
+}
+
+// Pointer past the largest value
+template <typename T, typename Compare>
+typename MappedTreeSet<T, Compare>::const_iterator MappedTreeSet<T, Compare>::end() const {
+    return _run.end();
+}
+
+// Constructor - maps the file
+template <typename TKey, typename TValue, typename Compare>
+MappedTreeMap<TKey, TValue, Compare>::MappedTreeMap(const std::string &path, Compare comparator)
+    : _run(path), _comparator(std::move(comparator)) {}
+
+// returns map entries
+template <typename TKey, typename TValue, typename Compare>
+size_t MappedTreeMap<TKey, TValue, Compare>::size() const {
+    return _run.size();
+}
+
+// Check if the map is empty
+template <typename TKey, typename TValue, typename Compare>
+bool MappedTreeMap<TKey, TValue, Compare>::is_empty() const {
+    return _run.empty();
+}
+
+// Check if a key is in the map
+template <typename TKey, typename TValue, typename Compare>
+bool MappedTreeMap<TKey, TValue, Compare>::contains(const TKey &key) const {
+    const_iterator it = lower_bound(key);
+    return it != end() && _comparator(key, it->first) == 0;
+}
+
+// Get key value
+template <typename TKey, typename TValue, typename Compare>
+std::optional<TValue> MappedTreeMap<TKey, TValue, Compare>::get(const TKey &key) const {
+    const_iterator it = lower_bound(key);
+    if (it == end() || _comparator(key, it->first) != 0) return std::nullopt;
+    return it->second;
+}
+
+// First entry with key not less than key
+template <typename TKey, typename TValue, typename Compare>
+typename MappedTreeMap<TKey, TValue, Compare>::const_iterator MappedTreeMap<TKey, TValue, Compare>::lower_bound(const TKey &key) const {
+    return std::lower_bound(begin(), end(), key, [this](const SortedRunEntry<TKey, TValue> &entry, const TKey &k) {
+        return _comparator(k, entry.first) > 0;
+    });
+}
+
+// First entry with key greater than key
+template <typename TKey, typename TValue, typename Compare>
+typename MappedTreeMap<TKey, TValue, Compare>::const_iterator MappedTreeMap<TKey, TValue, Compare>::upper_bound(const TKey &key) const {
+    return std::upper_bound(begin(), end(), key, [this](const TKey &k, const SortedRunEntry<TKey, TValue> &entry) {
+        return _comparator(k, entry.first) < 0;
+    });
+}
+
+// Pointer to the entry with the smallest key
+template <typename TKey, typename TValue, typename Compare>
+typename MappedTreeMap<TKey, TValue, Compare>::const_iterator MappedTreeMap<TKey, TValue, Compare>::begin() const {
+    return _run.begin();
+}
+
+// Pointer past the entry with the largest key
+template <typename TKey, typename TValue, typename Compare>
+typename MappedTreeMap<TKey, TValue, Compare>::const_iterator MappedTreeMap<TKey, TValue, Compare>::end() const {
+    return _run.end();
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef MAPPED_TREE_SET_HPP
+#define MAPPED_TREE_SET_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include "SortedRun.hpp"
+#include "TreeSet.hpp"
+
+/// @brief read-only ordered set served straight from a memory-mapped
+///        sorted-run file written by `TreeSet::save`
+/// Opening costs O(1) and no tree is built; lookups are binary searches over
+/// the mapped array and only touch the pages they read.
+/// @tparam T type of the elements; must be trivially copyable
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1;
+///         must order the file the same way as the set that saved it
+template <typename T, typename Compare = DefaultComparator<T>>
+class MappedTreeSet
+{
+private:
+    MappedSortedRun<T> _run;
+    Compare _comparator;
+
+public:
+    using const_iterator = const T *;
+    using iterator = const_iterator;
+
+    /// @brief map the file at `path`
+    /// @throw std::system_error or std::runtime_error, see `MappedSortedRun`
+    explicit MappedTreeSet(const std::string &path, Compare comparator = Compare());
+
+    /// @brief Returns the number of elements in the set.
+    size_t size() const;
+
+    /// @brief check if the set is empty
+    bool is_empty() const;
+
+    /// @brief check if an element equal to `key` is in the set
+    /// @param key a `T`, or any type the comparator can compare with `T`
+    template <typename K>
+    bool contains(const K &key) const;
+
+    /// @brief the element equal to `key`, or std::nullopt
+    template <typename K>
+    std::optional<T> get(const K &key) const;
+
+    /// @brief first element that is not less than `key`
+    template <typename K>
+    const_iterator lower_bound(const K &key) const;
+
+    /// @brief first element that is greater than `key`
+    template <typename K>
+    const_iterator upper_bound(const K &key) const;
+
+    /// @brief number of elements less than `key`, in O(log n)
+    template <typename K>
+    size_t rank(const K &key) const;
+
+    /// @brief a sorted vector containing all values in the set
+    std::vector<T> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+/// @brief read-only map served straight from a memory-mapped sorted-run file
+///        written by `TreeMap::save`, see `MappedTreeSet`
+template <typename TKey, typename TValue, typename Compare = DefaultComparator<TKey>>
+class MappedTreeMap
+{
+private:
+    MappedSortedRun<SortedRunEntry<TKey, TValue>> _run;
+    Compare _comparator;
+
+public:
+    using const_iterator = const SortedRunEntry<TKey, TValue> *;
+    using iterator = const_iterator;
+
+    /// @brief map the file at `path`
+    /// @throw std::system_error or std::runtime_error, see `MappedSortedRun`
+    explicit MappedTreeMap(const std::string &path, Compare comparator = Compare());
+
+    /// @brief Returns the number of entries in the map.
+    size_t size() const;
+
+    /// @brief check if the map is empty
+    bool is_empty() const;
+
+    /// @brief check if a key is in the map
+    bool contains(const TKey &key) const;
+
+    /// @brief get the value of a key, or std::nullopt
+    std::optional<TValue> get(const TKey &key) const;
+
+    /// @brief first entry whose key is not less than `key`
+    const_iterator lower_bound(const TKey &key) const;
+
+    /// @brief first entry whose key is greater than `key`
+    const_iterator upper_bound(const TKey &key) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/// @brief process-wide storage that lets nodes refer to each other by 32-bit
+///        index instead of by pointer
+/// Memory comes in 1 MiB chunks aligned to their size. The first page of
+/// each chunk holds its header, whose first field is the chunk's id, so a
+/// node's index is found from its address alone: `id << 16 | slot`. Index 0
+/// is null. Chunks are cut into pages of about 4 KiB, and each tree takes
+/// pages through its own `ArenaPool`, so a small tree costs one page and
+/// only acquiring and releasing pages takes a lock.
+template <typename Node>
+class NodeArena
+{
+public:
+    union Slot {
+        Slot *next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    static constexpr size_t CHUNK_BYTES = size_t(1) << 20;
+    static constexpr unsigned OFFSET_BITS = 16;
+    static constexpr size_t SLOTS_PER_CHUNK =
+        CHUNK_BYTES / sizeof(Slot) < (size_t(1) << OFFSET_BITS) ? CHUNK_BYTES / sizeof(Slot) : size_t(1) << OFFSET_BITS;
+    static constexpr size_t PAGE_BYTES = 4096;
+    /// @brief slots in one page, the unit handed to a pool
+    static constexpr size_t PAGE_SLOTS = PAGE_BYTES / sizeof(Slot) > 0 ? PAGE_BYTES / sizeof(Slot) : 1;
+    static constexpr size_t PAGES_PER_CHUNK = SLOTS_PER_CHUNK / PAGE_SLOTS;
+    /// @brief storage a page accounts for: its share of the chunk, counting
+    ///        the header page and the slack at the end
+    static constexpr size_t BYTES_PER_PAGE = CHUNK_BYTES / (PAGES_PER_CHUNK - 1);
+    /// @brief the top bit of an index is left free for callers to tag
+    static constexpr uint32_t MAX_CHUNKS = uint32_t(1) << (31 - OFFSET_BITS);
+
+    static_assert(PAGES_PER_CHUNK >= 2, "node too large for an arena chunk");
+
+private:
+    struct ChunkHeader {
+        uint32_t id; // first, so `index_of` finds it at the chunk's base
+        uint32_t used_pages;
+        uint32_t fresh_page;    // next never-used page
+        uint32_t open_position; // index in `_open`, or `CLOSED`
+        Slot *free_pages;       // pages given back, linked through their first slot
+    };
+
+    static_assert(sizeof(ChunkHeader) <= PAGE_SLOTS * sizeof(Slot), "chunk header does not fit in a page");
+    static constexpr uint32_t CLOSED = ~uint32_t(0);
+
+    static inline uintptr_t _bases[MAX_CHUNKS] = {}; // `_bases[0]` stays 0, so index 0 maps to null
+    static inline std::vector<uint32_t> _free_ids;
+    static inline uint32_t _next_id = 1;
+    static inline std::vector<ChunkHeader *> _open; // chunks with a page to give
+    static inline size_t _chunk_count = 0;
+    static inline size_t _empty_chunks = 0; // one is kept so a tree coming and going does not map a chunk each time
+    static inline std::mutex _mutex;
+
+    static ChunkHeader *header_of(const void *address) {
+        return reinterpret_cast<ChunkHeader *>(reinterpret_cast<uintptr_t>(address) & ~(CHUNK_BYTES - 1));
+    }
+
+    static void open(ChunkHeader *chunk) {
+        chunk->open_position = static_cast<uint32_t>(_open.size());
+        _open.push_back(chunk);
+    }
+
+    static void close(ChunkHeader *chunk) {
+        ChunkHeader *last = _open.back();
+        _open[chunk->open_position] = last;
+        last->open_position = chunk->open_position;
+        _open.pop_back();
+        chunk->open_position = CLOSED;
+    }
+
+    // map a new chunk and open it; the lock is held
+    static void add_chunk() {
+        uint32_t id;
+        if (!_free_ids.empty()) {
+            id = _free_ids.back();
+        } else if (_next_id < MAX_CHUNKS) {
+            id = _next_id;
+        } else {
+            throw std::bad_alloc();
+        }
+        void *memory = ::operator new(CHUNK_BYTES, std::align_val_t(CHUNK_BYTES));
+        if (!_free_ids.empty()) {
+            _free_ids.pop_back();
+        } else {
+            _next_id++;
+        }
+        ChunkHeader *chunk = new (memory) ChunkHeader{id, 0, 1, CLOSED, nullptr};
+        _bases[id] = reinterpret_cast<uintptr_t>(memory);
+        open(chunk);
+        _chunk_count++;
+        _empty_chunks++;
+    }
+
+    // unmap a chunk with no pages in use; the lock is held
+    static void remove_chunk(ChunkHeader *chunk) {
+        if (chunk->open_position != CLOSED) {
+            close(chunk);
+        }
+        _bases[chunk->id] = 0;
+        _free_ids.push_back(chunk->id);
+        _chunk_count--;
+        ::operator delete(static_cast<void *>(chunk), std::align_val_t(CHUNK_BYTES));
+    }
+
+public:
+    /// @brief the node at `index`, or nullptr for index 0
+    static Node *pointer(uint32_t index) {
+        uintptr_t base = _bases[index >> OFFSET_BITS];
+        return reinterpret_cast<Node *>(base + (index & ((uint32_t(1) << OFFSET_BITS) - 1)) * sizeof(Slot));
+    }
+
+    /// @brief index of a node living in the arena, or 0 for nullptr
+    static uint32_t index_of(const Node *node) {
+        if (!node) return 0;
+        uintptr_t address = reinterpret_cast<uintptr_t>(node);
+        uintptr_t base = address & ~(CHUNK_BYTES - 1);
+        uint32_t id = *reinterpret_cast<const uint32_t *>(base);
+        return (id << OFFSET_BITS) | static_cast<uint32_t>((address - base) / sizeof(Slot));
+    }
+
+    /// @brief take a page, from a chunk that has one free if there is any
+    /// @return the first of the page's `PAGE_SLOTS` slots
+    /// @throw std::bad_alloc once `MAX_CHUNKS` chunks are mapped
+    static Slot *acquire_page() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_open.empty()) {
+            add_chunk();
+        }
+        ChunkHeader *chunk = _open.back();
+        Slot *page;
+        if (chunk->free_pages) {
+            page = chunk->free_pages;
+            chunk->free_pages = page->next;
+        } else {
+            page = reinterpret_cast<Slot *>(chunk) + chunk->fresh_page++ * PAGE_SLOTS;
+        }
+        if (chunk->used_pages++ == 0) {
+            _empty_chunks--;
+        }
+        if (!chunk->free_pages && chunk->fresh_page == PAGES_PER_CHUNK) {
+            close(chunk);
+        }
+        return page;
+    }
+
+    /// @brief give pages from `acquire_page` back; their nodes must be destroyed
+    /// Chunks left with no page in use are unmapped, but for one kept spare.
+    static void release_pages(const std::vector<Slot *> &pages) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Slot *page : pages) {
+            ChunkHeader *chunk = header_of(page);
+            page->next = chunk->free_pages;
+            chunk->free_pages = page;
+            if (chunk->open_position == CLOSED) {
+                open(chunk);
+            }
+            if (--chunk->used_pages == 0) {
+                if (_empty_chunks > 0) {
+                    remove_chunk(chunk);
+                } else {
+                    _empty_chunks++;
+                }
+            }
+        }
+    }
+
+    /// @brief number of chunks currently mapped
+    static size_t chunk_count() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _chunk_count;
+    }
+};
+
+/// @brief per-tree node allocator over `NodeArena`, with the same interface
+///        as `NodePool`
+template <typename Node>
+class ArenaPool
+{
+private:
+    using Arena = NodeArena<Node>;
+    using Slot = typename Arena::Slot;
+
+    std::vector<Slot *> _pages;
+    Slot *_free_list = nullptr;
+    Slot *_free_tail = nullptr; // last slot of the free list, for `absorb`
+    Slot *_cursor = nullptr;    // next never-used slot in the newest page
+    Slot *_page_end = nullptr;  // one past the last slot of the newest page
+    size_t _live = 0;
+    size_t _page_allocations = 0;
+    size_t _node_allocations = 0;
+
+    void push_free(Slot *slot) {
+        if (!_free_list) {
+            _free_tail = slot;
+        }
+        slot->next = _free_list;
+        _free_list = slot;
+    }
+
+    void add_page() {
+        // hand the unused tail of the current page to the free list
+        for (; _cursor != _page_end; ++_cursor) {
+            push_free(_cursor);
+        }
+        Slot *page = Arena::acquire_page();
+        _pages.push_back(page);
+        _cursor = page;
+        _page_end = page + Arena::PAGE_SLOTS;
+        _page_allocations++;
+    }
+
+public:
+    /// @brief storage for a run of nodes from `allocate_block`
+    class Block
+    {
+    private:
+        friend class ArenaPool;
+        Slot *_first = nullptr;      // the rest of the page that was current
+        size_t _first_count = 0;
+        std::vector<Slot *> _pages; // whole pages after it
+
+    public:
+        /// @brief storage of the i-th node of the block
+        void *slot(size_t i) const {
+            if (i < _first_count) return _first + i;
+            i -= _first_count;
+            return _pages[i / Arena::PAGE_SLOTS] + i % Arena::PAGE_SLOTS;
+        }
+    };
+
+    ArenaPool() = default;
+    ArenaPool(const ArenaPool &) = delete;
+    ArenaPool &operator=(const ArenaPool &) = delete;
+
+    ArenaPool(ArenaPool &&other) noexcept { swap(other); }
+
+    ArenaPool &operator=(ArenaPool &&other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~ArenaPool() { release(); }
+
+    void swap(ArenaPool &other) noexcept {
+        std::swap(_pages, other._pages);
+        std::swap(_free_list, other._free_list);
+        std::swap(_free_tail, other._free_tail);
+        std::swap(_cursor, other._cursor);
+        std::swap(_page_end, other._page_end);
+        std::swap(_live, other._live);
+        std::swap(_page_allocations, other._page_allocations);
+        std::swap(_node_allocations, other._node_allocations);
+    }
+
+    /// @brief get storage for one node
+    void *allocate() {
+        Slot *slot;
+        if (_free_list) {
+            slot = _free_list;
+            _free_list = slot->next;
+        } else {
+            if (_cursor == _page_end) {
+                add_page();
+            }
+            slot = _cursor++;
+        }
+        _live++;
+        _node_allocations++;
+        return slot->storage;
+    }
+
+    /// @brief return the storage of a node (already destroyed) for reuse
+    void deallocate(void *p) {
+        push_free(reinterpret_cast<Slot *>(p));
+        _live--;
+    }
+
+    /// @brief pages are a fixed size, so there is nothing to prepare
+    void reserve(size_t) {}
+
+    /// @brief get storage for `n` nodes at once: the rest of the current
+    ///        page, then fresh pages in order
+    Block allocate_block(size_t n) {
+        Block block;
+        block._first = _cursor;
+        block._first_count = std::min(n, static_cast<size_t>(_page_end - _cursor));
+        _cursor += block._first_count;
+        size_t left = n - block._first_count;
+        block._pages.reserve((left + Arena::PAGE_SLOTS - 1) / Arena::PAGE_SLOTS);
+        while (left > 0) {
+            add_page();
+            size_t take = std::min(left, Arena::PAGE_SLOTS);
+            block._pages.push_back(_cursor);
+            _cursor += take;
+            left -= take;
+        }
+        _live += n;
+        _node_allocations += n;
+        return block;
+    }
+
+    /// @brief take over every page of `other`, leaving it empty, see
+    ///        `NodePool::absorb`
+    void absorb(ArenaPool &&other) {
+        if (this == &other) return;
+        for (; other._cursor != other._page_end; ++other._cursor) {
+            other.push_free(other._cursor);
+        }
+        if (other._free_list) {
+            other._free_tail->next = _free_list;
+            if (!_free_list) {
+                _free_tail = other._free_tail;
+            }
+            _free_list = other._free_list;
+        }
+        _pages.insert(_pages.end(), other._pages.begin(), other._pages.end());
+        _live += other._live;
+        _page_allocations += other._page_allocations;
+        _node_allocations += other._node_allocations;
+        other._pages.clear();
+        other.release();
+        other._page_allocations = 0;
+        other._node_allocations = 0;
+    }
+
+    /// @brief give every page back to the arena
+    /// @note nodes still living in the pool are not destroyed
+    void release() {
+        if (!_pages.empty()) {
+            Arena::release_pages(_pages);
+        }
+        _pages.clear();
+        _free_list = nullptr;
+        _free_tail = nullptr;
+        _cursor = nullptr;
+        _page_end = nullptr;
+        _live = 0;
+    }
+
+    /// @brief number of nodes currently handed out
+    size_t live() const { return _live; }
+
+    /// @brief number of node slots owned by the pool
+    size_t capacity() const { return _pages.size() * Arena::PAGE_SLOTS; }
+
+    /// @brief arena storage held by the pool, used or not, with each page's
+    ///        share of its chunk
+    size_t bytes() const { return _pages.size() * Arena::BYTES_PER_PAGE; }
+
+    /// @brief number of pages taken from the arena
+    size_t chunk_allocations() const { return _page_allocations; }
+
+    /// @brief number of nodes ever handed out by `allocate()`
+    size_t node_allocations() const { return _node_allocations; }
+
+    /// @brief bytes of arena storage taken by a single node
+    static constexpr size_t bytes_per_node() { return sizeof(Slot); }
+};
+
+#endif
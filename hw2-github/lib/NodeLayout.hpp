@@ -0,0 +1,144 @@
+#ifndef NODE_LAYOUT_HPP
+#define NODE_LAYOUT_HPP
+
+#include <cstdint>
+#include "NodeArena.hpp"
+#include "NodePool.hpp"
+
+enum Color { Red, Black };
+
+// Layout policies decide how a tree node stores its links and its color.
+// A policy provides
+//   - `links<Node>`, a base of every node with `_left`, `_right` and
+//     `_parent` members that read and assign like `Node *`, plus `color()`
+//     and `set_color(c)`,
+//   - `pool<Node>`, the allocator the tree takes its nodes from.
+// `_parent` always assigns only the link, never the color stored beside it.
+
+/// @brief parent link that keeps the node color in the low pointer bit
+template <typename Node>
+class ColorTaggedPointer
+{
+private:
+    uintptr_t _bits = 0;
+
+public:
+    ColorTaggedPointer() = default;
+    ColorTaggedPointer(const ColorTaggedPointer &) = default;
+
+    operator Node *() const { return reinterpret_cast<Node *>(_bits & ~uintptr_t(1)); }
+    Node *operator->() const { return *this; }
+
+    ColorTaggedPointer &operator=(Node *node) {
+        _bits = reinterpret_cast<uintptr_t>(node) | (_bits & 1);
+        return *this;
+    }
+    ColorTaggedPointer &operator=(const ColorTaggedPointer &other) { return *this = static_cast<Node *>(other); }
+
+    Color color() const { return (_bits & 1) ? Black : Red; }
+    void set_color(Color color) { _bits = (_bits & ~uintptr_t(1)) | (color == Black ? 1 : 0); }
+};
+
+/// @brief 32-bit link to a node in `NodeArena<Node>`
+template <typename Node>
+class ArenaLink
+{
+private:
+    uint32_t _index = 0;
+
+public:
+    ArenaLink() = default;
+    ArenaLink(const ArenaLink &) = default;
+    ArenaLink &operator=(const ArenaLink &) = default;
+
+    operator Node *() const { return NodeArena<Node>::pointer(_index); }
+    Node *operator->() const { return *this; }
+
+    ArenaLink &operator=(Node *node) {
+        _index = NodeArena<Node>::index_of(node);
+        return *this;
+    }
+};
+
+/// @brief 32-bit parent link to a node in `NodeArena<Node>`, with the node
+///        color in the top bit
+template <typename Node>
+class ColorTaggedArenaLink
+{
+private:
+    static constexpr uint32_t COLOR_BIT = uint32_t(1) << 31;
+    uint32_t _bits = 0;
+
+public:
+    ColorTaggedArenaLink() = default;
+    ColorTaggedArenaLink(const ColorTaggedArenaLink &) = default;
+
+    operator Node *() const { return NodeArena<Node>::pointer(_bits & ~COLOR_BIT); }
+    Node *operator->() const { return *this; }
+
+    ColorTaggedArenaLink &operator=(Node *node) {
+        _bits = NodeArena<Node>::index_of(node) | (_bits & COLOR_BIT);
+        return *this;
+    }
+    ColorTaggedArenaLink &operator=(const ColorTaggedArenaLink &other) { return *this = static_cast<Node *>(other); }
+
+    Color color() const { return (_bits & COLOR_BIT) ? Black : Red; }
+    void set_color(Color color) { _bits = (_bits & ~COLOR_BIT) | (color == Black ? COLOR_BIT : 0); }
+};
+
+/// @brief three pointers and a separate color field (the default)
+struct WideNode
+{
+    template <typename Node>
+    struct links {
+        Node *_left = nullptr;
+        Node *_right = nullptr;
+        Node *_parent = nullptr;
+        Color _color = Red;
+
+        Color color() const { return _color; }
+        void set_color(Color color) { _color = color; }
+    };
+
+    template <typename Node>
+    using pool = NodePool<Node>;
+};
+
+/// @brief three pointers, with the color in the low bit of the parent pointer
+struct PackedColorNode
+{
+    template <typename Node>
+    struct links {
+        Node *_left = nullptr;
+        Node *_right = nullptr;
+        ColorTaggedPointer<Node> _parent;
+
+        Color color() const { return _parent.color(); }
+        void set_color(Color color) { _parent.set_color(color); }
+    };
+
+    template <typename Node>
+    using pool = NodePool<Node>;
+};
+
+/// @brief three 32-bit arena indices, with the color in the top bit of the
+///        parent index: 12 bytes of links per node instead of 32
+/// @note every tree with this layout shares one arena per node type, which
+///       caps them at about 2^31 nodes in total
+struct CompactNode
+{
+    template <typename Node>
+    struct links {
+        ArenaLink<Node> _left;
+        ArenaLink<Node> _right;
+        ColorTaggedArenaLink<Node> _parent;
+
+        Color color() const { return _parent.color(); }
+        void set_color(Color color) { _parent.set_color(color); }
+    };
+
+    template <typename Node>
+    using pool = ArenaPool<Node>;
+};
+
+#endif
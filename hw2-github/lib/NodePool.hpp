@@ -0,0 +1,215 @@
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// @brief Slab allocator that hands out storage for tree nodes.
+/// Slots are carved from contiguous chunks that grow geometrically, freed
+/// slots are kept on an intrusive free list and reused first, and every chunk
+/// is returned to the system at once by `release()`.
+/// @note the pool only manages raw storage; constructing and destroying the
+///       node living in a slot is up to the caller.
+template <typename Node>
+class NodePool
+{
+private:
+    union Slot {
+        Slot *next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    struct Chunk {
+        Slot *slots;
+        size_t capacity;
+    };
+
+    static constexpr size_t MIN_CHUNK_CAPACITY = 64;
+    static constexpr size_t MAX_CHUNK_CAPACITY = 64 * 1024;
+
+    std::vector<Chunk> _chunks;
+    Slot *_free_list = nullptr;
+    Slot *_free_tail = nullptr; // last slot of the free list, for `absorb`
+    Slot *_cursor = nullptr;    // next never-used slot in the newest chunk
+    Slot *_chunk_end = nullptr; // one past the last slot of the newest chunk
+    size_t _next_capacity = MIN_CHUNK_CAPACITY;
+    size_t _live = 0;
+    size_t _chunk_allocations = 0;
+    size_t _node_allocations = 0;
+
+    void push_free(Slot *slot) {
+        if (!_free_list) {
+            _free_tail = slot;
+        }
+        slot->next = _free_list;
+        _free_list = slot;
+    }
+
+    void add_chunk(size_t capacity) {
+        // hand the unused tail of the current chunk to the free list
+        for (; _cursor != _chunk_end; ++_cursor) {
+            push_free(_cursor);
+        }
+        Slot *slots = new Slot[capacity];
+        _chunks.push_back({slots, capacity});
+        _cursor = slots;
+        _chunk_end = slots + capacity;
+        _chunk_allocations++;
+        _next_capacity = std::min(_next_capacity * 2, MAX_CHUNK_CAPACITY);
+    }
+
+public:
+    NodePool() = default;
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    NodePool(NodePool &&other) noexcept { swap(other); }
+
+    NodePool &operator=(NodePool &&other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~NodePool() { release(); }
+
+    void swap(NodePool &other) noexcept {
+        std::swap(_chunks, other._chunks);
+        std::swap(_free_list, other._free_list);
+        std::swap(_free_tail, other._free_tail);
+        std::swap(_cursor, other._cursor);
+        std::swap(_chunk_end, other._chunk_end);
+        std::swap(_next_capacity, other._next_capacity);
+        std::swap(_live, other._live);
+        std::swap(_chunk_allocations, other._chunk_allocations);
+        std::swap(_node_allocations, other._node_allocations);
+    }
+
+    /// @brief get storage for one node
+    /// @return uninitialized storage large and aligned enough for a `Node`
+    void *allocate() {
+        Slot *slot;
+        if (_free_list) {
+            slot = _free_list;
+            _free_list = slot->next;
+        } else {
+            if (_cursor == _chunk_end) {
+                add_chunk(_next_capacity);
+            }
+            slot = _cursor++;
+        }
+        _live++;
+        _node_allocations++;
+        return slot->storage;
+    }
+
+    /// @brief return the storage of a node (already destroyed) for reuse
+    /// @param p pointer previously returned by `allocate()`
+    void deallocate(void *p) {
+        push_free(reinterpret_cast<Slot *>(p));
+        _live--;
+    }
+
+    /// @brief make sure the next `n` allocations come from one contiguous chunk
+    /// @param n number of nodes about to be allocated
+    void reserve(size_t n) {
+        if (static_cast<size_t>(_chunk_end - _cursor) < n) {
+            add_chunk(std::max(n, _next_capacity));
+        }
+    }
+
+    /// @brief storage for a run of nodes from `allocate_block`
+    class Block
+    {
+    private:
+        friend class NodePool;
+        Slot *_first = nullptr;
+
+    public:
+        /// @brief storage of the i-th node of the block
+        void *slot(size_t i) const { return _first + i; }
+    };
+
+    /// @brief get contiguous storage for `n` nodes at once
+    /// @return the block; each slot can later be returned on its own with `deallocate`
+    Block allocate_block(size_t n) {
+        reserve(n);
+        Block block;
+        block._first = _cursor;
+        _cursor += n;
+        _live += n;
+        _node_allocations += n;
+        return block;
+    }
+
+    /// @brief take over every chunk of `other`, leaving it empty
+    /// Nodes living in `other` stay where they are and now belong to this
+    /// pool, so they can be linked into this pool's tree. Costs O(chunks), plus
+    /// one step per never-used slot left in `other`'s newest chunk.
+    void absorb(NodePool &&other) {
+        if (this == &other) return;
+        for (; other._cursor != other._chunk_end; ++other._cursor) {
+            other.push_free(other._cursor);
+        }
+        if (other._free_list) {
+            other._free_tail->next = _free_list;
+            if (!_free_list) {
+                _free_tail = other._free_tail;
+            }
+            _free_list = other._free_list;
+        }
+        _chunks.insert(_chunks.end(), other._chunks.begin(), other._chunks.end());
+        _live += other._live;
+        _chunk_allocations += other._chunk_allocations;
+        _node_allocations += other._node_allocations;
+        other._chunks.clear();
+        other.release();
+        other._chunk_allocations = 0;
+        other._node_allocations = 0;
+    }
+
+    /// @brief give every chunk back to the system in O(chunks)
+    /// @note nodes still living in the pool are not destroyed
+    void release() {
+        for (const Chunk &chunk : _chunks) {
+            delete[] chunk.slots;
+        }
+        _chunks.clear();
+        _free_list = nullptr;
+        _free_tail = nullptr;
+        _cursor = nullptr;
+        _chunk_end = nullptr;
+        _next_capacity = MIN_CHUNK_CAPACITY;
+        _live = 0;
+    }
+
+    /// @brief number of nodes currently handed out
+    size_t live() const { return _live; }
+
+    /// @brief number of node slots owned by the pool
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Chunk &chunk : _chunks) {
+            total += chunk.capacity;
+        }
+        return total;
+    }
+
+    /// @brief bytes of storage held by the pool, used or not
+    size_t bytes() const { return capacity() * sizeof(Slot); }
+
+    /// @brief number of times the pool went to the system allocator
+    size_t chunk_allocations() const { return _chunk_allocations; }
+
+    /// @brief number of nodes ever handed out by `allocate()`
+    size_t node_allocations() const { return _node_allocations; }
+
+    /// @brief bytes of pool storage taken by a single node
+    static constexpr size_t bytes_per_node() { return sizeof(Slot); }
+};
+
+#endif
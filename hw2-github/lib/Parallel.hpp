@@ -0,0 +1,53 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+/// @brief run `fn(0)`, ..., `fn(tasks - 1)` concurrently, one thread per task
+/// Task 0 runs on the calling thread; returns once every task has finished.
+/// @note an exception escaping a task on another thread ends the program
+template <typename F>
+void parallel_for(size_t tasks, F &&fn)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < tasks; ++i) {
+        threads.emplace_back([&fn, i] { fn(i); });
+    }
+    if (tasks > 0) {
+        fn(0);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+/// @brief stable sort of `[first, last)` on up to `threads` threads
+/// Sorts `threads` slices concurrently, then merges neighbouring runs in
+/// rounds, each round's merges running concurrently.
+template <typename It, typename Less>
+void parallel_stable_sort(It first, It last, Less less, unsigned threads)
+{
+    size_t n = std::distance(first, last);
+    size_t runs = std::max(1u, std::min<unsigned>(threads, n));
+    std::vector<It> bounds;
+    for (size_t i = 0; i <= runs; ++i) {
+        bounds.push_back(first + n * i / runs);
+    }
+    parallel_for(runs, [&](size_t i) { std::stable_sort(bounds[i], bounds[i + 1], less); });
+
+    for (size_t width = 1; width < runs; width *= 2) {
+        size_t merges = (runs + 2 * width - 1) / (2 * width);
+        parallel_for(merges, [&](size_t m) {
+            size_t lo = 2 * width * m;
+            size_t mid = std::min(lo + width, runs);
+            size_t hi = std::min(lo + 2 * width, runs);
+            std::inplace_merge(bounds[lo], bounds[mid], bounds[hi], less);
+        });
+    }
+}
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef PERSISTENT_TREE_SET_CPP
+#define PERSISTENT_TREE_SET_CPP
+
+#include <algorithm>
+#include <cassert>
+#include "PersistentTreeSet.hpp"
+
+// Constructor
+template <typename T, typename Compare>
+PersistentTreeSet<T, Compare>::PersistentTreeSet() : PersistentTreeSet(Compare()) {}
+
+// Constructor - initial items
+template <typename T, typename Compare>
+PersistentTreeSet<T, Compare>::PersistentTreeSet(const std::vector<T> &items) : PersistentTreeSet(items, Compare()) {}
+
+// Constructor - comparator
+template <typename T, typename Compare>
+PersistentTreeSet<T, Compare>::PersistentTreeSet(Compare comparator)
+    : _current(new Version{nullptr, 0}), _comparator(std::move(comparator)) {
+    EpochReclaimer::instance(); // made first, so it outlives sets with static storage
+}
+
+// Constructor - sorts the items once and builds the tree bottom-up
+template <typename T, typename Compare>
+PersistentTreeSet<T, Compare>::PersistentTreeSet(const std::vector<T> &items, Compare comparator)
+    : PersistentTreeSet(std::move(comparator)) {
+    std::vector<T> sorted(items);
+    std::stable_sort(sorted.begin(), sorted.end(), [this](const T &a, const T &b) { return _comparator(a, b) < 0; });
+    // keep the last of each run of equal items, as repeated `add`s would
+    size_t n = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (n > 0 && _comparator(sorted[n - 1], sorted[i]) == 0) {
+            sorted[n - 1] = std::move(sorted[i]);
+        } else {
+            if (n != i) sorted[n] = std::move(sorted[i]);
+            n++;
+        }
+    }
+    sorted.resize(n);
+
+    // every path is max_depth or max_depth + 1 nodes long; coloring the
+    // deepest level red evens out the black heights, as in TreeSet::build
+    int max_depth = 0;
+    while ((size_t(2) << max_depth) - 1 < n) {
+        max_depth++;
+    }
+    bool perfect = (size_t(2) << max_depth) - 1 == n;
+    publish(build(sorted, 0, n, 0, perfect ? -1 : max_depth), n);
+}
+
+// Destructor - the last version may still be pinned by a snapshot
+template <typename T, typename Compare>
+PersistentTreeSet<T, Compare>::~PersistentTreeSet() {
+    EpochReclaimer::instance().retire(const_cast<Version *>(_current.load()), &destroy_version);
+}
+
+// Frees a version; the callback handed to the reclaimer
+template <typename T, typename Compare>
+void PersistentTreeSet<T, Compare>::destroy_version(void *version) {
+    delete static_cast<Version *>(version);
+}
+
+// Middle element on top, recursively
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::build(const std::vector<T> &values, size_t lo, size_t hi, int depth, int red_depth) {
+    if (lo >= hi) return nullptr;
+    size_t mid = lo + (hi - lo) / 2;
+    return make_node(depth == red_depth ? Red : Black, build(values, lo, mid, depth + 1, red_depth), values[mid],
+                     build(values, mid + 1, hi, depth + 1, red_depth));
+}
+
+// Plain binary search over raw node pointers
+template <typename T, typename Compare>
+template <typename K>
+const typename PersistentTreeSet<T, Compare>::Node *
+PersistentTreeSet<T, Compare>::find(const Node *node, const K &key, const Compare &comparator) {
+    while (node) {
+        int cmp = comparator(key, node->value);
+        if (cmp == 0) return node;
+        node = (cmp < 0) ? node->_left.get() : node->_right.get();
+    }
+    return nullptr;
+}
+
+// Allocates an immutable node
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::make_node(Color color, const NodePtr &left, const T &value, const NodePtr &right) {
+    return std::make_shared<const Node>(color, left, value, right);
+}
+
+// Null children count as black
+template <typename T, typename Compare>
+bool PersistentTreeSet<T, Compare>::is_red(const NodePtr &node) {
+    return node && node->_color == Red;
+}
+
+// A real black node, not a null child
+template <typename T, typename Compare>
+bool PersistentTreeSet<T, Compare>::is_black(const NodePtr &node) {
+    return node && node->_color == Black;
+}
+
+// Copy of node colored black
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr PersistentTreeSet<T, Compare>::make_black(const NodePtr &node) {
+    if (!is_red(node)) return node;
+    return make_node(Black, node->_left, node->value, node->_right);
+}
+
+// Black node over left and right, rotating away a red-red pair below it
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::balance(const NodePtr &left, const T &value, const NodePtr &right) {
+    if (is_red(left) && is_red(right)) {
+        return make_node(Red, make_black(left), value, make_black(right));
+    }
+    if (is_red(left)) {
+        if (is_red(left->_left)) {
+            return make_node(Red, make_black(left->_left), left->value,
+                             make_node(Black, left->_right, value, right));
+        }
+        if (is_red(left->_right)) {
+            const NodePtr &mid = left->_right;
+            return make_node(Red, make_node(Black, left->_left, left->value, mid->_left), mid->value,
+                             make_node(Black, mid->_right, value, right));
+        }
+    }
+    if (is_red(right)) {
+        if (is_red(right->_right)) {
+            return make_node(Red, make_node(Black, left, value, right->_left), right->value,
+                             make_black(right->_right));
+        }
+        if (is_red(right->_left)) {
+            const NodePtr &mid = right->_left;
+            return make_node(Red, make_node(Black, left, value, mid->_left), mid->value,
+                             make_node(Black, mid->_right, right->value, right->_right));
+        }
+    }
+    return make_node(Black, left, value, right);
+}
+
+// Restores black height when left is one black level short
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::balance_left(const NodePtr &left, const T &value, const NodePtr &right) {
+    if (is_red(left)) {
+        return make_node(Red, make_black(left), value, right);
+    }
+    if (is_black(right)) {
+        return balance(left, value, make_node(Red, right->_left, right->value, right->_right));
+    }
+    assert(is_red(right) && is_black(right->_left));
+    const NodePtr &mid = right->_left;
+    const NodePtr &far = right->_right;
+    return make_node(Red, make_node(Black, left, value, mid->_left), mid->value,
+                     balance(mid->_right, right->value, make_node(Red, far->_left, far->value, far->_right)));
+}
+
+// Restores black height when right is one black level short
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::balance_right(const NodePtr &left, const T &value, const NodePtr &right) {
+    if (is_red(right)) {
+        return make_node(Red, left, value, make_black(right));
+    }
+    if (is_black(left)) {
+        return balance(make_node(Red, left->_left, left->value, left->_right), value, right);
+    }
+    assert(is_red(left) && is_black(left->_right));
+    const NodePtr &mid = left->_right;
+    const NodePtr &far = left->_left;
+    return make_node(Red, balance(make_node(Red, far->_left, far->value, far->_right), left->value, mid->_left),
+                     mid->value, make_node(Black, mid->_right, value, right));
+}
+
+// Joins the two children of a deleted node
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr PersistentTreeSet<T, Compare>::append(const NodePtr &left, const NodePtr &right) {
+    if (!left) return right;
+    if (!right) return left;
+    if (is_red(left) && is_red(right)) {
+        NodePtr mid = append(left->_right, right->_left);
+        if (is_red(mid)) {
+            return make_node(Red, make_node(Red, left->_left, left->value, mid->_left), mid->value,
+                             make_node(Red, mid->_right, right->value, right->_right));
+        }
+        return make_node(Red, left->_left, left->value, make_node(Red, mid, right->value, right->_right));
+    }
+    if (is_black(left) && is_black(right)) {
+        NodePtr mid = append(left->_right, right->_left);
+        if (is_red(mid)) {
+            return make_node(Red, make_node(Black, left->_left, left->value, mid->_left), mid->value,
+                             make_node(Black, mid->_right, right->value, right->_right));
+        }
+        return balance_left(left->_left, left->value, make_node(Black, mid, right->value, right->_right));
+    }
+    if (is_red(right)) {
+        return make_node(Red, append(left, right->_left), right->value, right->_right);
+    }
+    return make_node(Red, left->_left, left->value, append(left->_right, right));
+}
+
+// Copies the search path, adding value at the bottom
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::NodePtr
+PersistentTreeSet<T, Compare>::insert(const NodePtr &node, const T &value, bool &inserted) const {
+    if (!node) {
+        return make_node(Red, nullptr, value, nullptr);
+    }
+    int cmp = _comparator(value, node->value);
+    if (cmp == 0) {
+        inserted = false;
+        return make_node(node->_color, node->_left, value, node->_right);
+    }
+    if (node->_color == Black) {
+        return cmp < 0 ? balance(insert(node->_left, value, inserted), node->value, node->_right)
+                       : balance(node->_left, node->value, insert(node->_right, value, inserted));
+    }
+    return cmp < 0 ? make_node(Red, insert(node->_left, value, inserted), node->value, node->_right)
+                   : make_node(Red, node->_left, node->value, insert(node->_right, value, inserted));
+}
+
+// Copies the search path, dropping the node equal to key
+template <typename T, typename Compare>
+template <typename K>
+typename PersistentTreeSet<T, Compare>::NodePtr PersistentTreeSet<T, Compare>::erase(const NodePtr &node, const K &key) const {
+    if (!node) return nullptr;
+    int cmp = _comparator(key, node->value);
+    if (cmp == 0) {
+        return append(node->_left, node->_right);
+    }
+    // removing below a black child shortens that side by one black level
+    if (cmp < 0) {
+        return is_black(node->_left) ? balance_left(erase(node->_left, key), node->value, node->_right)
+                                     : make_node(Red, erase(node->_left, key), node->value, node->_right);
+    }
+    return is_black(node->_right) ? balance_right(node->_left, node->value, erase(node->_right, key))
+                                  : make_node(Red, node->_left, node->value, erase(node->_right, key));
+}
+
+// Swaps in a new version for readers and retires the old one
+template <typename T, typename Compare>
+void PersistentTreeSet<T, Compare>::publish(NodePtr root, size_t size) {
+    EpochReclaimer::Guard guard;
+    const Version *old = _current.exchange(new Version{std::move(root), size}, std::memory_order_acq_rel);
+    EpochReclaimer::instance().retire(const_cast<Version *>(old), &destroy_version);
+}
+
+// Current version
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::Snapshot PersistentTreeSet<T, Compare>::snapshot() const {
+    return Snapshot(_current, _comparator);
+}
+
+// Number of elements in the current version
+template <typename T, typename Compare>
+size_t PersistentTreeSet<T, Compare>::size() const {
+    EpochReclaimer::Guard guard;
+    return _current.load(std::memory_order_acquire)->_size;
+}
+
+// Adds a value by publishing a copy of its search path
+template <typename T, typename Compare>
+void PersistentTreeSet<T, Compare>::add(const T &value) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    // only writers store `_current`, and they hold the lock
+    const Version *current = _current.load(std::memory_order_relaxed);
+    bool inserted = true;
+    NodePtr root = make_black(insert(current->_root, value, inserted));
+    publish(std::move(root), current->_size + (inserted ? 1 : 0));
+}
+
+// Removes key by publishing a copy of its search path
+template <typename T, typename Compare>
+template <typename K>
+bool PersistentTreeSet<T, Compare>::remove(const K &key) {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    // deletion assumes the key is present, otherwise black heights break
+    const Version *current = _current.load(std::memory_order_relaxed);
+    if (!find(current->_root.get(), key, _comparator)) return false;
+    NodePtr root = make_black(erase(current->_root, key));
+    publish(std::move(root), current->_size - 1);
+    return true;
+}
+
+// Check the current version for key
+template <typename T, typename Compare>
+template <typename K>
+bool PersistentTreeSet<T, Compare>::contains(const K &key) const {
+    EpochReclaimer::Guard guard;
+    return find(_current.load(std::memory_order_acquire)->_root.get(), key, _comparator) != nullptr;
+}
+
+// Publishes an empty version
+template <typename T, typename Compare>
+void PersistentTreeSet<T, Compare>::clear() {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    publish(nullptr, 0);
+}
+
+// Check the snapshot for key
+template <typename T, typename Compare>
+template <typename K>
+bool PersistentTreeSet<T, Compare>::Snapshot::contains(const K &key) const {
+    return find(_version->_root.get(), key, _comparator) != nullptr;
+}
+
+// Finds the element equal to key
+template <typename T, typename Compare>
+template <typename K>
+std::optional<T> PersistentTreeSet<T, Compare>::Snapshot::get(const K &key) const {
+    const Node *x = find(_version->_root.get(), key, _comparator);
+    if (!x) return std::nullopt;
+    return x->value;
+}
+
+// Smallest value
+template <typename T, typename Compare>
+std::optional<T> PersistentTreeSet<T, Compare>::Snapshot::min() const {
+    const Node *x = _version->_root.get();
+    if (!x) return std::nullopt;
+    while (x->_left) x = x->_left.get();
+    return x->value;
+}
+
+// Largest value
+template <typename T, typename Compare>
+std::optional<T> PersistentTreeSet<T, Compare>::Snapshot::max() const {
+    const Node *x = _version->_root.get();
+    if (!x) return std::nullopt;
+    while (x->_right) x = x->_right.get();
+    return x->value;
+}
+
+// Values in order
+template <typename T, typename Compare>
+std::vector<T> PersistentTreeSet<T, Compare>::Snapshot::to_vector() const {
+    std::vector<T> result;
+    result.reserve(size());
+    for (const T &value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Iterator to the smallest value
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::Snapshot::const_iterator PersistentTreeSet<T, Compare>::Snapshot::begin() const {
+    const_iterator it;
+    it.push_left(_version->_root.get());
+    return it;
+}
+
+// Iterator past the largest value
+template <typename T, typename Compare>
+typename PersistentTreeSet<T, Compare>::Snapshot::const_iterator PersistentTreeSet<T, Compare>::Snapshot::end() const {
+    return const_iterator();
+}
+
+// Black height of a subtree with keys in (lo, hi), or -1 if it is not valid
+template <typename T, typename Compare>
+int PersistentTreeSet<T, Compare>::Snapshot::check(const Node *node, const T *lo, const T *hi) const {
+    if (!node) return 0;
+    if ((lo && _comparator(*lo, node->value) >= 0) || (hi && _comparator(node->value, *hi) >= 0)) return -1;
+    if (node->_color == Red && (is_red(node->_left) || is_red(node->_right))) return -1;
+    int left = check(node->_left.get(), lo, &node->value);
+    int right = check(node->_right.get(), &node->value, hi);
+    if (left < 0 || left != right) return -1;
+    return left + (node->_color == Black ? 1 : 0);
+}
+
+// Red-black properties of the snapshot
+template <typename T, typename Compare>
+bool PersistentTreeSet<T, Compare>::Snapshot::is_balanced() const {
+    if (is_red(_version->_root)) return false;
+    return check(_version->_root.get(), nullptr, nullptr) >= 0;
+}
+
+#endif
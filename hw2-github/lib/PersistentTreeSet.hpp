@@ -0,0 +1,230 @@
+#ifndef PERSISTENT_TREE_SET_HPP
+#define PERSISTENT_TREE_SET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "EpochReclaimer.hpp"
+#include "TreeMap.hpp"
+
+/// @brief ordered set whose readers work on immutable snapshots
+/// Nodes are never modified once published. `add` and `remove` copy only the
+/// O(log n) nodes on the path from the root, share every other subtree with
+/// the previous version, and publish the new version with one atomic pointer
+/// store. Readers take no lock and touch no reference count: they pin their
+/// thread with the `EpochReclaimer`, load the version pointer and walk it, and
+/// a replaced version is freed once no pinned reader can still be on it.
+/// Writers are serialized by a mutex and never block readers.
+/// @note nodes have no parent links (they are shared between versions), so
+///       rebalancing follows Okasaki's insertion and Kahrs' deletion for
+///       functional red-black trees instead of CLRS.
+/// @tparam T type of the elements
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1
+template <typename T, typename Compare = DefaultComparator<T>>
+class PersistentTreeSet
+{
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        NodePtr _left;
+        NodePtr _right;
+        T value;
+        Color _color;
+
+        Node(Color color, NodePtr left, const T &value, NodePtr right) :
+            _left(std::move(left)), _right(std::move(right)), value(value), _color(color) {}
+    };
+
+    struct Version {
+        NodePtr _root;
+        size_t _size;
+    };
+
+    std::atomic<const Version *> _current; // replaced versions go to the EpochReclaimer
+    Compare _comparator;
+    std::mutex _write_mutex;
+
+    static void destroy_version(void *version);
+
+    /// @brief build a balanced tree from sorted, distinct values in O(n)
+    /// @param red_depth depth of the nodes to color red, or -1 for none
+    static NodePtr build(const std::vector<T> &values, size_t lo, size_t hi, int depth, int red_depth);
+
+    /// @brief the node equal to `key` below `node`, or null
+    template <typename K>
+    static const Node *find(const Node *node, const K &key, const Compare &comparator);
+
+    static NodePtr make_node(Color color, const NodePtr &left, const T &value, const NodePtr &right);
+    static bool is_red(const NodePtr &node);
+    static bool is_black(const NodePtr &node);
+    static NodePtr make_black(const NodePtr &node);
+
+    /// @brief rebuild a black node, resolving a red child with a red child
+    static NodePtr balance(const NodePtr &left, const T &value, const NodePtr &right);
+
+    /// @brief rebalance after the left subtree lost one black level
+    static NodePtr balance_left(const NodePtr &left, const T &value, const NodePtr &right);
+
+    /// @brief rebalance after the right subtree lost one black level
+    static NodePtr balance_right(const NodePtr &left, const T &value, const NodePtr &right);
+
+    /// @brief join two subtrees of equal black height whose keys are ordered
+    static NodePtr append(const NodePtr &left, const NodePtr &right);
+
+    /// @brief path-copying insert below `node`
+    /// @param inserted set to false if an equal element was replaced
+    NodePtr insert(const NodePtr &node, const T &value, bool &inserted) const;
+
+    /// @brief path-copying delete below `node`; `key` must be present
+    template <typename K>
+    NodePtr erase(const NodePtr &node, const K &key) const;
+
+    /// @brief make `root` the current version
+    void publish(NodePtr root, size_t size);
+
+public:
+    /// @brief immutable view of one version of the set
+    /// Taking a snapshot pins the calling thread (see `EpochReclaimer`) and
+    /// loads the version pointer: no lock and no shared reference count.
+    /// Every query on it runs without locks and without seeing later writes.
+    /// A snapshot must stay on the thread that took it, and while it lives
+    /// the versions replaced after it are not freed, so keep it short-lived.
+    class Snapshot
+    {
+    private:
+        friend class PersistentTreeSet;
+        EpochReclaimer::Guard _guard; // taken before `_version` is loaded
+        const Version *_version;
+        Compare _comparator;
+
+        Snapshot(const std::atomic<const Version *> &current, const Compare &comparator) :
+            _version(current.load(std::memory_order_acquire)), _comparator(comparator) {}
+
+        int check(const Node *node, const T *lo, const T *hi) const;
+
+    public:
+        /// @brief forward iterator over the snapshot in order
+        class const_iterator
+        {
+        private:
+            friend class Snapshot;
+            std::vector<const Node *> _stack; // path of nodes whose left side is done
+
+            void push_left(const Node *node) {
+                for (; node; node = node->_left.get()) {
+                    _stack.push_back(node);
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T *;
+            using reference = const T &;
+
+            const_iterator() = default;
+
+            reference operator*() const { return _stack.back()->value; }
+            pointer operator->() const { return &_stack.back()->value; }
+
+            const_iterator &operator++() {
+                const Node *node = _stack.back();
+                _stack.pop_back();
+                push_left(node->_right.get());
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            bool operator==(const const_iterator &other) const {
+                return _stack.empty() ? other._stack.empty()
+                                      : !other._stack.empty() && _stack.back() == other._stack.back();
+            }
+            bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        };
+
+        using iterator = const_iterator;
+
+        /// @brief Returns the number of elements in the snapshot.
+        size_t size() const { return _version->_size; }
+
+        /// @brief check if the snapshot is empty
+        bool is_empty() const { return _version->_size == 0; }
+
+        /// @brief check if an element equal to `key` is in the snapshot
+        /// @param key a `T`, or any type the comparator can compare with `T`
+        template <typename K>
+        bool contains(const K &key) const;
+
+        /// @brief finds the element equal to `key`, or std::nullopt if absent
+        template <typename K>
+        std::optional<T> get(const K &key) const;
+
+        /// @brief the smallest value, or std::nullopt if empty
+        std::optional<T> min() const;
+
+        /// @brief the largest value, or std::nullopt if empty
+        std::optional<T> max() const;
+
+        /// @brief a sorted vector containing all values in the snapshot
+        std::vector<T> to_vector() const;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        /// @brief check ordering and the red-black properties of the snapshot
+        bool is_balanced() const;
+    };
+
+    PersistentTreeSet();
+
+    /// @brief build a set from `items` in O(n log n) with one sort and one
+    ///        bottom-up pass; of equal items the last one is kept, as with `add`
+    PersistentTreeSet(const std::vector<T> &items);
+    PersistentTreeSet(Compare comparator);
+    PersistentTreeSet(const std::vector<T> &items, Compare comparator);
+    PersistentTreeSet(const PersistentTreeSet &other) = delete;
+    PersistentTreeSet &operator=(const PersistentTreeSet &other) = delete;
+    ~PersistentTreeSet();
+
+    /// @brief the current version; safe to call from any thread
+    Snapshot snapshot() const;
+
+    /// @brief Returns the number of elements in the current version.
+    /// @note pins the thread for one load, see `Snapshot`
+    size_t size() const;
+
+    /// @brief adds a value, replacing an equal element if present
+    /// @note copies O(log n) nodes; earlier snapshots are unaffected
+    void add(const T &value);
+
+    /// @brief removes the element equal to `key`
+    /// @return true if an element was removed, false if it was not in the set
+    template <typename K>
+    bool remove(const K &key);
+
+    /// @brief check if an element equal to `key` is in the current version
+    /// @note pins the thread for one search, without copying the comparator
+    template <typename K>
+    bool contains(const K &key) const;
+
+    /// @brief publish an empty version
+    void clear();
+};
+
+/// @brief persistent map: entries ordered by key, looked up with bare keys
+/// through `EntryComparator`, e.g. `snapshot.get(key)->second`
+template <typename TKey, typename TValue, typename Compare = DefaultComparator<TKey>>
+using PersistentTreeMap = PersistentTreeSet<std::pair<TKey, TValue>, EntryComparator<TKey, TValue, Compare>>;
+
+#endif
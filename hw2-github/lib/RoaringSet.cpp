@@ -0,0 +1,619 @@
+#ifndef ROARING_SET_CPP
+#define ROARING_SET_CPP
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include "RoaringSet.hpp"
+
+// Constructor
+template <typename T>
+RoaringSet<T>::RoaringSet() : _size(0) {}
+
+// Constructor - sorts the keys once and fills each chunk in one go
+template <typename T>
+RoaringSet<T>::RoaringSet(const std::vector<T> &items) : _size(0) {
+    std::vector<Key> keys;
+    keys.reserve(items.size());
+    for (T item : items) {
+        keys.push_back(to_key(item));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<uint16_t> lows;
+    for (size_t i = 0; i < keys.size();) {
+        Key high = high_of(keys[i]);
+        lows.clear();
+        for (; i < keys.size() && high_of(keys[i]) == high; ++i) {
+            lows.push_back(low_of(keys[i]));
+        }
+        Chunk chunk{high, Kind::Array, 0, {}, {}};
+        assign_values(chunk, lows);
+        _chunks.push_back(std::move(chunk));
+    }
+    _size = keys.size();
+    run_optimize();
+}
+
+// Binary search over the chunk keys
+template <typename T>
+size_t RoaringSet<T>::find_chunk(Key high) const {
+    auto it = std::lower_bound(_chunks.begin(), _chunks.end(), high,
+                               [](const Chunk &chunk, Key key) { return chunk.high < key; });
+    return static_cast<size_t>(it - _chunks.begin());
+}
+
+// Membership inside one chunk
+template <typename T>
+bool RoaringSet<T>::chunk_contains(const Chunk &chunk, uint16_t low) {
+    switch (chunk.kind) {
+    case Kind::Array:
+        return std::binary_search(chunk.values.begin(), chunk.values.end(), low);
+    case Kind::Bitmap:
+        return (chunk.words[low / 64] >> (low % 64)) & 1;
+    default: {
+        // last run starting at or before `low`
+        size_t lo = 0, hi = chunk.values.size() / 2;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (chunk.values[2 * mid] <= low) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo > 0 && low <= uint32_t(chunk.values[2 * lo - 2]) + chunk.values[2 * lo - 1];
+    }
+    }
+}
+
+// Insertion inside one chunk; a full array becomes a bitmap
+template <typename T>
+bool RoaringSet<T>::chunk_add(Chunk &chunk, uint16_t low) {
+    if (chunk.kind == Kind::Run) {
+        if (chunk_contains(chunk, low)) return false;
+        expand_runs(chunk);
+    }
+    if (chunk.kind == Kind::Array) {
+        auto it = std::lower_bound(chunk.values.begin(), chunk.values.end(), low);
+        if (it != chunk.values.end() && *it == low) return false;
+        if (chunk.cardinality < ARRAY_MAX) {
+            chunk.values.insert(it, low);
+            chunk.cardinality++;
+            return true;
+        }
+        std::vector<uint16_t> values = std::move(chunk.values);
+        values.insert(std::lower_bound(values.begin(), values.end(), low), low);
+        assign_values(chunk, values);
+        return true;
+    }
+    uint64_t &word = chunk.words[low / 64];
+    uint64_t bit = uint64_t(1) << (low % 64);
+    if (word & bit) return false;
+    word |= bit;
+    chunk.cardinality++;
+    return true;
+}
+
+// Removal inside one chunk; a sparse bitmap becomes an array
+template <typename T>
+bool RoaringSet<T>::chunk_remove(Chunk &chunk, uint16_t low) {
+    if (!chunk_contains(chunk, low)) return false;
+    if (chunk.kind == Kind::Run) {
+        expand_runs(chunk);
+    }
+    if (chunk.kind == Kind::Array) {
+        chunk.values.erase(std::lower_bound(chunk.values.begin(), chunk.values.end(), low));
+    } else {
+        chunk.words[low / 64] &= ~(uint64_t(1) << (low % 64));
+    }
+    chunk.cardinality--;
+    shrink_bitmap(chunk);
+    return true;
+}
+
+// Smallest low value of a non-empty chunk
+template <typename T>
+uint16_t RoaringSet<T>::chunk_min(const Chunk &chunk) {
+    if (chunk.kind != Kind::Bitmap) return chunk.values.front();
+    size_t w = 0;
+    while (chunk.words[w] == 0) {
+        ++w;
+    }
+    return static_cast<uint16_t>(w * 64 + __builtin_ctzll(chunk.words[w]));
+}
+
+// Largest low value of a non-empty chunk
+template <typename T>
+uint16_t RoaringSet<T>::chunk_max(const Chunk &chunk) {
+    switch (chunk.kind) {
+    case Kind::Array:
+        return chunk.values.back();
+    case Kind::Run:
+        return static_cast<uint16_t>(chunk.values[chunk.values.size() - 2] + chunk.values.back());
+    default: {
+        size_t w = BITMAP_WORDS - 1;
+        while (chunk.words[w] == 0) {
+            --w;
+        }
+        return static_cast<uint16_t>(w * 64 + 63 - __builtin_clzll(chunk.words[w]));
+    }
+    }
+}
+
+// Decodes any container into sorted low values
+template <typename T>
+std::vector<uint16_t> RoaringSet<T>::chunk_values(const Chunk &chunk) {
+    if (chunk.kind == Kind::Array) return chunk.values;
+    std::vector<uint16_t> values;
+    values.reserve(chunk.cardinality);
+    if (chunk.kind == Kind::Bitmap) {
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+            for (uint64_t bits = chunk.words[w]; bits; bits &= bits - 1) {
+                values.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(bits)));
+            }
+        }
+    } else {
+        for (size_t r = 0; r < chunk.values.size(); r += 2) {
+            for (uint32_t v = chunk.values[r]; v <= uint32_t(chunk.values[r]) + chunk.values[r + 1]; ++v) {
+                values.push_back(static_cast<uint16_t>(v));
+            }
+        }
+    }
+    return values;
+}
+
+// Array up to ARRAY_MAX values, bitmap beyond
+template <typename T>
+void RoaringSet<T>::assign_values(Chunk &chunk, const std::vector<uint16_t> &values) {
+    chunk.cardinality = static_cast<uint32_t>(values.size());
+    if (values.size() <= ARRAY_MAX) {
+        chunk.kind = Kind::Array;
+        chunk.values = values;
+        std::vector<uint64_t>().swap(chunk.words);
+    } else {
+        chunk.kind = Kind::Bitmap;
+        chunk.words.assign(BITMAP_WORDS, 0);
+        for (uint16_t low : values) {
+            chunk.words[low / 64] |= uint64_t(1) << (low % 64);
+        }
+        std::vector<uint16_t>().swap(chunk.values);
+    }
+}
+
+// Bitmap to array at ARRAY_MAX values or fewer
+template <typename T>
+void RoaringSet<T>::shrink_bitmap(Chunk &chunk) {
+    if (chunk.kind == Kind::Bitmap && chunk.cardinality <= ARRAY_MAX) {
+        assign_values(chunk, chunk_values(chunk));
+    }
+}
+
+// Runs to array or bitmap
+template <typename T>
+void RoaringSet<T>::expand_runs(Chunk &chunk) {
+    if (chunk.kind == Kind::Run) {
+        assign_values(chunk, chunk_values(chunk));
+    }
+}
+
+// Counts maximal runs of consecutive values
+template <typename T>
+size_t RoaringSet<T>::count_runs(const Chunk &chunk) {
+    switch (chunk.kind) {
+    case Kind::Run:
+        return chunk.values.size() / 2;
+    case Kind::Array: {
+        size_t runs = 0;
+        for (size_t i = 0; i < chunk.values.size(); ++i) {
+            runs += i == 0 || chunk.values[i] != chunk.values[i - 1] + 1;
+        }
+        return runs;
+    }
+    default: {
+        // a run starts at every set bit whose lower neighbour is clear
+        size_t runs = 0;
+        uint64_t carry = 0;
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+            uint64_t word = chunk.words[w];
+            runs += __builtin_popcountll(word & ~((word << 1) | carry));
+            carry = word >> 63;
+        }
+        return runs;
+    }
+    }
+}
+
+// Bitmap OR / AND, four words per step
+template <typename T>
+uint32_t RoaringSet<T>::combine_bitmaps(const uint64_t *a, const uint64_t *b, uint64_t *out, bool intersect) {
+    uint32_t count = 0;
+#if defined(__GNUC__)
+    typedef uint64_t Vec __attribute__((vector_size(32)));
+    for (size_t w = 0; w < BITMAP_WORDS; w += 4) {
+        Vec x, y;
+        std::memcpy(&x, a + w, sizeof(x));
+        std::memcpy(&y, b + w, sizeof(y));
+        Vec z = intersect ? (x & y) : (x | y);
+        std::memcpy(out + w, &z, sizeof(z));
+    }
+#else
+    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        out[w] = intersect ? (a[w] & b[w]) : (a[w] | b[w]);
+    }
+#endif
+    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        count += __builtin_popcountll(out[w]);
+    }
+    return count;
+}
+
+// Sorted-array intersection. Each step compares a block of 8 values of `a`
+// against all 8 rotations of a block of `b`, then moves past whichever
+// block ends lower; the leftovers are merged one by one.
+template <typename T>
+size_t RoaringSet<T>::intersect_arrays(const uint16_t *a, size_t na, const uint16_t *b, size_t nb, uint16_t *out) {
+    size_t i = 0, j = 0, count = 0;
+#if defined(__GNUC__)
+    typedef uint16_t Vec __attribute__((vector_size(16)));
+    typedef int16_t Mask __attribute__((vector_size(16))); // true lanes are -1
+    while (i + 8 <= na && j + 8 <= nb) {
+        Vec va;
+        std::memcpy(&va, a + i, sizeof(va));
+        uint16_t twice[16];
+        std::memcpy(twice, b + j, 8 * sizeof(uint16_t));
+        std::memcpy(twice + 8, b + j, 8 * sizeof(uint16_t));
+        Mask match = {};
+        for (size_t r = 0; r < 8; ++r) {
+            Vec vb;
+            std::memcpy(&vb, twice + r, sizeof(vb));
+            match |= va == vb;
+        }
+        for (size_t lane = 0; lane < 8; ++lane) {
+            if (match[lane]) out[count++] = a[i + lane];
+        }
+        uint16_t a_last = a[i + 7], b_last = b[j + 7];
+        if (a_last <= b_last) i += 8;
+        if (b_last <= a_last) j += 8;
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out[count++] = a[i];
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+// Union of two chunks; runs are expanded first
+template <typename T>
+typename RoaringSet<T>::Chunk RoaringSet<T>::unite_chunks(const Chunk &a, const Chunk &b) {
+    if (a.kind == Kind::Run || b.kind == Kind::Run) {
+        Chunk x = a, y = b;
+        expand_runs(x);
+        expand_runs(y);
+        return unite_chunks(x, y);
+    }
+    Chunk result{a.high, Kind::Bitmap, 0, {}, {}};
+    if (a.kind == Kind::Bitmap && b.kind == Kind::Bitmap) {
+        result.words.resize(BITMAP_WORDS);
+        result.cardinality = combine_bitmaps(a.words.data(), b.words.data(), result.words.data(), false);
+    } else if (a.kind == Kind::Bitmap || b.kind == Kind::Bitmap) {
+        const Chunk &bitmap = a.kind == Kind::Bitmap ? a : b;
+        const Chunk &array = a.kind == Kind::Bitmap ? b : a;
+        result.words = bitmap.words;
+        result.cardinality = bitmap.cardinality;
+        for (uint16_t low : array.values) {
+            uint64_t &word = result.words[low / 64];
+            uint64_t bit = uint64_t(1) << (low % 64);
+            result.cardinality += (word & bit) == 0;
+            word |= bit;
+        }
+    } else {
+        std::vector<uint16_t> values;
+        values.reserve(a.values.size() + b.values.size());
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+        assign_values(result, values);
+    }
+    return result;
+}
+
+// Intersection of two chunks; runs are expanded first
+template <typename T>
+typename RoaringSet<T>::Chunk RoaringSet<T>::intersect_chunks(const Chunk &a, const Chunk &b) {
+    if (a.kind == Kind::Run || b.kind == Kind::Run) {
+        Chunk x = a, y = b;
+        expand_runs(x);
+        expand_runs(y);
+        return intersect_chunks(x, y);
+    }
+    Chunk result{a.high, Kind::Array, 0, {}, {}};
+    if (a.kind == Kind::Bitmap && b.kind == Kind::Bitmap) {
+        result.kind = Kind::Bitmap;
+        result.words.resize(BITMAP_WORDS);
+        result.cardinality = combine_bitmaps(a.words.data(), b.words.data(), result.words.data(), true);
+        shrink_bitmap(result);
+    } else if (a.kind == Kind::Bitmap || b.kind == Kind::Bitmap) {
+        const Chunk &bitmap = a.kind == Kind::Bitmap ? a : b;
+        const Chunk &array = a.kind == Kind::Bitmap ? b : a;
+        for (uint16_t low : array.values) {
+            if ((bitmap.words[low / 64] >> (low % 64)) & 1) result.values.push_back(low);
+        }
+        result.cardinality = static_cast<uint32_t>(result.values.size());
+    } else {
+        result.values.resize(std::min(a.values.size(), b.values.size()));
+        size_t count = intersect_arrays(a.values.data(), a.values.size(), b.values.data(), b.values.size(),
+                                        result.values.data());
+        result.values.resize(count);
+        result.cardinality = static_cast<uint32_t>(count);
+    }
+    return result;
+}
+
+// Next value after `low` in a chunk
+template <typename T>
+uint32_t RoaringSet<T>::chunk_next(const Chunk &chunk, size_t &index, uint32_t low) {
+    switch (chunk.kind) {
+    case Kind::Array:
+        return ++index < chunk.values.size() ? chunk.values[index] : 65536;
+    case Kind::Run:
+        if (low < uint32_t(chunk.values[2 * index]) + chunk.values[2 * index + 1]) return low + 1;
+        return 2 * ++index < chunk.values.size() ? chunk.values[2 * index] : 65536;
+    default: {
+        uint32_t next = low + 1;
+        if (next == 65536) return 65536;
+        size_t w = next / 64;
+        uint64_t bits = chunk.words[w] & (~uint64_t(0) << (next % 64));
+        while (!bits) {
+            if (++w == BITMAP_WORDS) return 65536;
+            bits = chunk.words[w];
+        }
+        return static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits));
+    }
+    }
+}
+
+// Heap bytes of a chunk's container
+template <typename T>
+size_t RoaringSet<T>::chunk_bytes(const Chunk &chunk) {
+    return chunk.values.capacity() * sizeof(uint16_t) + chunk.words.capacity() * sizeof(uint64_t);
+}
+
+// Iterator at the first value of chunk `chunk`, or end()
+template <typename T>
+RoaringSet<T>::const_iterator::const_iterator(const RoaringSet *set, size_t chunk)
+    : _set(set), _chunk(chunk), _index(0), _low(0) {
+    if (_chunk < _set->_chunks.size()) {
+        _low = chunk_min(_set->_chunks[_chunk]);
+    }
+}
+
+// Next value, moving to the next chunk at the end of one
+template <typename T>
+typename RoaringSet<T>::const_iterator &RoaringSet<T>::const_iterator::operator++() {
+    _low = chunk_next(_set->_chunks[_chunk], _index, _low);
+    if (_low == 65536) {
+        *this = const_iterator(_set, _chunk + 1);
+    }
+    return *this;
+}
+
+// Returns set elements
+template <typename T>
+size_t RoaringSet<T>::size() const {
+    return _size;
+}
+
+// Add a value, making a chunk for it if needed
+template <typename T>
+void RoaringSet<T>::add(T value) {
+    Key key = to_key(value);
+    size_t i = find_chunk(high_of(key));
+    if (i == _chunks.size() || _chunks[i].high != high_of(key)) {
+        _chunks.insert(_chunks.begin() + i, Chunk{high_of(key), Kind::Array, 0, {}, {}});
+    }
+    _size += chunk_add(_chunks[i], low_of(key));
+}
+
+// Remove a value, dropping its chunk once empty
+template <typename T>
+bool RoaringSet<T>::remove(T value) {
+    Key key = to_key(value);
+    size_t i = find_chunk(high_of(key));
+    if (i == _chunks.size() || _chunks[i].high != high_of(key) || !chunk_remove(_chunks[i], low_of(key))) {
+        return false;
+    }
+    if (_chunks[i].cardinality == 0) {
+        _chunks.erase(_chunks.begin() + i);
+    }
+    _size--;
+    return true;
+}
+
+// Check if a value is in the set
+template <typename T>
+bool RoaringSet<T>::contains(T value) const {
+    Key key = to_key(value);
+    size_t i = find_chunk(high_of(key));
+    return i < _chunks.size() && _chunks[i].high == high_of(key) && chunk_contains(_chunks[i], low_of(key));
+}
+
+// Check if the set is empty
+template <typename T>
+bool RoaringSet<T>::is_empty() const {
+    return _size == 0;
+}
+
+// Smallest value
+template <typename T>
+std::optional<T> RoaringSet<T>::min() const {
+    if (_chunks.empty()) return std::nullopt;
+    return compose(_chunks.front().high, chunk_min(_chunks.front()));
+}
+
+// Largest value
+template <typename T>
+std::optional<T> RoaringSet<T>::max() const {
+    if (_chunks.empty()) return std::nullopt;
+    return compose(_chunks.back().high, chunk_max(_chunks.back()));
+}
+
+// Values in order
+template <typename T>
+std::vector<T> RoaringSet<T>::to_vector() const {
+    std::vector<T> result;
+    result.reserve(_size);
+    for (T value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Iterator to the smallest value
+template <typename T>
+typename RoaringSet<T>::const_iterator RoaringSet<T>::begin() const {
+    return const_iterator(this, 0);
+}
+
+// Iterator past the largest value
+template <typename T>
+typename RoaringSet<T>::const_iterator RoaringSet<T>::end() const {
+    return const_iterator(this, _chunks.size());
+}
+
+// Set union
+template <typename T>
+RoaringSet<T> RoaringSet<T>::operator+(const RoaringSet &other) const {
+    RoaringSet result = *this;
+    result += other;
+    return result;
+}
+
+// In-place union: chunks of one side only are copied, shared ones united
+template <typename T>
+RoaringSet<T> &RoaringSet<T>::operator+=(const RoaringSet &other) {
+    if (this == &other) return *this;
+    std::vector<Chunk> merged;
+    merged.reserve(_chunks.size() + other._chunks.size());
+    size_t i = 0, j = 0;
+    while (i < _chunks.size() || j < other._chunks.size()) {
+        if (j == other._chunks.size() || (i < _chunks.size() && _chunks[i].high < other._chunks[j].high)) {
+            merged.push_back(std::move(_chunks[i++]));
+        } else if (i == _chunks.size() || other._chunks[j].high < _chunks[i].high) {
+            merged.push_back(other._chunks[j++]);
+        } else {
+            merged.push_back(unite_chunks(_chunks[i++], other._chunks[j++]));
+        }
+    }
+    _chunks = std::move(merged);
+    _size = 0;
+    for (const Chunk &chunk : _chunks) {
+        _size += chunk.cardinality;
+    }
+    return *this;
+}
+
+// Set intersection over the chunks both sides have
+template <typename T>
+RoaringSet<T> RoaringSet<T>::operator&(const RoaringSet &other) const {
+    RoaringSet result;
+    size_t i = 0, j = 0;
+    while (i < _chunks.size() && j < other._chunks.size()) {
+        if (_chunks[i].high < other._chunks[j].high) {
+            ++i;
+        } else if (other._chunks[j].high < _chunks[i].high) {
+            ++j;
+        } else {
+            Chunk chunk = intersect_chunks(_chunks[i++], other._chunks[j++]);
+            if (chunk.cardinality > 0) {
+                result._size += chunk.cardinality;
+                result._chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+    return result;
+}
+
+// In-place set intersection
+template <typename T>
+RoaringSet<T> &RoaringSet<T>::operator&=(const RoaringSet &other) {
+    if (this != &other) {
+        *this = *this & other;
+    }
+    return *this;
+}
+
+// Set equality, by value since equal chunks may use different containers
+template <typename T>
+bool RoaringSet<T>::operator==(const RoaringSet &other) const {
+    if (_size != other._size || _chunks.size() != other._chunks.size()) return false;
+    for (size_t i = 0; i < _chunks.size(); ++i) {
+        const Chunk &a = _chunks[i], &b = other._chunks[i];
+        if (a.high != b.high || a.cardinality != b.cardinality) return false;
+        if (a.kind == b.kind) {
+            if (a.values != b.values || a.words != b.words) return false;
+        } else if (chunk_values(a) != chunk_values(b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Set inequality
+template <typename T>
+bool RoaringSet<T>::operator!=(const RoaringSet &other) const {
+    return !(*this == other);
+}
+
+// Converts chunks whose runs are smaller than their array or bitmap
+template <typename T>
+void RoaringSet<T>::run_optimize() {
+    for (Chunk &chunk : _chunks) {
+        if (chunk.kind == Kind::Run) continue;
+        size_t runs = count_runs(chunk);
+        size_t current = chunk.kind == Kind::Array ? 2 * chunk.cardinality : 8 * BITMAP_WORDS;
+        if (4 * runs >= current) continue;
+
+        std::vector<uint16_t> values = chunk_values(chunk);
+        std::vector<uint16_t> pairs;
+        pairs.reserve(2 * runs);
+        for (size_t i = 0; i < values.size();) {
+            size_t j = i + 1;
+            while (j < values.size() && values[j] == values[j - 1] + 1) {
+                ++j;
+            }
+            pairs.push_back(values[i]);
+            pairs.push_back(static_cast<uint16_t>(j - i - 1));
+            i = j;
+        }
+        chunk.kind = Kind::Run;
+        chunk.values = std::move(pairs);
+        std::vector<uint64_t>().swap(chunk.words);
+    }
+}
+
+// Container and chunk-header bytes per element
+template <typename T>
+double RoaringSet<T>::bytes_per_element() const {
+    if (_size == 0) return 0;
+    size_t bytes = _chunks.capacity() * sizeof(Chunk);
+    for (const Chunk &chunk : _chunks) {
+        bytes += chunk_bytes(chunk);
+    }
+    return static_cast<double>(bytes) / _size;
+}
+
+// Clear the set
+template <typename T>
+void RoaringSet<T>::clear() {
+    _chunks.clear();
+    _size = 0;
+}
+#endif
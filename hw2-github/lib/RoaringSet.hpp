@@ -0,0 +1,221 @@
+#ifndef ROARING_SET_HPP
+#define ROARING_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+/// @brief compressed set of integers in the style of Roaring bitmaps
+/// Values are split into their high bits, which pick a chunk, and their low
+/// 16 bits, which the chunk stores in one of three containers:
+///   - an array of sorted 16-bit values, 2 bytes per element, while the
+///     chunk holds at most 4096 of them,
+///   - a bitmap of all 65536 low values, 8 KB, for denser chunks,
+///   - a list of runs of consecutive values, 4 bytes per run, for chunks
+///     that are mostly ranges; see `run_optimize`.
+/// Dense ID ranges take well under a byte per element, against over 40 for a
+/// `TreeSet` node. Offers the ordered-set part of the `TreeSet` interface
+/// for integers, with forward iteration only.
+/// @tparam T an integer type of at least 32 bits
+template <typename T>
+class RoaringSet
+{
+private:
+    static_assert(std::is_integral<T>::value && sizeof(T) >= 4, "RoaringSet holds integers of 32 bits or more");
+
+    using Key = std::make_unsigned_t<T>;
+
+    static constexpr size_t ARRAY_MAX = 4096; // beyond this a bitmap is smaller
+    static constexpr size_t BITMAP_WORDS = 65536 / 64;
+
+    enum class Kind : uint8_t { Array, Bitmap, Run };
+
+    struct Chunk {
+        Key high;             // value >> 16, in `Key` order
+        Kind kind;
+        uint32_t cardinality; // up to 65536
+        /// Array: the sorted low values. Run: pairs of (start, length - 1).
+        std::vector<uint16_t> values;
+        /// Bitmap: `BITMAP_WORDS` words, bit `low % 64` of word `low / 64`
+        std::vector<uint64_t> words;
+    };
+
+    std::vector<Chunk> _chunks; // sorted by `high`
+    size_t _size;
+
+    // signed values are stored with the sign bit flipped, so that `Key`
+    // order is value order
+    static Key to_key(T value) {
+        Key key = static_cast<Key>(value);
+        if (std::is_signed<T>::value) key ^= Key(1) << (8 * sizeof(T) - 1);
+        return key;
+    }
+    static T from_key(Key key) {
+        if (std::is_signed<T>::value) key ^= Key(1) << (8 * sizeof(T) - 1);
+        return static_cast<T>(key);
+    }
+    static Key high_of(Key key) { return key >> 16; }
+    static uint16_t low_of(Key key) { return static_cast<uint16_t>(key); }
+    static T compose(Key high, uint32_t low) { return from_key(static_cast<Key>((high << 16) | low)); }
+
+    /// @brief index of the chunk for `high`, or of the first chunk after it
+    size_t find_chunk(Key high) const;
+
+    static bool chunk_contains(const Chunk &chunk, uint16_t low);
+
+    /// @return true if `low` was not in the chunk yet
+    static bool chunk_add(Chunk &chunk, uint16_t low);
+
+    /// @return true if `low` was in the chunk
+    static bool chunk_remove(Chunk &chunk, uint16_t low);
+
+    static uint16_t chunk_min(const Chunk &chunk);
+    static uint16_t chunk_max(const Chunk &chunk);
+
+    /// @brief the low values of a chunk, in order
+    static std::vector<uint16_t> chunk_values(const Chunk &chunk);
+
+    /// @brief store sorted low values as an array or a bitmap, whichever is smaller
+    static void assign_values(Chunk &chunk, const std::vector<uint16_t> &values);
+
+    /// @brief turn a bitmap into an array once it is sparse enough
+    static void shrink_bitmap(Chunk &chunk);
+
+    /// @brief turn a run container into an array or a bitmap
+    static void expand_runs(Chunk &chunk);
+
+    /// @brief number of runs of consecutive values in a chunk
+    static size_t count_runs(const Chunk &chunk);
+
+    /// @brief the union and intersection of two chunks with the same `high`
+    static Chunk unite_chunks(const Chunk &a, const Chunk &b);
+    static Chunk intersect_chunks(const Chunk &a, const Chunk &b);
+
+    /// @brief `a | b` or `a & b` of two bitmaps into `out`
+    /// @return the number of bits set in `out`
+    static uint32_t combine_bitmaps(const uint64_t *a, const uint64_t *b, uint64_t *out, bool intersect);
+
+    /// @brief the values of sorted `a` also in sorted `b`, written to `out`
+    /// @return the number of values written
+    static size_t intersect_arrays(const uint16_t *a, size_t na, const uint16_t *b, size_t nb, uint16_t *out);
+
+    /// @brief the value after `low` in a chunk, or 65536 if there is none
+    /// @param index position of `low` in an array, or of its run in a run container
+    static uint32_t chunk_next(const Chunk &chunk, size_t &index, uint32_t low);
+
+    static size_t chunk_bytes(const Chunk &chunk);
+
+public:
+    /// @brief forward iterator over the set in increasing order
+    class const_iterator
+    {
+    private:
+        friend class RoaringSet;
+        const RoaringSet *_set;
+        size_t _chunk;
+        size_t _index;
+        uint32_t _low;
+
+        const_iterator(const RoaringSet *set, size_t chunk);
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = T;
+
+        const_iterator() : _set(nullptr), _chunk(0), _index(0), _low(0) {}
+
+        T operator*() const { return compose(_set->_chunks[_chunk].high, _low); }
+
+        const_iterator &operator++();
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _chunk == other._chunk && _low == other._low;
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = const_iterator;
+
+    RoaringSet();
+
+    /// @brief build a set from `items` in O(n log n), picking the smallest
+    ///        container for every chunk
+    /// @param items the elements, in any order and possibly with duplicates
+    RoaringSet(const std::vector<T> &items);
+
+    /// @brief Returns the number of elements in the set.
+    size_t size() const;
+
+    /// @brief adds a value to the set
+    /// @note O(log chunks) plus O(4096) at worst inside an array chunk; a
+    ///       run chunk is first expanded to an array or bitmap. A value in a
+    ///       new chunk costs O(chunks) to insert the chunk, so build sets of
+    ///       sparse values with the vector constructor instead.
+    void add(T value);
+
+    /// @brief removes a value from the set
+    /// @return true if an element was removed, false if it was not in the set
+    bool remove(T value);
+
+    /// @brief check if a element is in the set
+    bool contains(T value) const;
+
+    /// @brief check if the set is empty
+    bool is_empty() const;
+
+    /// @brief the smallest value in the set, or std::nullopt if empty
+    std::optional<T> min() const;
+
+    /// @brief the largest value in the set, or std::nullopt if empty
+    std::optional<T> max() const;
+
+    /// @brief a sorted vector containing all values in the set
+    std::vector<T> to_vector() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// @brief set union
+    /// @note bitmaps are combined 32 bytes at a time
+    RoaringSet operator+(const RoaringSet &other) const;
+
+    /// @brief in-place set union
+    RoaringSet &operator+=(const RoaringSet &other);
+
+    /// @brief set intersection
+    /// @note bitmaps are combined 32 bytes at a time, and two arrays are
+    ///       intersected 8 values against 8 per step
+    RoaringSet operator&(const RoaringSet &other) const;
+
+    /// @brief in-place set intersection
+    RoaringSet &operator&=(const RoaringSet &other);
+
+    bool operator==(const RoaringSet &other) const;
+    bool operator!=(const RoaringSet &other) const;
+
+    /// @brief store every chunk as runs where that takes less memory, e.g.
+    ///        after filling the set with ranges of consecutive IDs
+    /// @note later `add` and `remove` calls expand the chunks they touch, and
+    ///       set operations produce arrays and bitmaps, so call it again once
+    ///       the set has settled
+    void run_optimize();
+
+    /// @brief bytes of container storage and chunk headers, per element
+    double bytes_per_element() const;
+
+    /// @brief remove every element in the set
+    void clear();
+};
+
+#endif
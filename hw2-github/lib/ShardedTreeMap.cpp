@@ -0,0 +1,175 @@
+#ifndef SHARDED_TREE_MAP_CPP
+#define SHARDED_TREE_MAP_CPP
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "ShardedTreeMap.hpp"
+#include "TreeMap.cpp"
+
+// Constructor
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+ShardedTreeMap<TKey, TValue, Compare, Hash>::ShardedTreeMap(size_t shards) : ShardedTreeMap(shards, Compare()) {}
+
+// Constructor with a custom comparator and hash
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+ShardedTreeMap<TKey, TValue, Compare, Hash>::ShardedTreeMap(size_t shards, Compare comparator, Hash hash)
+    : _comparator(std::move(comparator)), _hash(std::move(hash)) {
+    if (shards == 0) {
+        throw std::invalid_argument("ShardedTreeMap needs at least one shard");
+    }
+    _shards.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        _shards.push_back(std::make_unique<Shard>(_comparator));
+    }
+}
+
+// Shard of a key - the hash is remixed, as std::hash of an integer is the identity
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+typename ShardedTreeMap<TKey, TValue, Compare, Hash>::Shard &
+ShardedTreeMap<TKey, TValue, Compare, Hash>::shard_of(const TKey &key) const {
+    uint64_t h = static_cast<uint64_t>(_hash(key)) * 0x9E3779B97F4A7C15ull;
+    return *_shards[(h >> 32) % _shards.size()];
+}
+
+// Lock all shards - always in index order, so two callers cannot deadlock
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+std::vector<std::unique_lock<std::mutex>> ShardedTreeMap<TKey, TValue, Compare, Hash>::lock_all() const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(_shards.size());
+    for (const auto &shard : _shards) {
+        locks.emplace_back(shard->mutex);
+    }
+    return locks;
+}
+
+// K-way merge - a min-heap holds the run whose next key is smallest on top
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+template <typename It>
+std::vector<std::pair<TKey, TValue>>
+ShardedTreeMap<TKey, TValue, Compare, Hash>::merge(std::vector<std::pair<It, It>> &runs) const {
+    runs.erase(std::remove_if(runs.begin(), runs.end(), [](const auto &run) { return run.first == run.second; }),
+               runs.end());
+    auto later = [this](const std::pair<It, It> &a, const std::pair<It, It> &b) {
+        return _comparator(a.first->first, b.first->first) > 0;
+    };
+    std::make_heap(runs.begin(), runs.end(), later);
+
+    std::vector<std::pair<TKey, TValue>> result;
+    while (!runs.empty()) {
+        std::pop_heap(runs.begin(), runs.end(), later);
+        std::pair<It, It> &run = runs.back();
+        result.push_back(*run.first);
+        if (++run.first == run.second) {
+            runs.pop_back();
+        } else {
+            std::push_heap(runs.begin(), runs.end(), later);
+        }
+    }
+    return result;
+}
+
+// Shard count
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+size_t ShardedTreeMap<TKey, TValue, Compare, Hash>::shard_count() const {
+    return _shards.size();
+}
+
+// Size
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+size_t ShardedTreeMap<TKey, TValue, Compare, Hash>::size() const {
+    size_t total = 0;
+    for (const auto &shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->map.size();
+    }
+    return total;
+}
+
+// Insert
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+void ShardedTreeMap<TKey, TValue, Compare, Hash>::insert(TKey key, TValue value) {
+    Shard &shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map.insert(std::move(key), std::move(value));
+}
+
+// Remove
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+bool ShardedTreeMap<TKey, TValue, Compare, Hash>::remove(const TKey &key) {
+    Shard &shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.remove(key);
+}
+
+// Get
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+std::optional<TValue> ShardedTreeMap<TKey, TValue, Compare, Hash>::get(const TKey &key) const {
+    Shard &shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.get(key);
+}
+
+// Contains
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+bool ShardedTreeMap<TKey, TValue, Compare, Hash>::contains(const TKey &key) const {
+    Shard &shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.contains(key);
+}
+
+// Update - one descent through find_or_insert under the shard lock
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+template <typename F>
+auto ShardedTreeMap<TKey, TValue, Compare, Hash>::update(const TKey &key, F &&fn) {
+    Shard &shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return fn(shard.map.find_or_insert(key));
+}
+
+// To vector
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+std::vector<std::pair<TKey, TValue>> ShardedTreeMap<TKey, TValue, Compare, Hash>::to_vector() const {
+    auto locks = lock_all();
+    using It = typename TreeMap<TKey, TValue, Compare>::const_iterator;
+    std::vector<std::pair<It, It>> runs;
+    for (const auto &shard : _shards) {
+        runs.emplace_back(shard->map.begin(), shard->map.end());
+    }
+    return merge(runs);
+}
+
+// Range
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+std::vector<std::pair<TKey, TValue>> ShardedTreeMap<TKey, TValue, Compare, Hash>::range(const TKey &lo,
+                                                                                      const TKey &hi) const {
+    if (_comparator(lo, hi) > 0) return {};
+    auto locks = lock_all();
+    using It = typename TreeMap<TKey, TValue, Compare>::const_iterator;
+    std::vector<std::pair<It, It>> runs;
+    for (const auto &shard : _shards) {
+        runs.emplace_back(shard->map.lower_bound(lo), shard->map.upper_bound(hi));
+    }
+    return merge(runs);
+}
+
+// Is empty
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+bool ShardedTreeMap<TKey, TValue, Compare, Hash>::is_empty() const {
+    for (const auto &shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (!shard->map.is_empty()) return false;
+    }
+    return true;
+}
+
+// Clear
+template <typename TKey, typename TValue, typename Compare, typename Hash>
+void ShardedTreeMap<TKey, TValue, Compare, Hash>::clear() {
+    auto locks = lock_all();
+    for (const auto &shard : _shards) {
+        shard->map.clear();
+    }
+}
+
+#endif
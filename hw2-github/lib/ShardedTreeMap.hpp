@@ -0,0 +1,100 @@
+#ifndef SHARDED_TREE_MAP_HPP
+#define SHARDED_TREE_MAP_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "BloomFilter.hpp"
+#include "TreeMap.hpp"
+
+/// @brief map that many threads can update at once, built from `TreeMap`s
+/// Keys are spread over a fixed number of shards by hash, and each shard is
+/// a `TreeMap` behind its own mutex. A point operation locks one shard, so
+/// threads only wait for each other when their keys share a shard. Ordered
+/// results (`to_vector`, `range`) lock every shard, in index order, and
+/// merge the shards' sorted entries, so they see one consistent state.
+/// @tparam Compare callable `int(const TKey &, const TKey &)` returning -1, 0 or 1
+/// @tparam Hash callable `size_t(const TKey &)` that picks the shard; it must
+///         agree with `Compare`: keys that compare equal have to hash equal
+template <typename TKey, typename TValue, typename Compare = DefaultComparator<TKey>,
+          typename Hash = FilterHash<TKey>>
+class ShardedTreeMap
+{
+private:
+    static constexpr size_t DEFAULT_SHARDS = 64;
+
+    /// one per cache line, so that locking one shard does not slow its neighbours
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        TreeMap<TKey, TValue, Compare> map;
+
+        explicit Shard(const Compare &comparator) : map(comparator) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+    Compare _comparator;
+    Hash _hash;
+
+    /// @brief the shard that holds `key`
+    Shard &shard_of(const TKey &key) const;
+
+    /// @brief lock every shard, in index order
+    std::vector<std::unique_lock<std::mutex>> lock_all() const;
+
+    /// @brief merge the sorted entries of `[first, last)` iterator pairs, one per shard
+    template <typename It>
+    std::vector<std::pair<TKey, TValue>> merge(std::vector<std::pair<It, It>> &runs) const;
+
+public:
+    /// @param shards number of inner maps; a few times the number of threads
+    ///        that update the map keeps them from queueing on one lock
+    ShardedTreeMap(size_t shards = DEFAULT_SHARDS);
+    ShardedTreeMap(size_t shards, Compare comparator, Hash hash = Hash());
+    ShardedTreeMap(const ShardedTreeMap &) = delete;
+    ShardedTreeMap &operator=(const ShardedTreeMap &) = delete;
+
+    /// @brief number of shards
+    size_t shard_count() const;
+
+    /// @brief Returns the number of elements in the map.
+    /// @note locks the shards one at a time, so with concurrent writers the
+    ///       result is a sum of counts taken at slightly different times
+    size_t size() const;
+
+    /// @brief insert a key-value pair into the map
+    void insert(TKey key, TValue value);
+
+    /// @brief remove a key and its value from the map
+    /// @return true if the key was in the map, otherwise false
+    bool remove(const TKey &key);
+
+    /// @brief get a copy of the value of a key
+    std::optional<TValue> get(const TKey &key) const;
+
+    /// @brief check if a key is in the map
+    bool contains(const TKey &key) const;
+
+    /// @brief call `fn(value)` on the value of `key` while its shard is
+    ///        locked, value-initializing it first if the key is new
+    /// @return what `fn` returns, e.g. `update(k, [](int &c) { return ++c; })`
+    /// @note `fn` must not call back into this map
+    template <typename F>
+    auto update(const TKey &key, F &&fn);
+
+    /// @brief every entry in key order, from one consistent state of the map
+    std::vector<std::pair<TKey, TValue>> to_vector() const;
+
+    /// @brief the entries whose key k satisfies lo <= k <= hi, in key order
+    std::vector<std::pair<TKey, TValue>> range(const TKey &lo, const TKey &hi) const;
+
+    /// @brief check if the map is empty
+    bool is_empty() const;
+
+    /// @brief remove every entry
+    void clear();
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef SORTED_RUN_HPP
+#define SORTED_RUN_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A sorted-run file holds the elements of a set or map in increasing order:
+//
+//   SortedRunHeader   32 bytes
+//   Record[count]     the elements as raw bytes, starting at offset 32
+//
+// Records are written with the layout of the machine that wrote them, so a
+// file is only read back by a build with the same record type, size and
+// byte order; the header lets `MappedSortedRun` reject anything else.
+
+/// @brief fixed-size header at the start of a sorted-run file
+struct SortedRunHeader
+{
+    static constexpr char MAGIC[8] = {'S', 'O', 'R', 'T', 'R', 'U', 'N', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t record_size;
+    uint32_t record_align;
+    uint64_t count;
+};
+
+static_assert(sizeof(SortedRunHeader) == 32, "sorted-run header must stay 32 bytes");
+
+/// @brief a key-value record of a map's sorted-run file
+/// @note `std::pair` is not trivially copyable, so maps store this instead
+template <typename K, typename V>
+struct SortedRunEntry
+{
+    K first;
+    V second;
+
+    operator std::pair<K, V>() const { return {first, second}; }
+};
+
+/// @brief write `count` records from `[first, first + count)` to a new
+///        sorted-run file at `path`, replacing any file already there
+/// @param convert maps each element to the `Record` to store
+/// @throw std::system_error when the file cannot be written
+template <typename Record, typename It, typename Convert>
+void write_sorted_run(const std::string &path, It first, size_t count, Convert convert)
+{
+    static_assert(std::is_trivially_copyable<Record>::value, "sorted-run records must be trivially copyable");
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::system_error(errno, std::generic_category(), "cannot create " + path);
+    }
+
+    SortedRunHeader header{};
+    std::memcpy(header.magic, SortedRunHeader::MAGIC, sizeof(header.magic));
+    header.version = SortedRunHeader::VERSION;
+    header.byte_order = SortedRunHeader::ORDER_MARK;
+    header.record_size = sizeof(Record);
+    header.record_align = alignof(Record);
+    header.count = count;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // records go through a small buffer rather than one fwrite each
+    constexpr size_t BUFFER_RECORDS = (64 * 1024 + sizeof(Record) - 1) / sizeof(Record);
+    static_assert(sizeof(SortedRunHeader) % alignof(Record) == 0, "record alignment above 32 bytes");
+    std::vector<Record> buffer;
+    buffer.reserve(BUFFER_RECORDS);
+    for (size_t i = 0; ok && i < count; ++i, ++first) {
+        buffer.push_back(convert(*first));
+        if (buffer.size() == BUFFER_RECORDS || i + 1 == count) {
+            ok = std::fwrite(buffer.data(), sizeof(Record), buffer.size(), file) == buffer.size();
+            buffer.clear();
+        }
+    }
+    int error = ok ? 0 : errno;
+    if (std::fclose(file) != 0 && ok) {
+        ok = false;
+        error = errno;
+    }
+    if (!ok) {
+        throw std::system_error(error, std::generic_category(), "cannot write " + path);
+    }
+}
+
+/// @brief read-only memory mapping of a sorted-run file
+/// The records are served straight from the page cache, so opening costs
+/// O(1) regardless of the file size; pages are read in as they are touched.
+template <typename Record>
+class MappedSortedRun
+{
+private:
+    void *_address = nullptr;
+    size_t _length = 0;
+    const Record *_records = nullptr;
+    size_t _count = 0;
+
+    void unmap() {
+        if (_address) {
+            munmap(_address, _length);
+        }
+        _address = nullptr;
+        _length = 0;
+        _records = nullptr;
+        _count = 0;
+    }
+
+public:
+    static_assert(std::is_trivially_copyable<Record>::value, "sorted-run records must be trivially copyable");
+
+    MappedSortedRun() = default;
+
+    /// @brief map the file at `path`
+    /// @throw std::system_error when the file cannot be opened or mapped,
+    ///        std::runtime_error when it is not a sorted run of `Record`
+    explicit MappedSortedRun(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "cannot stat " + path);
+        }
+        _length = static_cast<size_t>(st.st_size);
+        if (_length < sizeof(SortedRunHeader)) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a sorted-run file");
+        }
+        _address = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        ::close(fd); // the mapping keeps the file open
+        if (_address == MAP_FAILED) {
+            _address = nullptr;
+            throw std::system_error(error, std::generic_category(), "cannot map " + path);
+        }
+
+        const SortedRunHeader *header = static_cast<const SortedRunHeader *>(_address);
+        const char *problem = nullptr;
+        if (std::memcmp(header->magic, SortedRunHeader::MAGIC, sizeof(header->magic)) != 0) {
+            problem = " is not a sorted-run file";
+        } else if (header->version != SortedRunHeader::VERSION) {
+            problem = " has an unsupported sorted-run version";
+        } else if (header->byte_order != SortedRunHeader::ORDER_MARK) {
+            problem = " was written with a different byte order";
+        } else if (header->record_size != sizeof(Record) || header->record_align != alignof(Record)) {
+            problem = " holds records of a different type";
+        } else if ((_length - sizeof(SortedRunHeader)) / sizeof(Record) != header->count ||
+                   (_length - sizeof(SortedRunHeader)) % sizeof(Record) != 0) {
+            problem = " is truncated or has trailing bytes";
+        }
+        if (problem) {
+            unmap();
+            throw std::runtime_error(path + problem);
+        }
+        _count = header->count;
+        _records = reinterpret_cast<const Record *>(static_cast<const char *>(_address) + sizeof(SortedRunHeader));
+    }
+
+    MappedSortedRun(const MappedSortedRun &) = delete;
+    MappedSortedRun &operator=(const MappedSortedRun &) = delete;
+
+    MappedSortedRun(MappedSortedRun &&other) noexcept { swap(other); }
+
+    MappedSortedRun &operator=(MappedSortedRun &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedSortedRun() { unmap(); }
+
+    void swap(MappedSortedRun &other) noexcept {
+        std::swap(_address, other._address);
+        std::swap(_length, other._length);
+        std::swap(_records, other._records);
+        std::swap(_count, other._count);
+    }
+
+    /// @brief tell the kernel the records will be read front to back
+    void advise_sequential() const {
+        if (_address) {
+            madvise(_address, _length, MADV_SEQUENTIAL);
+        }
+    }
+
+    const Record *begin() const { return _records; }
+    const Record *end() const { return _records + _count; }
+    const Record &operator[](size_t i) const { return _records[i]; }
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+};
+
+#endif
@@ -9,63 +9,189 @@
 
 
 // Constructor
-template <typename TKey, typename TValue>
-TreeMap<TKey, TValue>::TreeMap() 
-    : _tree([] (const std::pair<TKey, TValue>& a, const std::pair<TKey, TValue>& b) 
-    {
-        if (a.first < b.first) return -1;
-        if (a.first > b.first) return 1;
-        return 0;
-        }) {}
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::TreeMap() : _tree() {}
 
 // Constructor - initial items
-template <typename TKey, typename TValue>
-TreeMap<TKey, TValue>::TreeMap(const std::vector<std::pair<TKey, TValue>>& items) 
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::TreeMap(const std::vector<std::pair<TKey, TValue>>& items) 
     : TreeMap() {
     for (const auto& item : items) {
         insert(item.first, item.second);
     }
 }
 
+// Constructor - key comparator
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::TreeMap(Compare comparator) : _tree(std::move(comparator)) {}
+
+// Constructor - initial items and key comparator
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::TreeMap(const std::vector<std::pair<TKey, TValue>>& items, Compare comparator)
+    : TreeMap(std::move(comparator)) {
+    for (const auto& item : items) {
+        insert(item.first, item.second);
+    }
+}
+
 // returns map elements
-template <typename TKey, typename TValue>
-size_t TreeMap<TKey, TValue>::size() const {
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+size_t TreeMap<TKey, TValue, Compare, Augment, Layout>::size() const {
     return _tree.size();
 }
 
 // Insert a key-value pair into the map
-template <typename TKey, typename TValue>
-void TreeMap<TKey, TValue>::insert(TKey key, TValue value) {
-    //_tree.add(std::make_pair(key, value));
-    std::pair<TKey, TValue> new_pair = std::make_pair(key, value);
-    auto existing = _tree.get(new_pair);
-    if (existing) {
-       // _tree.remove(new_pair);
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::insert(TKey key, TValue value) {
+    insert_or_assign(std::move(key), std::move(value));
+}
+
+// Insert a key-value pair, searching from hint first
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator
+TreeMap<TKey, TValue, Compare, Augment, Layout>::insert(const_iterator hint, TKey key, TValue value) {
+    auto [node, inserted] = _tree.insert_near(_tree.hint_node(hint._node), key, std::move(key), std::move(value));
+    if (!inserted) {
+        node->value.second = std::move(value);
+        Tree::update_path(node);
     }
-      _tree.add(new_pair);
-    
-    
+    return const_iterator(node, &_tree);
 }
 
-// Get key value
-template <typename TKey, typename TValue>
-std::optional<TValue> TreeMap<TKey, TValue>::get(TKey key) const {
+// Construct the value in place unless the key is present
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+std::pair<typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator, bool>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::try_emplace(const TKey &key, Args &&...args) {
+    auto [node, inserted] = _tree.insert_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                                std::forward_as_tuple(std::forward<Args>(args)...));
+    return {const_iterator(node, &_tree), inserted};
+}
+
+// Construct the value in place unless the key is present, moving the key in
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+std::pair<typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator, bool>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::try_emplace(TKey &&key, Args &&...args) {
+    auto [node, inserted] = _tree.insert_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                                std::forward_as_tuple(std::forward<Args>(args)...));
+    return {const_iterator(node, &_tree), inserted};
+}
+
+// Insert the value or overwrite the existing one
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename M>
+std::pair<typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator, bool>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::insert_or_assign(const TKey &key, M &&value) {
+    auto [node, inserted] = _tree.insert_unique(key, key, std::forward<M>(value));
+    if (!inserted) {
+        node->value.second = std::forward<M>(value);
+        Tree::update_path(node);
+    }
+    return {const_iterator(node, &_tree), inserted};
+}
+
+// Insert the value or overwrite the existing one, moving the key in
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename M>
+std::pair<typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator, bool>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::insert_or_assign(TKey &&key, M &&value) {
+    auto [node, inserted] = _tree.insert_unique(key, std::move(key), std::forward<M>(value));
+    if (!inserted) {
+        node->value.second = std::forward<M>(value);
+        Tree::update_path(node);
+    }
+    return {const_iterator(node, &_tree), inserted};
+}
 
-    //std::pair<TKey, TValue> searchPair = {key, TValue()};  //search pair creation
-    auto result = _tree.get(std::make_pair(key, TValue{}));
-    //searchPair);  //using get() from TreeSet
-    return result ? std::optional<TValue>(result->second) : std::nullopt;
+// Find the value, constructing it in place if the key is new
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+TValue &TreeMap<TKey, TValue, Compare, Augment, Layout>::find_or_insert(const TKey &key, Args &&...args) {
+    static_assert(!Augment::reads_values, "values of this map feed its Augment data; use insert_or_assign");
+    return _tree.insert_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                               std::forward_as_tuple(std::forward<Args>(args)...)).first->value.second;
+}
+
+// Find the value, constructing it in place if the key is new, moving the key in
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+TValue &TreeMap<TKey, TValue, Compare, Augment, Layout>::find_or_insert(TKey &&key, Args &&...args) {
+    static_assert(!Augment::reads_values, "values of this map feed its Augment data; use insert_or_assign");
+    return _tree.insert_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...)).first->value.second;
+}
+
+// Value of key, value-initialized if the key is new
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TValue &TreeMap<TKey, TValue, Compare, Augment, Layout>::operator[](const TKey &key) {
+    return find_or_insert(key);
+}
+
+// Value of key, value-initialized if the key is new, moving the key in
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TValue &TreeMap<TKey, TValue, Compare, Augment, Layout>::operator[](TKey &&key) {
+    return find_or_insert(std::move(key));
+}
+
+// Remove a key from the map
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+bool TreeMap<TKey, TValue, Compare, Augment, Layout>::remove(const TKey &key) {
+    if (filter_excludes(key)) return false;
+    auto *node = _tree.find_node(key);
+    if (!node) return false;
+    _tree.erase_node(node);
+    return true;
+}
+
+// Remove the entry at pos
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator TreeMap<TKey, TValue, Compare, Augment, Layout>::erase(const_iterator pos) {
+    return _tree.erase(pos);
+}
+
+// Remove the entries with keys in [lo, hi]
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+size_t TreeMap<TKey, TValue, Compare, Augment, Layout>::erase_range(const TKey &lo, const TKey &hi) {
+    if (_tree._comparator(lo, hi) > 0) return 0;
+    return _tree.erase_between(_tree.bound_node(lo, false), _tree.bound_node(hi, true));
+}
+
+// Get key value
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+std::optional<TValue> TreeMap<TKey, TValue, Compare, Augment, Layout>::get(const TKey &key) const {
+    if (filter_excludes(key)) return std::nullopt;
+    const auto *node = _tree.find_node(key);
+    return node ? std::optional<TValue>(node->value.second) : std::nullopt;
 }
 
 // Check if a key is in the map
-template <typename TKey, typename TValue>
-bool TreeMap<TKey, TValue>::contains(TKey key) const {
-    return _tree.contains(std::make_pair(key, TValue{})); // Use a dummy value for checking
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+bool TreeMap<TKey, TValue, Compare, Augment, Layout>::contains(const TKey &key) const {
+    if (filter_excludes(key)) return false;
+    return _tree.find_node(key) != nullptr;
+}
+
+// Check many keys at once
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::contains_many(const TKey *keys, size_t count, bool *found) const {
+    _tree.find_many(keys, count, [this](const TKey &key) { return filter_excludes(key); },
+                    [found](size_t i, const auto *node) { found[i] = node != nullptr; });
+}
+
+// Get the values of many keys at once
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::get_many(const TKey *keys, size_t count,
+                                                               std::optional<TValue> *results) const {
+    _tree.find_many(keys, count, [this](const TKey &key) { return filter_excludes(key); },
+                    [results](size_t i, const auto *node) {
+        results[i] = node ? std::optional<TValue>(node->value.second) : std::nullopt;
+    });
 }
 
 // Traverse the map in order and return the key-value pairs as a vector
-template <typename TKey, typename TValue>
-std::vector<std::pair<TKey, TValue>> TreeMap<TKey, TValue>::to_vector() const {
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+std::vector<std::pair<TKey, TValue>> TreeMap<TKey, TValue, Compare, Augment, Layout>::to_vector() const {
     //std::vector<std::pair<TKey, TValue>> result;
     //for (const auto &item : _tree.to_vector()) {
       //  result.push_back(item);
@@ -73,19 +199,131 @@ std::vector<std::pair<TKey, TValue>> TreeMap<TKey, TValue>::to_vector() const {
     return _tree.to_vector();
 }
 
+// Write the entries in order to a sorted-run file
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::save(const std::string &path) const {
+    write_sorted_run<SortedRunEntry<TKey, TValue>>(path, _tree.begin(), _tree.size(), [](const std::pair<TKey, TValue> &entry) {
+        return SortedRunEntry<TKey, TValue>{entry.first, entry.second};
+    });
+}
+
+// Map a sorted-run file and bulk-build from it
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::load(const std::string &path, unsigned threads) {
+    MappedSortedRun<SortedRunEntry<TKey, TValue>> run(path);
+    run.advise_sequential();
+    for (size_t i = 1; i < run.size(); ++i) {
+        if (_tree._comparator(run[i - 1].first, run[i].first) >= 0) {
+            throw std::runtime_error(path + " is not strictly increasing under this comparator");
+        }
+    }
+    _tree.build_from_sorted(run.begin(), run.size(), threads);
+}
+
+// Iterator to the smallest key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator TreeMap<TKey, TValue, Compare, Augment, Layout>::begin() const {
+    return _tree.begin();
+}
+
+// Iterator past the largest key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator TreeMap<TKey, TValue, Compare, Augment, Layout>::end() const {
+    return _tree.end();
+}
+
+// First entry with key not less than key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator TreeMap<TKey, TValue, Compare, Augment, Layout>::lower_bound(const TKey &key) const {
+    return const_iterator(_tree.bound_node(key, false), &_tree);
+}
+
+// First entry with key greater than key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator TreeMap<TKey, TValue, Compare, Augment, Layout>::upper_bound(const TKey &key) const {
+    return const_iterator(_tree.bound_node(key, true), &_tree);
+}
+
+// Entries with the given key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+std::pair<typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator, typename TreeMap<TKey, TValue, Compare, Augment, Layout>::const_iterator>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::equal_range(const TKey &key) const {
+    return {lower_bound(key), upper_bound(key)};
+}
+
+// Entries with keys in [lo, hi]
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+typename TreeMap<TKey, TValue, Compare, Augment, Layout>::Range TreeMap<TKey, TValue, Compare, Augment, Layout>::range(const TKey &lo, const TKey &hi) const {
+    if (_tree._comparator(lo, hi) > 0) return Range(end(), end());
+    return Range(lower_bound(lo), upper_bound(hi));
+}
+
+// Number of keys smaller than key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+size_t TreeMap<TKey, TValue, Compare, Augment, Layout>::rank(const TKey &key) const {
+    return _tree.count_before(key, false);
+}
+
+// Entry with the k-th smallest key
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+std::optional<std::pair<TKey, TValue>> TreeMap<TKey, TValue, Compare, Augment, Layout>::select(size_t k) const {
+    return _tree.select(k);
+}
+
+// Number of keys in [lo, hi]
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+size_t TreeMap<TKey, TValue, Compare, Augment, Layout>::count_range(const TKey &lo, const TKey &hi) const {
+    if (_tree._comparator(lo, hi) > 0) return 0;
+    return _tree.count_before(hi, true) - _tree.count_before(lo, false);
+}
+
+// Fold of the values in [lo, hi]
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+auto TreeMap<TKey, TValue, Compare, Augment, Layout>::aggregate(const TKey &lo, const TKey &hi) const {
+    return _tree.aggregate_between(lo, hi);
+}
+
 // Check if the map is empty
-template <typename TKey, typename TValue>
-bool TreeMap<TKey, TValue>::is_empty() const {
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+bool TreeMap<TKey, TValue, Compare, Augment, Layout>::is_empty() const {
     return _tree.is_empty();
 }
 
+// Turns the key filter on
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::enable_filter(double bits_per_key, FilterHash<TKey> hash) {
+    if (!hash.usable()) {
+        throw std::invalid_argument("TreeMap::enable_filter: no std::hash for this key type, pass a hash function");
+    }
+    _key_hash = hash;
+    _tree.enable_filter(bits_per_key, [hash](const std::pair<TKey, TValue> &entry) { return hash(entry.first); });
+}
+
+// Turns the key filter off
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::disable_filter() {
+    _tree.disable_filter();
+}
+
+// Bytes of filter bits
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+size_t TreeMap<TKey, TValue, Compare, Augment, Layout>::filter_bytes() const {
+    return _tree.filter_bytes();
+}
+
+// Whether the filter rules key out
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+bool TreeMap<TKey, TValue, Compare, Augment, Layout>::filter_excludes(const TKey &key) const {
+    return _tree._filter && !_tree._filter->bloom.may_contain(_key_hash(key));
+}
+
 // Clear the map
-template <typename TKey, typename TValue>
-void TreeMap<TKey, TValue>::clear() {
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+void TreeMap<TKey, TValue, Compare, Augment, Layout>::clear() {
     _tree.clear();
 }
 
 // Destructor
-template <typename TKey, typename TValue>
-TreeMap<TKey, TValue>::~TreeMap() = default;
+template <typename TKey, typename TValue, typename Compare, typename Augment, typename Layout>
+TreeMap<TKey, TValue, Compare, Augment, Layout>::~TreeMap() = default;
 #endif
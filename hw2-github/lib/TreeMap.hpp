@@ -5,19 +5,63 @@
 
 #include <cstddef>
 #include <optional>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include "BinaryTreeNode.hpp"
 #include "TreeSet.hpp"
 
-template <typename TKey, typename TValue>
+/// @brief orders map entries by key only, passing both entries by reference
+template <typename TKey, typename TValue, typename Compare>
+class EntryComparator
+{
+private:
+    Compare _key_comparator;
+
+public:
+    EntryComparator(Compare key_comparator = Compare()) : _key_comparator(std::move(key_comparator)) {}
+
+    int operator()(const std::pair<TKey, TValue> &a, const std::pair<TKey, TValue> &b) const {
+        return _key_comparator(a.first, b.first);
+    }
+
+    // bare keys, so lookups never have to build an entry
+    int operator()(const TKey &a, const std::pair<TKey, TValue> &b) const {
+        return _key_comparator(a, b.first);
+    }
+
+    int operator()(const TKey &a, const TKey &b) const {
+        return _key_comparator(a, b);
+    }
+};
+
+/// @tparam TKey type of the keys
+/// @tparam TValue type of the mapped values
+/// @tparam Compare callable `int(const TKey &, const TKey &)` returning -1, 0 or 1
+/// @tparam Augment extra data kept in every node, see Augment.hpp
+/// @tparam Layout how nodes store links and color, see NodeLayout.hpp
+template <typename TKey, typename TValue, typename Compare = DefaultComparator<TKey>, typename Augment = NoAugment,
+          typename Layout = WideNode>
 class TreeMap
 {
 private:
-    TreeSet<std::pair<TKey, TValue>> _tree;
+    using Tree = TreeSet<std::pair<TKey, TValue>, EntryComparator<TKey, TValue, Compare>, Augment, Layout>;
+    Tree _tree;
+    FilterHash<TKey> _key_hash; // hashes lookups for the tree's filter, which hashes entries by key
+
+    /// @brief whether the filter proves that `key` is absent
+    bool filter_excludes(const TKey &key) const;
 
 public:
+    /// @brief bidirectional iterator over the key-value pairs in key order
+    using const_iterator = typename Tree::const_iterator;
+    using iterator = const_iterator;
+    using Range = typename Tree::Range;
+
     TreeMap();
     TreeMap(const std::vector<std::pair<TKey, TValue>> &items);
+    TreeMap(Compare comparator);
+    TreeMap(const std::vector<std::pair<TKey, TValue>> &items, Compare comparator);
 
     /// @brief Returns the number of elements in the map.
     /// @return The number of elements in the map.
@@ -28,24 +72,165 @@ public:
     /// @param value the mapped value of the key
     void insert(TKey key, TValue value);
 
+    /// @brief insert a key-value pair, looking for its place next to `hint` first
+    /// @param hint an iterator to the entry just after or just before where
+    ///        `key` belongs, e.g. `end()` for keys arriving in increasing order
+    /// @return an iterator to the inserted or updated entry
+    /// @note plain `insert` already starts next to the previous insertion, so
+    ///       a hint only helps when the caller knows better
+    const_iterator insert(const_iterator hint, TKey key, TValue value);
+
+    /// @brief insert a value built from `args` if `key` is not in the map yet
+    /// @param key unique key for searching in map
+    /// @param args arguments forwarded to a constructor of `TValue`
+    /// @return an iterator to the entry with `key`, and true if it was inserted
+    /// @note nothing is constructed, moved or copied when `key` already exists
+    template <typename... Args>
+    std::pair<const_iterator, bool> try_emplace(const TKey &key, Args &&...args);
+    template <typename... Args>
+    std::pair<const_iterator, bool> try_emplace(TKey &&key, Args &&...args);
+
+    /// @brief insert `value` under `key`, or assign it to the existing entry
+    /// @return an iterator to the entry with `key`, and true if it was inserted
+    template <typename M>
+    std::pair<const_iterator, bool> insert_or_assign(const TKey &key, M &&value);
+    template <typename M>
+    std::pair<const_iterator, bool> insert_or_assign(TKey &&key, M &&value);
+
+    /// @brief get the value of `key`, inserting one built from `args` if absent
+    /// @param key unique key for searching in map
+    /// @param args arguments forwarded to a constructor of `TValue`, used only
+    ///        when the key is new
+    /// @return a mutable reference to the mapped value
+    /// @note one descent; allocates only when the key is new. Writing through
+    ///       the reference would not refresh `Augment` data derived from
+    ///       values, so maps with such a policy (e.g. `Aggregate`) must use
+    ///       `insert_or_assign` instead.
+    template <typename... Args>
+    TValue &find_or_insert(const TKey &key, Args &&...args);
+    template <typename... Args>
+    TValue &find_or_insert(TKey &&key, Args &&...args);
+
+    /// @brief the value of `key`, value-initialized first if the key is new
+    TValue &operator[](const TKey &key);
+    TValue &operator[](TKey &&key);
+
+    /// @brief remove a key and its value from the map
+    /// @param key the key to remove
+    /// @return true if the key was in the map, otherwise false
+    bool remove(const TKey &key);
+
+    /// @brief remove the entry at `pos`
+    /// @return an iterator to the entry after the removed one
+    const_iterator erase(const_iterator pos);
+
+    /// @brief remove every entry whose key k satisfies lo <= k <= hi
+    /// @return the number of entries removed
+    size_t erase_range(const TKey &lo, const TKey &hi);
+
     /// @brief get the value of a key
     /// @param key unique key for searching in map
     /// @return the mapped value
-    std::optional<TValue> get(TKey key) const;
+    std::optional<TValue> get(const TKey &key) const;
 
     /// @brief check if a key is in the map
     /// @param key unique key to search for
     /// @return true if key is in the map, otherwise false
-    bool contains(TKey key) const;
+    bool contains(const TKey &key) const;
+
+    /// @brief check many keys at once, faster than calling `contains` in a
+    ///        loop on maps that do not fit in cache
+    /// @param keys `count` keys to look for
+    /// @param found receives `count` results, `found[i]` for `keys[i]`
+    /// @note with a filter, the keys it rules out are answered without
+    ///       taking part in the batch
+    void contains_many(const TKey *keys, size_t count, bool *found) const;
+
+    /// @brief get the values of many keys at once, see `contains_many`
+    /// @param keys `count` keys to look for
+    /// @param results receives `count` results, `results[i]` for `keys[i]`
+    void get_many(const TKey *keys, size_t count, std::optional<TValue> *results) const;
 
     /// @brief traverse the map in order and return the values as a vector
     /// @return a sorted vector containing all kv-pair in the map
     std::vector<std::pair<TKey, TValue>> to_vector() const;
 
+    /// @brief write the entries to a sorted-run file (see SortedRun.hpp)
+    /// @param path the file to create or replace
+    /// @note requires `TKey` and `TValue` to be trivially copyable
+    void save(const std::string &path) const;
+
+    /// @brief replace the contents with those of a file written by `save`,
+    ///        mapping it into memory and building the tree in O(n)
+    /// @param path the file to read
+    /// @param threads build on up to this many threads
+    /// @note to serve lookups from the file without building a tree, use
+    ///       `MappedTreeMap`
+    void load(const std::string &path, unsigned threads = 1);
+
+    /// @brief iterator to the entry with the smallest key
+    const_iterator begin() const;
+
+    /// @brief iterator past the entry with the largest key
+    const_iterator end() const;
+
+    /// @brief first entry whose key is not less than `key`
+    /// @param key the key to compare against
+    /// @return an iterator to the entry, or `end()` if there is none
+    const_iterator lower_bound(const TKey &key) const;
+
+    /// @brief first entry whose key is greater than `key`
+    /// @param key the key to compare against
+    /// @return an iterator to the entry, or `end()` if there is none
+    const_iterator upper_bound(const TKey &key) const;
+
+    /// @brief the entries with key `key`, as `{lower_bound, upper_bound}`
+    std::pair<const_iterator, const_iterator> equal_range(const TKey &key) const;
+
+    /// @brief view of the entries whose key k satisfies lo <= k <= hi, in order
+    /// @param lo smallest key of the range
+    /// @param hi largest key of the range
+    /// @return the view; it allocates nothing and walks the tree lazily
+    Range range(const TKey &lo, const TKey &hi) const;
+
+    /// @brief number of keys smaller than `key`
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    size_t rank(const TKey &key) const;
+
+    /// @brief finds the entry with the k-th smallest key
+    /// @param k 0-based position in key order
+    /// @return the entry, or std::nullopt if `k >= size()`
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    std::optional<std::pair<TKey, TValue>> select(size_t k) const;
+
+    /// @brief number of keys k with lo <= k <= hi
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    size_t count_range(const TKey &lo, const TKey &hi) const;
+
+    /// @brief combine the values of the keys k with lo <= k <= hi, in key
+    ///        order, with the monoid of an `Aggregate<Monoid>` policy
+    /// @return a `Monoid::value_type`, the identity if the range is empty
+    /// @note O(log n), e.g. `TreeMap<Timestamp, double, Compare,
+    ///       Aggregate<SumMonoid<double>>>` sums any time window
+    auto aggregate(const TKey &lo, const TKey &hi) const;
+
     /// @brief check if the map is empty
     /// @return true if the map is empty, otherwise false
     bool is_empty() const;
 
+    /// @brief keep a blocked Bloom filter of the keys in front of `get`,
+    ///        `contains` and `remove`, see `TreeSet::enable_filter`
+    /// @param bits_per_key filter size; 10 gives at most about 1% false positives
+    /// @param hash hash of the keys; keys that compare equal must hash equal
+    /// @throw std::invalid_argument if no hash is given and `std::hash<TKey>` does not exist
+    void enable_filter(double bits_per_key = 10, FilterHash<TKey> hash = FilterHash<TKey>());
+
+    /// @brief drop the filter
+    void disable_filter();
+
+    /// @brief bytes of filter bits, or 0 without a filter
+    size_t filter_bytes() const;
+
     /// @brief remove every element in the set
     void clear();
     ~TreeMap();
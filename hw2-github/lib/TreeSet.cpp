@@ -1,108 +1,590 @@
 
 #include "TreeSet.hpp"
+#include "FrozenTreeSet.cpp"
+#include "Parallel.hpp"
 #include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 
 // Constructor
-template <typename T>
-TreeSet<T>::TreeSet() : _root(nullptr), _size(0), _comparator([](T a, T b) { return (a < b) ? -1 : (a > b) ? 1 : 0; }) {}
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet() : _root(nullptr), _comparator(), _size(0) {}
 
-template <typename T>
-TreeSet<T>::TreeSet(const std::vector<T> &items) : TreeSet() {
-    for (const auto &item : items) {
-        add(item);
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet(const std::vector<T> &items) : TreeSet() {
+    assign(items);
+}
+
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet(Compare comparator) : _root(nullptr), _comparator(std::move(comparator)), _size(0) {}
+
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet(const std::vector<T> &items, Compare comparator) : TreeSet(std::move(comparator)) {
+    assign(items);
+}
+
+// Copy constructor
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet(const TreeSet &other) : _root(nullptr), _comparator(other._comparator), _size(other._size) {
+    _pool.reserve(other._size);
+    _root = copy_subtree(other._root, nullptr);
+    if (other._filter) {
+        _filter = std::make_unique<Filter>(*other._filter);
     }
 }
 
-template <typename T>
-TreeSet<T>::TreeSet(std::function<int(T, T)> comparator) : _root(nullptr), _size(0), _comparator(comparator) {}
+// Move constructor
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::TreeSet(TreeSet &&other) noexcept
+    : _root(other._root), _comparator(std::move(other._comparator)), _size(other._size), _pool(std::move(other._pool)),
+      _finger(other._finger), _filter(std::move(other._filter)) {
+    other._root = nullptr;
+    other._finger = nullptr;
+    other._size = 0;
+}
 
-template <typename T>
-TreeSet<T>::TreeSet(const std::vector<T> &items, std::function<int(T, T)> comparator) : TreeSet(comparator) {
-    for (const auto &item : items) {
-        add(item);
+// Copy assignment
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> &TreeSet<T, Compare, Augment, Layout>::operator=(const TreeSet &other) {
+    if (this != &other) {
+        TreeSet copy(other);
+        *this = std::move(copy);
     }
+    return *this;
 }
 
-// Returns the number of elements in the tree
-template <typename T>
-size_t TreeSet<T>::size() const {
-    return _size;
+// Move assignment
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> &TreeSet<T, Compare, Augment, Layout>::operator=(TreeSet &&other) noexcept {
+    if (this != &other) {
+        _filter.reset();
+        clear();
+        _root = other._root;
+        _comparator = std::move(other._comparator);
+        _size = other._size;
+        _pool = std::move(other._pool);
+        _finger = other._finger;
+        _filter = std::move(other._filter);
+        other._root = nullptr;
+        other._finger = nullptr;
+        other._size = 0;
+    }
+    return *this;
 }
 
-// Adds a value to the set
-template <typename T>
-void TreeSet<T>::add(T value) {
-    BinaryTreeNode<T> *z = new BinaryTreeNode<T>(value);
-    //auto newNode = new BinaryTreeNode<T>(value);
-
-    // If the tree is empty, set the root to the new node
-    if (!_root) {
-        _root = z;
-        _size++;
-        return;
+// Builds a node in pool storage, constructing the value in place
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::create_node(Args &&...args) {
+    BinaryTreeNode<T, Augment, Layout> *node =
+        new (_pool.allocate()) BinaryTreeNode<T, Augment, Layout>(std::in_place, std::forward<Args>(args)...);
+    update(node);
+    return node;
+}
+
+// Recomputes augmented data from the children
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::update(BinaryTreeNode<T, Augment, Layout> *node) {
+    using Data = typename Augment::template data<T>;
+    Augment::update(static_cast<Data &>(*node), node->value, static_cast<const Data *>(node->_left),
+                    static_cast<const Data *>(node->_right));
+}
+
+// Recomputes augmented data up to the root
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::update_path(BinaryTreeNode<T, Augment, Layout> *node) {
+    if constexpr (Augment::enabled) {
+        for (; node; node = node->_parent) {
+            update(node);
+        }
     }
+}
 
-    BinaryTreeNode<T> *y = nullptr;
-    BinaryTreeNode<T> *x = _root;
-//finding the correct position for the new value
-    while (x) {
-        y = x;
-        int cmp = _comparator(value, x->value);
-        if (cmp==0) {
-            //key already exists, update the value
-            x->value = value;
-            delete z;
-            return;
+// Size of a subtree
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::subtree_size(const BinaryTreeNode<T, Augment, Layout> *node) {
+    static_assert(Augment::has_subtree_size, "this operation needs an Augment policy with subtree sizes");
+    return node ? node->_subtree_size : 0;
+}
+
+// Aggregate of a subtree
+template <typename T, typename Compare, typename Augment, typename Layout>
+auto TreeSet<T, Compare, Augment, Layout>::subtree_aggregate(const BinaryTreeNode<T, Augment, Layout> *node) {
+    static_assert(Augment::has_aggregate, "this operation needs an Aggregate<Monoid> policy");
+    return node ? node->_aggregate : Augment::monoid::identity();
+}
+
+// Descends to the first node inside [lo, hi], then folds the part of its
+// left subtree at or above lo, the node itself, and the part of its right
+// subtree at or below hi; each part takes one more descent
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+auto TreeSet<T, Compare, Augment, Layout>::aggregate_between(const K &lo, const K &hi) const {
+    using Monoid = typename Augment::monoid;
+    typename Monoid::value_type result = Monoid::identity();
+    const BinaryTreeNode<T, Augment, Layout> *split = _root;
+    while (split) {
+        if (_comparator(lo, split->value) > 0) {
+            split = split->_right;
+        } else if (_comparator(hi, split->value) < 0) {
+            split = split->_left;
+        } else {
+            break;
         }
-        else if (cmp < 0) {
+    }
+    if (!split) return result;
+
+    // elements >= lo in the left subtree: every node at or above lo brings
+    // itself and its right subtree, in front of what was collected so far
+    for (const BinaryTreeNode<T, Augment, Layout> *x = split->_left; x;) {
+        if (_comparator(lo, x->value) <= 0) {
+            result = Monoid::combine(Monoid::combine(Monoid::lift(aggregate_operand(x->value)), subtree_aggregate(x->_right)),
+                                     result);
             x = x->_left;
         } else {
             x = x->_right;
         }
     }
+    result = Monoid::combine(result, Monoid::lift(aggregate_operand(split->value)));
+    // elements <= hi in the right subtree, mirrored
+    typename Monoid::value_type tail = Monoid::identity();
+    for (const BinaryTreeNode<T, Augment, Layout> *x = split->_right; x;) {
+        if (_comparator(hi, x->value) >= 0) {
+            tail = Monoid::combine(tail, Monoid::combine(subtree_aggregate(x->_left), Monoid::lift(aggregate_operand(x->value))));
+            x = x->_right;
+        } else {
+            x = x->_left;
+        }
+    }
+    return Monoid::combine(result, tail);
+}
+
+// Destroys a node and recycles its storage
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::destroy_node(BinaryTreeNode<T, Augment, Layout> *node) {
+    node->~BinaryTreeNode();
+    _pool.deallocate(node);
+}
+
+// Deep copies a subtree, keeping colors and parent links
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::copy_subtree(const BinaryTreeNode<T, Augment, Layout> *node, BinaryTreeNode<T, Augment, Layout> *parent) {
+    if (!node) return nullptr;
+    BinaryTreeNode<T, Augment, Layout> *copy = create_node(node->value);
+    copy->set_color(node->color());
+    copy->_parent = parent;
+    copy->_left = copy_subtree(node->_left, copy);
+    copy->_right = copy_subtree(node->_right, copy);
+    update(copy);
+    return copy;
+}
+
+// Sorts and deduplicates values, then bulk-builds the tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::assign(std::vector<T> values, unsigned threads) {
+    auto less = [this](const T &a, const T &b) { return _comparator(a, b) < 0; };
+    size_t n = values.size();
+    threads = std::max(1u, std::min<unsigned>(threads, n / PARALLEL_GRAIN));
+    if (!std::is_sorted(values.begin(), values.end(), less)) {
+        parallel_stable_sort(values.begin(), values.end(), less, threads);
+    }
+    // keep the last of every run of equal values; the comparisons run on
+    // slices in parallel, moving the survivors down is one sequential pass
+    std::vector<char> keep(n);
+    parallel_for(threads, [&](size_t t) {
+        for (size_t i = n * t / threads; i < n * (t + 1) / threads; ++i) {
+            keep[i] = i + 1 == n || _comparator(values[i], values[i + 1]) != 0;
+        }
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (keep[i]) {
+            if (out != i) values[out] = std::move(values[i]);
+            ++out;
+        }
+    }
+    values.erase(values.begin() + out, values.end());
+    build_from_sorted(values, threads);
+}
+
+// Builds a red-black tree from sorted unique values in linear time
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::build_from_sorted(const std::vector<T> &values, unsigned threads) {
+    build_from_sorted(values.data(), values.size(), threads);
+}
+
+// Builds a red-black tree from a sorted unique array in linear time
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename Source>
+void TreeSet<T, Compare, Augment, Layout>::build_from_sorted(const Source *values, size_t n, unsigned threads) {
+    clear();
+    if (n == 0) return;
+
+    // splitting at the midpoint fills every level but the deepest one, so
+    // coloring just that level red gives equal black heights on all paths
+    int max_depth = 0;
+    while ((size_t(2) << max_depth) - 1 < n) {
+        max_depth++;
+    }
+    bool perfect = (size_t(2) << max_depth) - 1 == n;
+
+    // one block up front, so nodes land in order and every subtree knows
+    // its slots without sharing the pool between threads
+    typename Pool::Block block = _pool.allocate_block(n);
+    _root = build_subtree(values, 0, n, 0, perfect ? -1 : max_depth, nullptr, block, threads);
+    _size = n;
+    if (_filter) {
+        rebuild_filter();
+    }
+}
 
-  
-    //z->_parent = y;  //Set parent
-    if (!y) {
-        _root = z; // Tree was empty
-    } else if (_comparator(value, y->value) < 0) {
-        y->_left = z;
+// Builds the subtree for values[lo, hi)
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename Source>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::build_subtree(const Source *values, size_t lo, size_t hi, int depth,
+                                                      int red_depth, BinaryTreeNode<T, Augment, Layout> *parent,
+                                                      const typename Pool::Block &block, unsigned threads) {
+    if (lo >= hi) return nullptr;
+    size_t mid = lo + (hi - lo) / 2;
+    void *slot = block.slot(mid);
+    BinaryTreeNode<T, Augment, Layout> *node = new (slot) BinaryTreeNode<T, Augment, Layout>(std::in_place, values[mid]);
+    node->set_color((depth == red_depth) ? Red : Black);
+    node->_parent = parent;
+    if (threads > 1 && hi - lo > PARALLEL_GRAIN) {
+        unsigned left_threads = threads / 2;
+        parallel_for(2, [&](size_t half) {
+            if (half == 0) {
+                node->_left = build_subtree(values, lo, mid, depth + 1, red_depth, node, block, left_threads);
+            } else {
+                node->_right = build_subtree(values, mid + 1, hi, depth + 1, red_depth, node, block, threads - left_threads);
+            }
+        });
     } else {
-        y->_right = z;
+        node->_left = build_subtree(values, lo, mid, depth + 1, red_depth, node, block, 1);
+        node->_right = build_subtree(values, mid + 1, hi, depth + 1, red_depth, node, block, 1);
     }
+    update(node);
+    return node;
+}
 
-    _size++;
-    fix_violation(z); //Red-Black tree balancing placeholder
+// Returns the number of elements in the tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::size() const {
+    return _size;
 }
 
-// Check if an element is in the set
-template <typename T>
-bool TreeSet<T>::contains(T value) const {
-    BinaryTreeNode<T> *x = _root;
+// Finds the node equal to key
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::find_node(const K &key) const {
+    BinaryTreeNode<T, Augment, Layout> *x = _root;
     while (x) {
-        int cmp = _comparator(value, x->value);
+        int cmp = _comparator(key, x->value);
         if (cmp == 0) {
-            return true;  //found
-        } else if (cmp < 0) {
-            x = x->_left;
-        } else {
-            x = x->_right;
+            return x;
+        }
+        x = (cmp < 0) ? x->_left : x->_right;
+    }
+    return nullptr;
+}
+
+// Round-robin over BATCH_WIDTH descents, one step each, prefetching the next
+// node of a descent while the others take their steps. Excluded keys are
+// answered as they come up for a lane, so only the rest reach the tree.
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K, typename Excludes, typename Visit>
+void TreeSet<T, Compare, Augment, Layout>::find_many(const K *keys, size_t count, Excludes &&excludes, Visit &&visit) const {
+    struct Lookup {
+        size_t index;
+        const BinaryTreeNode<T, Augment, Layout> *node;
+    };
+    Lookup lanes[BATCH_WIDTH];
+    size_t next = 0;
+    // skips to the next key that has to be looked up, if any is left
+    auto has_next = [&] {
+        while (next < count && excludes(keys[next])) {
+            visit(next++, static_cast<const BinaryTreeNode<T, Augment, Layout> *>(nullptr));
         }
+        return next < count;
+    };
+    size_t active = 0;
+    for (; active < BATCH_WIDTH && has_next(); ++active) {
+        lanes[active] = {next++, _root};
     }
-    return false;  //not found
+    while (active > 0) {
+        for (size_t lane = 0; lane < active;) {
+            Lookup &lookup = lanes[lane];
+            const BinaryTreeNode<T, Augment, Layout> *x = lookup.node;
+            int cmp = x ? _comparator(keys[lookup.index], x->value) : 0;
+            if (cmp == 0) {
+                visit(lookup.index, x);
+                if (has_next()) {
+                    lookup = {next++, _root};
+                    ++lane;
+                } else {
+                    lookup = lanes[--active]; // finish the last lane here next
+                }
+                continue;
+            }
+            x = (cmp < 0) ? x->_left : x->_right;
+#if defined(__GNUC__)
+            __builtin_prefetch(x);
+#endif
+            lookup.node = x;
+            ++lane;
+        }
+    }
+}
+
+// Finds key, or links a new node built from args where it belongs
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K, typename... Args>
+std::pair<BinaryTreeNode<T, Augment, Layout> *, bool> TreeSet<T, Compare, Augment, Layout>::insert_unique(const K &key, Args &&...args) {
+    return insert_near(_finger, key, std::forward<Args>(args)...);
+}
+
+// Tries the gap on key's side of hint, then descends from the root
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K, typename... Args>
+std::pair<BinaryTreeNode<T, Augment, Layout> *, bool>
+TreeSet<T, Compare, Augment, Layout>::insert_near(BinaryTreeNode<T, Augment, Layout> *hint, const K &key, Args &&...args) {
+    if (hint) {
+        int cmp = _comparator(key, hint->value);
+        if (cmp == 0) {
+            _finger = hint;
+            return {hint, false};
+        }
+        // key belongs between the neighbours lo and hi if it is above lo and below hi
+        BinaryTreeNode<T, Augment, Layout> *lo = cmp < 0 ? predecessor(hint) : hint;
+        BinaryTreeNode<T, Augment, Layout> *hi = cmp < 0 ? hint : successor(hint);
+        BinaryTreeNode<T, Augment, Layout> *other = cmp < 0 ? lo : hi;
+        int other_cmp = other ? _comparator(key, other->value) : -cmp;
+        if (other_cmp == 0) {
+            _finger = other;
+            return {other, false};
+        }
+        if ((other_cmp > 0) == (cmp < 0)) {
+            // neighbours: either lo has no right child, or hi is the leftmost
+            // node of lo's right subtree and has no left child
+            if (lo && !lo->_right) {
+                return {insert_at(lo, false, std::forward<Args>(args)...), true};
+            }
+            return {insert_at(hi, true, std::forward<Args>(args)...), true};
+        }
+    }
+
+    BinaryTreeNode<T, Augment, Layout> *y = nullptr;
+    BinaryTreeNode<T, Augment, Layout> *x = _root;
+    int cmp = 0;
+    // find the correct position before allocating, so duplicates cost nothing
+    while (x) {
+        y = x;
+        cmp = _comparator(key, x->value);
+        if (cmp == 0) {
+            _finger = x;
+            return {x, false};
+        }
+        x = (cmp < 0) ? x->_left : x->_right;
+    }
+    // `key` may refer to one of `args`, so it is not used past this point
+    return {insert_at(y, cmp < 0, std::forward<Args>(args)...), true};
+}
+
+// Links a new node below parent, or as the root of an empty tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::insert_at(BinaryTreeNode<T, Augment, Layout> *parent,
+                                                                                    bool left, Args &&...args) {
+    BinaryTreeNode<T, Augment, Layout> *z = create_node(std::forward<Args>(args)...);
+    z->_parent = parent;
+    if (!parent) {
+        _root = z; // tree was empty
+    } else if (left) {
+        parent->_left = z;
+    } else {
+        parent->_right = z;
+    }
+
+    _size++;
+    update_path(parent);
+    fix_violation(z);
+#ifdef TREE_SET_VERIFY_PATHS
+    assert(path_is_valid(z));
+#endif
+    _finger = z;
+    if (_filter) {
+        filter_insert(z->value);
+    }
+    return z;
+}
+
+// Node for a hint iterator
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::hint_node(const BinaryTreeNode<T, Augment, Layout> *hint) const {
+    return hint ? const_cast<BinaryTreeNode<T, Augment, Layout> *>(hint) : last_node();
+}
+
+// Adds a value to the set
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::add(const T &value) {
+    auto [node, inserted] = insert_unique(value, value);
+    if (!inserted) {
+        // key already exists, update the value
+        node->value = value;
+        update_path(node);
+    }
+}
+
+// Adds a value to the set, moving it into the tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::add(T &&value) {
+    auto [node, inserted] = insert_unique(value, std::move(value));
+    if (!inserted) {
+        node->value = std::move(value);
+        update_path(node);
+    }
+}
+
+// Adds a value, searching from hint first
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::add(const_iterator hint, const T &value) {
+    auto [node, inserted] = insert_near(hint_node(hint._node), value, value);
+    if (!inserted) {
+        node->value = value;
+        update_path(node);
+    }
+    return const_iterator(node, this);
+}
+
+// Adds a value, searching from hint first and moving it into the tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::add(const_iterator hint, T &&value) {
+    auto [node, inserted] = insert_near(hint_node(hint._node), value, std::move(value));
+    if (!inserted) {
+        node->value = std::move(value);
+        update_path(node);
+    }
+    return const_iterator(node, this);
+}
+
+// Builds a node from args, then searches with its value and links it
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename... Args>
+void TreeSet<T, Compare, Augment, Layout>::emplace(Args &&...args) {
+    BinaryTreeNode<T, Augment, Layout> *built = create_node(std::forward<Args>(args)...);
+    std::pair<BinaryTreeNode<T, Augment, Layout> *, bool> result;
+    try {
+        result = insert_unique(built->value, BuiltNode{built});
+    } catch (...) {
+        destroy_node(built);
+        throw;
+    }
+    if (!result.second) {
+        if constexpr (std::is_move_assignable<T>::value) {
+            result.first->value = std::move(built->value);
+            update_path(result.first);
+        }
+        destroy_node(built);
+    }
+}
+
+// Removes a value from the set
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::remove(const T &value) {
+    if (filter_excludes(value)) return false;
+    BinaryTreeNode<T, Augment, Layout> *z = find_node(value);
+    if (!z) return false;
+    erase_node(z);
+    return true;
+}
+
+// Removes the element equal to key
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, bool> TreeSet<T, Compare, Augment, Layout>::remove(const K &key) {
+    BinaryTreeNode<T, Augment, Layout> *z = find_node(key);
+    if (!z) return false;
+    erase_node(z);
+    return true;
+}
+
+// Removes the element at pos
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::erase(const_iterator pos) {
+    BinaryTreeNode<T, Augment, Layout> *z = const_cast<BinaryTreeNode<T, Augment, Layout> *>(pos._node);
+    // nodes are relinked rather than copied, so the successor stays valid
+    BinaryTreeNode<T, Augment, Layout> *next = successor(z);
+    erase_node(z);
+    return const_iterator(next, this);
+}
+
+// Removes every element in [lo, hi]
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::erase_range(const T &lo, const T &hi) {
+    if (_comparator(lo, hi) > 0) return 0;
+    return erase_between(bound_node(lo, false), bound_node(hi, true));
+}
+
+// Removes the nodes from first up to, but not including, last: cuts the tree
+// just before first and at last, drops the middle and joins the outer parts
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::erase_between(BinaryTreeNode<T, Augment, Layout> *first, BinaryTreeNode<T, Augment, Layout> *last) {
+    if (first == last) return 0;
+    SplitParts at_first = split_tree({_root, black_height(_root)}, first->value);
+    Subtree kept = at_first.greater;
+    Subtree middle = kept;
+    if (last) {
+        SplitParts at_last = split_tree(kept, last->value);
+        middle = at_last.less;
+        kept = join_trees({nullptr, 0}, at_last.equal, at_last.greater);
+    } else {
+        kept = {nullptr, 0};
+    }
+    size_t removed = destroy_subtree(at_first.equal) + destroy_subtree(middle.root);
+    _root = join_trees(at_first.less, kept).root;
+    _finger = nullptr;
+    _size -= removed;
+    if (_filter) {
+        filter_remove(removed);
+    }
+    return removed;
+}
+
+// Check if an element is in the set
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::contains(const T &value) const {
+    if (filter_excludes(value)) return false;
+    return find_node(value) != nullptr;
+}
+
+// Check if an element equal to key is in the set
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, bool> TreeSet<T, Compare, Augment, Layout>::contains(const K &key) const {
+    return find_node(key) != nullptr;
+}
+
+// Check many elements at once
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::contains_many(const T *values, size_t count, bool *found) const {
+    find_many(values, count, [this](const T &value) { return filter_excludes(value); },
+              [found](size_t i, const BinaryTreeNode<T, Augment, Layout> *node) { found[i] = node != nullptr; });
 }
 
 // Check if the set is empty
-template <typename T>
-bool TreeSet<T>::is_empty() const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::is_empty() const {
     return _size == 0;
 }
 
 // Search for the smallest value in the set
-template <typename T>
-std::optional<T> TreeSet<T>::min() const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::optional<T> TreeSet<T, Compare, Augment, Layout>::min() const {
     if (!_root) return std::nullopt;
-    BinaryTreeNode<T> *current = _root;
+    BinaryTreeNode<T, Augment, Layout> *current = _root;
     while (current->_left) {
         current = current->_left;
     }
@@ -110,10 +592,10 @@ std::optional<T> TreeSet<T>::min() const {
 }
 
 // Search for the largest value in the set
-template <typename T>
-std::optional<T> TreeSet<T>::max() const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::optional<T> TreeSet<T, Compare, Augment, Layout>::max() const {
     if (!_root) return std::nullopt;
-    BinaryTreeNode<T> *current = _root;
+    BinaryTreeNode<T, Augment, Layout> *current = _root;
     while (current->_right) {
         current = current->_right;
     }
@@ -121,118 +603,954 @@ std::optional<T> TreeSet<T>::max() const {
 }
 
 // Traverse the set in order and return the values as a vector
-template <typename T>
-std::vector<T> TreeSet<T>::to_vector() const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::vector<T> TreeSet<T, Compare, Augment, Layout>::to_vector() const {
     std::vector<T> result;
-    std::function<void(BinaryTreeNode<T> *)> in_order = [&](BinaryTreeNode<T>* node) {
-        if (node) {
-            in_order(node->_left);
-            result.push_back(node->value);
-            in_order(node->_right);
+    result.reserve(_size);
+    for (const T &value : *this) {
+        result.push_back(value);
+    }
+    return result;
+}
+
+// Collects whole subtrees at split_depth and the single nodes above them, in order
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::split_pieces(const BinaryTreeNode<T, Augment, Layout> *node, int depth, int split_depth,
+                                                std::vector<std::pair<const BinaryTreeNode<T, Augment, Layout> *, bool>> &pieces) {
+    if (!node) return;
+    if (depth == split_depth) {
+        pieces.push_back({node, true});
+        return;
+    }
+    split_pieces(node->_left, depth + 1, split_depth, pieces);
+    pieces.push_back({node, false});
+    split_pieces(node->_right, depth + 1, split_depth, pieces);
+}
+
+// Splits the top of the tree into subtrees and exports them concurrently
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::vector<T> TreeSet<T, Compare, Augment, Layout>::to_vector(unsigned threads) const {
+    threads = std::min<unsigned>(threads, _size / PARALLEL_GRAIN);
+    if (threads <= 1) return to_vector();
+
+    // about four subtrees per thread evens out their differing sizes
+    int split_depth = 2;
+    while ((size_t(1) << split_depth) < 4 * size_t(threads)) split_depth++;
+    std::vector<std::pair<const BinaryTreeNode<T, Augment, Layout> *, bool>> pieces;
+    split_pieces(_root, 0, split_depth, pieces);
+    auto first_piece = [&](size_t t) { return pieces.size() * t / threads; };
+
+    // without subtree sizes, count every subtree first to find its offset
+    std::vector<size_t> offsets(pieces.size() + 1, 0);
+    parallel_for(threads, [&](size_t t) {
+        for (size_t i = first_piece(t); i < first_piece(t + 1); ++i) {
+            const BinaryTreeNode<T, Augment, Layout> *node = pieces[i].first;
+            if (!pieces[i].second) {
+                offsets[i + 1] = 1;
+            } else if constexpr (Augment::has_subtree_size) {
+                offsets[i + 1] = subtree_size(node);
+            } else {
+                const BinaryTreeNode<T, Augment, Layout> *first = node, *last = node;
+                while (first->_left) first = first->_left;
+                while (last->_right) last = last->_right;
+                size_t count = 1;
+                for (const BinaryTreeNode<T, Augment, Layout> *x = first; x != last; x = successor(x)) count++;
+                offsets[i + 1] = count;
+            }
         }
-    };
-    in_order(_root);
+    });
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    std::vector<T> result(_size);
+    parallel_for(threads, [&](size_t t) {
+        for (size_t i = first_piece(t); i < first_piece(t + 1); ++i) {
+            const BinaryTreeNode<T, Augment, Layout> *node = pieces[i].first;
+            T *out = result.data() + offsets[i];
+            if (!pieces[i].second) {
+                *out = node->value;
+                continue;
+            }
+            const BinaryTreeNode<T, Augment, Layout> *first = node, *last = node;
+            while (first->_left) first = first->_left;
+            while (last->_right) last = last->_right;
+            for (const BinaryTreeNode<T, Augment, Layout> *x = first;; x = successor(x)) {
+                *out++ = x->value;
+                if (x == last) break;
+            }
+        }
+    });
     return result;
 }
 
+// Replaces the contents, sorting and building on several threads
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::build(const std::vector<T> &items, unsigned threads) {
+    assign(items, threads);
+}
+
+// Freeze into a flat Eytzinger array
+template <typename T, typename Compare, typename Augment, typename Layout>
+FrozenTreeSet<T, Compare> TreeSet<T, Compare, Augment, Layout>::freeze() const {
+    return FrozenTreeSet<T, Compare>(to_vector(), _comparator);
+}
+
+// Writes the elements in order to a sorted-run file
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::save(const std::string &path) const {
+    write_sorted_run<T>(path, begin(), _size, [](const T &value) -> const T & { return value; });
+}
+
+// Maps a sorted-run file and bulk-builds from it
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::load(const std::string &path, unsigned threads) {
+    MappedSortedRun<T> run(path);
+    run.advise_sequential();
+    // the build trusts the order, so a file saved under another comparator
+    // must not get past this point
+    for (size_t i = 1; i < run.size(); ++i) {
+        if (_comparator(run[i - 1], run[i]) >= 0) {
+            throw std::runtime_error(path + " is not strictly increasing under this comparator");
+        }
+    }
+    build_from_sorted(run.begin(), run.size(), threads);
+}
+
+// Iterator to the smallest element
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::begin() const {
+    return const_iterator(first_node(), this);
+}
+
+// Iterator past the largest element
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::end() const {
+    return const_iterator(nullptr, this);
+}
+
+// First node not less than (or greater than, if strict) value
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::bound_node(const K &value, bool strict) const {
+    BinaryTreeNode<T, Augment, Layout> *x = _root;
+    BinaryTreeNode<T, Augment, Layout> *candidate = nullptr;
+    while (x) {
+        int cmp = _comparator(value, x->value);
+        if (cmp < 0 || (cmp == 0 && !strict)) {
+            candidate = x;
+            x = x->_left;
+        } else {
+            x = x->_right;
+        }
+    }
+    return candidate;
+}
+
+// First element not less than value
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::lower_bound(const T &value) const {
+    return const_iterator(bound_node(value, false), this);
+}
+
+// First element greater than value
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::const_iterator TreeSet<T, Compare, Augment, Layout>::upper_bound(const T &value) const {
+    return const_iterator(bound_node(value, true), this);
+}
+
+// First element not less than key
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, typename TreeSet<T, Compare, Augment, Layout>::const_iterator>
+TreeSet<T, Compare, Augment, Layout>::lower_bound(const K &key) const {
+    return const_iterator(bound_node(key, false), this);
+}
+
+// First element greater than key
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, typename TreeSet<T, Compare, Augment, Layout>::const_iterator>
+TreeSet<T, Compare, Augment, Layout>::upper_bound(const K &key) const {
+    return const_iterator(bound_node(key, true), this);
+}
+
+// Elements equal to value
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::pair<typename TreeSet<T, Compare, Augment, Layout>::const_iterator, typename TreeSet<T, Compare, Augment, Layout>::const_iterator>
+TreeSet<T, Compare, Augment, Layout>::equal_range(const T &value) const {
+    return {lower_bound(value), upper_bound(value)};
+}
+
+// Elements in [lo, hi]
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Range TreeSet<T, Compare, Augment, Layout>::range(const T &lo, const T &hi) const {
+    if (_comparator(lo, hi) > 0) return Range(end(), end());
+    return Range(lower_bound(lo), upper_bound(hi));
+}
+
 // Finds a value and returns it
-template <typename T>
-std::optional<T> TreeSet<T>::get(T value) const {
-    BinaryTreeNode<T> *x = _root;
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::optional<T> TreeSet<T, Compare, Augment, Layout>::get(const T &value) const {
+    if (filter_excludes(value)) return std::nullopt;
+    const BinaryTreeNode<T, Augment, Layout> *x = find_node(value);
+    if (!x) return std::nullopt;
+    return x->value;
+}
+
+// Finds the element equal to key and returns it
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, std::optional<T>> TreeSet<T, Compare, Augment, Layout>::get(const K &key) const {
+    const BinaryTreeNode<T, Augment, Layout> *x = find_node(key);
+    if (!x) return std::nullopt;
+    return x->value;
+}
+
+// Finds many values at once
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::get_many(const T *values, size_t count, std::optional<T> *results) const {
+    find_many(values, count, [this](const T &value) { return filter_excludes(value); },
+              [results](size_t i, const BinaryTreeNode<T, Augment, Layout> *node) {
+        results[i] = node ? std::optional<T>(node->value) : std::nullopt;
+    });
+}
+
+// Turns the filter on, built from the current elements
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::enable_filter(double bits_per_element, FilterHash<T> hash) {
+    if (!hash.usable()) {
+        throw std::invalid_argument("TreeSet::enable_filter: no std::hash for this type, pass a hash function");
+    }
+    _filter = std::make_unique<Filter>(Filter{BlockedBloomFilter(), std::move(hash), bits_per_element, 0});
+    rebuild_filter();
+}
+
+// Turns the filter off
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::disable_filter() {
+    _filter.reset();
+}
+
+// Bytes of filter bits
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::filter_bytes() const {
+    return _filter ? _filter->bloom.bytes() : 0;
+}
+
+// Refills the filter with room for the set to double
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::rebuild_filter() {
+    _filter->bloom.reset(std::max<size_t>(2 * _size, 64), _filter->bits_per_element);
+    _filter->stale = 0;
+    for (const BinaryTreeNode<T, Augment, Layout> *node = first_node(); node; node = successor(node)) {
+        _filter->bloom.insert(_filter->hash(node->value));
+    }
+}
+
+// Adds to the filter, rebuilding it when full
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::filter_insert(const T &value) {
+    if (_filter->bloom.count() >= _filter->bloom.capacity()) {
+        rebuild_filter(); // includes `value` when it is already in the tree
+    } else {
+        _filter->bloom.insert(_filter->hash(value));
+    }
+}
+
+// Counts stale filter bits, rebuilding once most of the filter is stale
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::filter_remove(size_t count) {
+    _filter->stale += count;
+    if (_filter->stale > _size && _filter->stale > 64) {
+        rebuild_filter();
+    }
+}
+
+// Whether the filter rules value out
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::filter_excludes(const T &value) const {
+    return _filter && !_filter->bloom.may_contain(_filter->hash(value));
+}
+
+// Leftmost node
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::first_node() const {
+    BinaryTreeNode<T, Augment, Layout> *node = _root;
+    while (node && node->_left) {
+        node = node->_left;
+    }
+    return node;
+}
+
+// In-order successor
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::successor(const BinaryTreeNode<T, Augment, Layout> *node) {
+    if (node->_right) {
+        node = node->_right;
+        while (node->_left) {
+            node = node->_left;
+        }
+        return const_cast<BinaryTreeNode<T, Augment, Layout> *>(node);
+    }
+    while (node->_parent && node == node->_parent->_right) {
+        node = node->_parent;
+    }
+    return node->_parent;
+}
+
+// Rightmost node
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::last_node() const {
+    BinaryTreeNode<T, Augment, Layout> *node = _root;
+    while (node && node->_right) {
+        node = node->_right;
+    }
+    return node;
+}
+
+// In-order predecessor
+template <typename T, typename Compare, typename Augment, typename Layout>
+BinaryTreeNode<T, Augment, Layout> *TreeSet<T, Compare, Augment, Layout>::predecessor(const BinaryTreeNode<T, Augment, Layout> *node) {
+    if (node->_left) {
+        node = node->_left;
+        while (node->_right) {
+            node = node->_right;
+        }
+        return const_cast<BinaryTreeNode<T, Augment, Layout> *>(node);
+    }
+    while (node->_parent && node == node->_parent->_left) {
+        node = node->_parent;
+    }
+    return node->_parent;
+}
+
+// Lockstep in-order walk over both sets
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::vector<T> TreeSet<T, Compare, Augment, Layout>::merge(const TreeSet &other, SetOperation op) const {
+    bool keep_left = op != SetOperation::Intersection;
+    bool keep_right = op == SetOperation::Union || op == SetOperation::SymmetricDifference;
+
+    std::vector<T> result;
+    result.reserve(op == SetOperation::Intersection ? std::min(_size, other._size)
+                   : op == SetOperation::Difference ? _size
+                                                    : _size + other._size);
+
+    const BinaryTreeNode<T, Augment, Layout> *a = first_node();
+    const BinaryTreeNode<T, Augment, Layout> *b = other.first_node();
+    while (a && b) {
+        int cmp = _comparator(a->value, b->value);
+        if (cmp < 0) {
+            if (keep_left) result.push_back(a->value);
+            a = successor(a);
+        } else if (cmp > 0) {
+            if (keep_right) result.push_back(b->value);
+            b = successor(b);
+        } else {
+            if (op == SetOperation::Union) {
+                result.push_back(b->value);
+            } else if (op == SetOperation::Intersection) {
+                result.push_back(a->value);
+            }
+            a = successor(a);
+            b = successor(b);
+        }
+    }
+    for (; a && keep_left; a = successor(a)) {
+        result.push_back(a->value);
+    }
+    for (; b && keep_right; b = successor(b)) {
+        result.push_back(b->value);
+    }
+    return result;
+}
+
+// Picks between per-element work and merging for lopsided operands
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::prefer_probing(size_t small_size, size_t large_size) {
+    size_t depth = 1;
+    for (size_t n = large_size; n > 1; n >>= 1) {
+        depth++;
+    }
+    return small_size * depth < small_size + large_size;
+}
+
+// Black nodes on the leftmost path
+template <typename T, typename Compare, typename Augment, typename Layout>
+int TreeSet<T, Compare, Augment, Layout>::black_height(const BinaryTreeNode<T, Augment, Layout> *node) {
+    int height = 0;
+    for (; node; node = node->_left) {
+        if (node->color() == Black) height++;
+    }
+    return height;
+}
+
+// Unlinks a child and blackens it into a standalone tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::detach(BinaryTreeNode<T, Augment, Layout> *node,
+                                                                                            int black_height) {
+    if (!node) return {nullptr, 0};
+    node->_parent = nullptr;
+    if (node->color() == Red) {
+        node->set_color(Black);
+        black_height++;
+    }
+    return {node, black_height};
+}
+
+// Hangs pivot on the spine of the taller tree at the shorter one's black
+// height, then rebalances upwards as after an insert
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::join_trees(Subtree left,
+                                                                                                BinaryTreeNode<T, Augment, Layout> *pivot,
+                                                                                                Subtree right) {
+    if (left.black_height == right.black_height) {
+        pivot->_left = left.root;
+        pivot->_right = right.root;
+        pivot->_parent = nullptr;
+        pivot->set_color(Black);
+        if (left.root) left.root->_parent = pivot;
+        if (right.root) right.root->_parent = pivot;
+        update(pivot);
+        return {pivot, left.black_height + 1};
+    }
+
+    bool left_taller = left.black_height > right.black_height;
+    Subtree tall = left_taller ? left : right;
+    Subtree shorter = left_taller ? right : left;
+
+    // walk down the inner spine of the taller tree to the first black node
+    // (or nil) whose black height matches the shorter tree
+    BinaryTreeNode<T, Augment, Layout> *parent = nullptr;
+    BinaryTreeNode<T, Augment, Layout> *node = tall.root;
+    int height = tall.black_height;
+    while (node && !(node->color() == Black && height == shorter.black_height)) {
+        if (node->color() == Black) height--;
+        parent = node;
+        node = left_taller ? node->_right : node->_left;
+    }
+
+    pivot->set_color(Red);
+    pivot->_parent = parent;
+    if (left_taller) {
+        pivot->_left = node;
+        pivot->_right = shorter.root;
+        parent->_right = pivot;
+    } else {
+        pivot->_left = shorter.root;
+        pivot->_right = node;
+        parent->_left = pivot;
+    }
+    if (node) node->_parent = pivot;
+    if (shorter.root) shorter.root->_parent = pivot;
+    update(pivot);
+    update_path(parent);
+
+    BinaryTreeNode<T, Augment, Layout> *root = tall.root;
+    bool grew = fix_violation(root, pivot);
+    return {root, tall.black_height + (grew ? 1 : 0)};
+}
+
+// Joins two trees, using the largest node of left as the pivot
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::join_trees(Subtree left, Subtree right) const {
+    if (!left.root) return right;
+    if (!right.root) return left;
+    BinaryTreeNode<T, Augment, Layout> *last = left.root;
+    while (last->_right) {
+        last = last->_right;
+    }
+    SplitParts parts = split_tree(left, last->value);
+    return join_trees(parts.less, parts.equal, right);
+}
+
+// Cuts below the root on the key's side and joins the root back onto the
+// other side; the joins along the way cost O(log n) in total, as each
+// one's cost is the difference of black heights it bridges
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::SplitParts TreeSet<T, Compare, Augment, Layout>::split_tree(Subtree tree,
+                                                                                                   const K &key) const {
+    if (!tree.root) return {{nullptr, 0}, nullptr, {nullptr, 0}};
+    BinaryTreeNode<T, Augment, Layout> *node = tree.root;
+    Subtree left = detach(node->_left, tree.black_height - 1);
+    Subtree right = detach(node->_right, tree.black_height - 1);
+    node->_left = nullptr;
+    node->_right = nullptr;
+
+    int cmp = _comparator(key, node->value);
+    if (cmp == 0) {
+        return {left, node, right};
+    } else if (cmp < 0) {
+        SplitParts parts = split_tree(left, key);
+        return {parts.less, parts.equal, join_trees(parts.greater, node, right)};
+    } else {
+        SplitParts parts = split_tree(right, key);
+        return {join_trees(left, node, parts.less), parts.equal, parts.greater};
+    }
+}
+
+// Splits a at b's root and unites the halves, concurrently when both are large
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::unite_trees(
+    Subtree a, Subtree b, unsigned threads, std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const {
+    if (!b.root) return a;
+    if (!a.root) return b;
+    BinaryTreeNode<T, Augment, Layout> *pivot = b.root;
+    if (!pivot->_left && !pivot->_right) {
+        // a single element is cheaper to insert with one descent than to split on
+        BinaryTreeNode<T, Augment, Layout> *parent = nullptr;
+        BinaryTreeNode<T, Augment, Layout> *node = a.root;
+        int cmp = 0;
+        while (node) {
+            cmp = _comparator(pivot->value, node->value);
+            if (cmp == 0) {
+                node->value = std::move(pivot->value);
+                update_path(node);
+                dropped.push_back(pivot);
+                return a;
+            }
+            parent = node;
+            node = cmp < 0 ? node->_left : node->_right;
+        }
+        pivot->set_color(Red);
+        pivot->_parent = parent;
+        (cmp < 0 ? parent->_left : parent->_right) = pivot;
+        update_path(pivot);
+        bool grew = fix_violation(a.root, pivot);
+        return {a.root, a.black_height + (grew ? 1 : 0)};
+    }
+    Subtree b_left = detach(pivot->_left, b.black_height - 1);
+    Subtree b_right = detach(pivot->_right, b.black_height - 1);
+    SplitParts parts = split_tree(a, pivot->value);
+    if (parts.equal) dropped.push_back(parts.equal);
+
+    Subtree left, right;
+    if (threads > 1 && std::min(a.black_height, b.black_height) >= PARALLEL_BLACK_HEIGHT) {
+        std::vector<BinaryTreeNode<T, Augment, Layout> *> right_dropped;
+        unsigned left_threads = threads / 2;
+        parallel_for(2, [&](size_t half) {
+            if (half == 0) {
+                left = unite_trees(parts.less, b_left, left_threads, dropped);
+            } else {
+                right = unite_trees(parts.greater, b_right, threads - left_threads, right_dropped);
+            }
+        });
+        dropped.insert(dropped.end(), right_dropped.begin(), right_dropped.end());
+    } else {
+        left = unite_trees(parts.less, b_left, 1, dropped);
+        right = unite_trees(parts.greater, b_right, 1, dropped);
+    }
+    return join_trees(left, pivot, right);
+}
+
+// Splits a at b's root and intersects the halves with b's subtrees
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::intersect_trees(
+    Subtree a, const BinaryTreeNode<T, Augment, Layout> *b, unsigned threads,
+    std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const {
+    if (!a.root) return a;
+    if (!b) {
+        dropped.push_back(a.root);
+        return {nullptr, 0};
+    }
+    SplitParts parts = split_tree(a, b->value);
+
+    Subtree left, right;
+    if (threads > 1 && a.black_height >= PARALLEL_BLACK_HEIGHT) {
+        std::vector<BinaryTreeNode<T, Augment, Layout> *> right_dropped;
+        unsigned left_threads = threads / 2;
+        parallel_for(2, [&](size_t half) {
+            if (half == 0) {
+                left = intersect_trees(parts.less, b->_left, left_threads, dropped);
+            } else {
+                right = intersect_trees(parts.greater, b->_right, threads - left_threads, right_dropped);
+            }
+        });
+        dropped.insert(dropped.end(), right_dropped.begin(), right_dropped.end());
+    } else {
+        left = intersect_trees(parts.less, b->_left, 1, dropped);
+        right = intersect_trees(parts.greater, b->_right, 1, dropped);
+    }
+    return parts.equal ? join_trees(left, parts.equal, right) : join_trees(left, right);
+}
+
+// Splits a at b's root and subtracts b's subtrees from the halves
+template <typename T, typename Compare, typename Augment, typename Layout>
+typename TreeSet<T, Compare, Augment, Layout>::Subtree TreeSet<T, Compare, Augment, Layout>::subtract_trees(
+    Subtree a, const BinaryTreeNode<T, Augment, Layout> *b, unsigned threads,
+    std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const {
+    if (!a.root || !b) return a;
+    SplitParts parts = split_tree(a, b->value);
+    if (parts.equal) dropped.push_back(parts.equal);
+
+    Subtree left, right;
+    if (threads > 1 && a.black_height >= PARALLEL_BLACK_HEIGHT) {
+        std::vector<BinaryTreeNode<T, Augment, Layout> *> right_dropped;
+        unsigned left_threads = threads / 2;
+        parallel_for(2, [&](size_t half) {
+            if (half == 0) {
+                left = subtract_trees(parts.less, b->_left, left_threads, dropped);
+            } else {
+                right = subtract_trees(parts.greater, b->_right, threads - left_threads, right_dropped);
+            }
+        });
+        dropped.insert(dropped.end(), right_dropped.begin(), right_dropped.end());
+    } else {
+        left = subtract_trees(parts.less, b->_left, 1, dropped);
+        right = subtract_trees(parts.greater, b->_right, 1, dropped);
+    }
+    return join_trees(left, right);
+}
+
+// Destroys a detached subtree
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::destroy_subtree(BinaryTreeNode<T, Augment, Layout> *node) {
+    if (!node) return 0;
+    size_t count = destroy_subtree(node->_left) + destroy_subtree(node->_right) + 1;
+    destroy_node(node);
+    return count;
+}
+
+// Counts the elements before value
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+size_t TreeSet<T, Compare, Augment, Layout>::count_before(const K &value, bool inclusive) const {
+    size_t count = 0;
+    const BinaryTreeNode<T, Augment, Layout> *x = _root;
     while (x) {
         int cmp = _comparator(value, x->value);
-        if (cmp == 0) {
-            return x->value;
-        } else if (cmp < 0) {
+        if (cmp < 0 || (cmp == 0 && !inclusive)) {
+            x = x->_left;
+        } else {
+            count += subtree_size(x->_left) + 1;
+            x = x->_right;
+        }
+    }
+    return count;
+}
+
+// Number of elements smaller than value
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::rank(const T &value) const {
+    return count_before(value, false);
+}
+
+// Number of elements smaller than key
+template <typename T, typename Compare, typename Augment, typename Layout>
+template <typename K>
+typename TreeSet<T, Compare, Augment, Layout>::template KeyLookup<K, size_t> TreeSet<T, Compare, Augment, Layout>::rank(const K &key) const {
+    return count_before(key, false);
+}
+
+// K-th smallest element
+template <typename T, typename Compare, typename Augment, typename Layout>
+std::optional<T> TreeSet<T, Compare, Augment, Layout>::select(size_t k) const {
+    const BinaryTreeNode<T, Augment, Layout> *x = _root;
+    while (x) {
+        size_t left_size = subtree_size(x->_left);
+        if (k < left_size) {
             x = x->_left;
+        } else if (k == left_size) {
+            return x->value;
         } else {
+            k -= left_size + 1;
             x = x->_right;
         }
     }
     return std::nullopt;
 }
 
-// Set union
-template <typename T>
-TreeSet<T> TreeSet<T>::operator+(const TreeSet &other) {
-   // TreeSet<T> result(*this);
-   TreeSet<T> result(_comparator);  //create a new TreeSet with the same comparator
-    //for (const T &item : other.to_vector()) {
+// Number of elements in [lo, hi]
+template <typename T, typename Compare, typename Augment, typename Layout>
+size_t TreeSet<T, Compare, Augment, Layout>::count_range(const T &lo, const T &hi) const {
+    if (_comparator(lo, hi) > 0) return 0;
+    return count_before(hi, true) - count_before(lo, false);
+}
 
-// add all elements from the set
-    for (const auto &value : to_vector()) {
-        result.add(value);
+// Fold of [lo, hi]
+template <typename T, typename Compare, typename Augment, typename Layout>
+auto TreeSet<T, Compare, Augment, Layout>::aggregate(const T &lo, const T &hi) const {
+    return aggregate_between(lo, hi);
+}
+
+// Cuts the tree at key and copies the smaller part into storage of its own
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::split(const T &key) {
+    TreeSet result(_comparator);
+    if (!_root) return result;
+    SplitParts parts = split_tree({_root, black_height(_root)}, key);
+    Subtree less = parts.less;
+    Subtree greater = parts.equal ? join_trees({nullptr, 0}, parts.equal, parts.greater) : parts.greater;
+    _finger = nullptr;
+
+    // count both parts in lockstep, so only the smaller one is walked to its end
+    auto leftmost = [](BinaryTreeNode<T, Augment, Layout> *node) {
+        while (node && node->_left) node = node->_left;
+        return node;
+    };
+    const BinaryTreeNode<T, Augment, Layout> *a = leftmost(less.root);
+    const BinaryTreeNode<T, Augment, Layout> *b = leftmost(greater.root);
+    size_t steps = 0;
+    for (; a && b; a = successor(a), b = successor(b)) {
+        steps++;
     }
 
-    // Add all elements from the other set and COMMENT THIS
-    for (const auto &value : other.to_vector()) {
-        result.add(value);
+    if (!b) {
+        // the greater part is the smaller one: copy it out
+        result._pool.reserve(steps);
+        result._root = result.copy_subtree(greater.root, nullptr);
+        result._size = steps;
+        destroy_subtree(greater.root);
+        _root = less.root;
+        _size -= steps;
+    } else {
+        // the less part is the smaller one: hand the storage to the result
+        // and copy the less part into fresh storage for this set
+        result._pool = std::move(_pool);
+        result._root = greater.root;
+        result._size = _size - steps;
+        _pool.reserve(steps);
+        _root = copy_subtree(less.root, nullptr);
+        _size = steps;
+        result.destroy_subtree(less.root);
+    }
+    if (_filter) {
+        filter_remove(result._size);
+        result.enable_filter(_filter->bits_per_element, _filter->hash);
     }
+    return result;
+}
 
+// Links right's tree and storage into left's around a new pivot node
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::join(TreeSet &&left, const T &pivot, TreeSet &&right) {
+    if ((left._root && left._comparator(left.last_node()->value, pivot) >= 0) ||
+        (right._root && left._comparator(pivot, right.first_node()->value) >= 0)) {
+        throw std::invalid_argument("TreeSet::join: pivot does not separate the two sets");
+    }
+    TreeSet result(std::move(left));
+    BinaryTreeNode<T, Augment, Layout> *node = result.create_node(pivot);
+    result._pool.absorb(std::move(right._pool));
+    Subtree joined = join_trees({result._root, black_height(result._root)}, node, {right._root, black_height(right._root)});
+    result._root = joined.root;
+    result._size += right._size + 1;
+    result._finger = nullptr;
+    if (result._filter) {
+        result.filter_insert(pivot);
+        for (const BinaryTreeNode<T, Augment, Layout> *b = successor(node); b; b = successor(b)) {
+            result.filter_insert(b->value);
+        }
+    }
+    right._root = nullptr;
+    right._finger = nullptr;
+    right._size = 0;
+    return result;
+}
+
+// Join-based in-place union
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> &TreeSet<T, Compare, Augment, Layout>::unite(const TreeSet &other, unsigned threads) {
+    if (this == &other || !other._root) return *this;
+    _pool.reserve(other._size);
+    BinaryTreeNode<T, Augment, Layout> *copy = copy_subtree(other._root, nullptr);
+    std::vector<BinaryTreeNode<T, Augment, Layout> *> dropped;
+    Subtree result = unite_trees({_root, black_height(_root)}, {copy, black_height(copy)}, std::max(1u, threads), dropped);
+    _root = result.root;
+    _size += other._size;
+    _finger = nullptr;
+    for (BinaryTreeNode<T, Augment, Layout> *node : dropped) {
+        _size -= destroy_subtree(node);
+    }
+    if (_filter) {
+        for (const BinaryTreeNode<T, Augment, Layout> *b = other.first_node(); b; b = successor(b)) {
+            filter_insert(b->value);
+        }
+    }
+    return *this;
+}
+
+// Join-based in-place intersection
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> &TreeSet<T, Compare, Augment, Layout>::intersect(const TreeSet &other, unsigned threads) {
+    if (this == &other) return *this;
+    std::vector<BinaryTreeNode<T, Augment, Layout> *> dropped;
+    Subtree result = intersect_trees({_root, black_height(_root)}, other._root, std::max(1u, threads), dropped);
+    _root = result.root;
+    _finger = nullptr;
+    size_t removed = 0;
+    for (BinaryTreeNode<T, Augment, Layout> *node : dropped) {
+        removed += destroy_subtree(node);
+    }
+    _size -= removed;
+    if (_filter) {
+        filter_remove(removed);
+    }
+    return *this;
+}
+
+// Join-based in-place difference
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> &TreeSet<T, Compare, Augment, Layout>::subtract(const TreeSet &other, unsigned threads) {
+    if (this == &other) {
+        clear();
+        return *this;
+    }
+    std::vector<BinaryTreeNode<T, Augment, Layout> *> dropped;
+    Subtree result = subtract_trees({_root, black_height(_root)}, other._root, std::max(1u, threads), dropped);
+    _root = result.root;
+    _finger = nullptr;
+    size_t removed = 0;
+    for (BinaryTreeNode<T, Augment, Layout> *node : dropped) {
+        removed += destroy_subtree(node);
+    }
+    _size -= removed;
+    if (_filter) {
+        filter_remove(removed);
+    }
+    return *this;
+}
+
+// Set union
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::operator+(const TreeSet &other) const {
+    TreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::Union));
     return result;
 }
 
 // In-place set union
-template <typename T>
-TreeSet<T>& TreeSet<T>::operator+=(const TreeSet &other) {
-    for (const T &item : other.to_vector()) {
-        add(item);
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>& TreeSet<T, Compare, Augment, Layout>::operator+=(const TreeSet &other) {
+    if (this == &other) return *this;
+    if (prefer_probing(other._size, _size)) {
+        for (const BinaryTreeNode<T, Augment, Layout> *b = other.first_node(); b; b = successor(b)) {
+            add(b->value);
+        }
+    } else {
+        build_from_sorted(merge(other, SetOperation::Union));
     }
+    return *this;
 }
 
 // Set intersection
-template <typename T>
-TreeSet<T> TreeSet<T>::operator&(const TreeSet &other) {
-    TreeSet<T> result;
-    for (const T &item : to_vector()) {
-        if (other.contains(item)) {
-            result.add(item);
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::operator&(const TreeSet &other) const {
+    TreeSet result(_comparator);
+    if (prefer_probing(_size, other._size)) {
+        std::vector<T> values;
+        for (const BinaryTreeNode<T, Augment, Layout> *a = first_node(); a; a = successor(a)) {
+            if (other.contains(a->value)) values.push_back(a->value);
+        }
+        result.build_from_sorted(values);
+    } else if (prefer_probing(other._size, _size)) {
+        std::vector<T> values;
+        for (const BinaryTreeNode<T, Augment, Layout> *b = other.first_node(); b; b = successor(b)) {
+            std::optional<T> found = get(b->value);
+            if (found) values.push_back(*found);
         }
+        result.build_from_sorted(values);
+    } else {
+        result.build_from_sorted(merge(other, SetOperation::Intersection));
     }
     return result;
 }
 
+// Set difference
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::operator-(const TreeSet &other) const {
+    TreeSet result(_comparator);
+    if (prefer_probing(_size, other._size)) {
+        std::vector<T> values;
+        for (const BinaryTreeNode<T, Augment, Layout> *a = first_node(); a; a = successor(a)) {
+            if (!other.contains(a->value)) values.push_back(a->value);
+        }
+        result.build_from_sorted(values);
+    } else {
+        result.build_from_sorted(merge(other, SetOperation::Difference));
+    }
+    return result;
+}
+
+// Symmetric set difference
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout> TreeSet<T, Compare, Augment, Layout>::operator^(const TreeSet &other) const {
+    TreeSet result(_comparator);
+    result.build_from_sorted(merge(other, SetOperation::SymmetricDifference));
+    return result;
+}
+
 // Set equal
-template <typename T>
-bool TreeSet<T>::operator==(const TreeSet &other) const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::operator==(const TreeSet &other) const {
     if (_size != other._size) return false;
-    return to_vector() == other.to_vector();
+    return std::equal(begin(), end(), other.begin());
 }
 
 // Set not equal
-template <typename T>
-bool TreeSet<T>::operator!=(const TreeSet &other) const {
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::operator!=(const TreeSet &other) const {
     return !(*this == other);
 }
 
+// Node storage per element
+template <typename T, typename Compare, typename Augment, typename Layout>
+double TreeSet<T, Compare, Augment, Layout>::bytes_per_element() const {
+    if (_size == 0) return 0;
+    return static_cast<double>(_pool.bytes()) / _size;
+}
+
 // Clear the set
-template <typename T>
-void TreeSet<T>::clear() {
-    // Implement a clear function to delete all nodes
-    std::function<void(BinaryTreeNode<T>*)> clear_helper = [&](BinaryTreeNode<T>* node) {
-        if (node != nullptr) {
-            clear_helper(node->_left);
-            clear_helper(node->_right);
-            delete node;
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::clear() {
+    // nodes that need no destructor (value and augment data alike) are dropped
+    // together with their chunks, anything else is destroyed with an iterative
+    // post-order walk first
+    if (!std::is_trivially_destructible<BinaryTreeNode<T, Augment, Layout>>::value) {
+        BinaryTreeNode<T, Augment, Layout> *node = _root;
+        while (node) {
+            if (node->_left) {
+                node = node->_left;
+            } else if (node->_right) {
+                node = node->_right;
+            } else {
+                BinaryTreeNode<T, Augment, Layout> *parent = node->_parent;
+                if (parent) {
+                    (parent->_left == node ? parent->_left : parent->_right) = nullptr;
+                }
+                node->~BinaryTreeNode();
+                node = parent;
+            }
         }
-    };
-    clear_helper(_root);
+    }
+    _pool.release();
     _root = nullptr;
+    _finger = nullptr;
     _size = 0;
+    if (_filter) {
+        rebuild_filter();
+    }
 }
 
 // Destructor
-template <typename T>
-TreeSet<T>::~TreeSet() {
+template <typename T, typename Compare, typename Augment, typename Layout>
+TreeSet<T, Compare, Augment, Layout>::~TreeSet() {
+    _filter.reset();
     clear();
 }
 
 // Rotate left
-template <typename T>
-void TreeSet<T>::rotate_left(BinaryTreeNode<T> *x) {
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::rotate_left(BinaryTreeNode<T, Augment, Layout> *x) {
+    rotate_left(_root, x);
+}
+
+// Rotate left within the tree at root
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::rotate_left(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *x) {
     if (!x || !x->_right) return;
 
-    BinaryTreeNode<T> *y = x->_right;
+    BinaryTreeNode<T, Augment, Layout> *y = x->_right;
     x->_right = y->_left;
 
     if (y->_left)
@@ -245,7 +1563,7 @@ void TreeSet<T>::rotate_left(BinaryTreeNode<T> *x) {
     y->_parent = x->_parent;
     //if (x->_parent == nullptr) {
     if (!x->_parent){
-        _root = y;
+        root = y;
     }
     else if (x == x->_parent->_left) {
         x->_parent->_left = y;
@@ -254,15 +1572,23 @@ void TreeSet<T>::rotate_left(BinaryTreeNode<T> *x) {
     }
     y->_left = x;
     x->_parent = y;
+    update(x);
+    update(y);
 }
 
 
 // Rotate right
-template <typename T>
-void TreeSet<T>::rotate_right(BinaryTreeNode<T> *y) {
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::rotate_right(BinaryTreeNode<T, Augment, Layout> *y) {
+    rotate_right(_root, y);
+}
+
+// Rotate right within the tree at root
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::rotate_right(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *y) {
     if (!y || !y->_left) return;
 
-    BinaryTreeNode<T> *x = y->_left;
+    BinaryTreeNode<T, Augment, Layout> *x = y->_left;
     y->_left = x->_right;
     if (x->_right) 
     {
@@ -271,7 +1597,7 @@ void TreeSet<T>::rotate_right(BinaryTreeNode<T> *y) {
     x->_parent = y->_parent;
     if (!y->_parent) 
     {
-        _root = x;
+        root = x;
     }
      else if (y == y->_parent->_left) 
      {
@@ -283,82 +1609,265 @@ void TreeSet<T>::rotate_right(BinaryTreeNode<T> *y) {
     
     x->_right = y;
     y->_parent = x;
+    update(y);
+    update(x);
 }
 
 /*/ Fix violation of Red-Black Tree properties
-template <typename T>
-void TreeSet<T>::fix_violation(BinaryTreeNode<T> *z) {
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::fix_violation(BinaryTreeNode<T, Augment, Layout> *z) {
     // Implementation of the violation fixing logic
-    while (z->_parent && z->_parent->_color == Red) {
-        BinaryTreeNode<T> *y = (z->_parent == z->_parent->_parent->_left) ? z->_parent->_parent->_right : z->_parent->_parent->_left;
+    while (z->_parent && z->_parent->color() == Red) {
+        BinaryTreeNode<T, Augment, Layout> *y = (z->_parent == z->_parent->_parent->_left) ? z->_parent->_parent->_right : z->_parent->_parent->_left;
 
-        if (y && y->_color == Red) {
-            z->_parent->_color = Black;
-            y->_color = Black;
-            z->_parent->_parent->_color = Red;
+        if (y && y->color() == Red) {
+            z->_parent->set_color(Black);
+            y->set_color(Black);
+            z->_parent->_parent->set_color(Red);
             z = z->_parent->_parent;
         } else {
             if (z == z->_parent->_right) {
                 z = z->_parent;
                 rotate_left(z);
             }
-            z->_parent->_color = Black;
-            z->_parent->_parent->_color = Red;
+            z->_parent->set_color(Black);
+            z->_parent->_parent->set_color(Red);
             rotate_right(z->_parent->_parent);
         }
     }
-    _root->_color = Black;
+    _root->set_color(Black);
 }
 
 */
 
-template <typename T>
-void TreeSet<T>::fix_violation(BinaryTreeNode<T> *node) {
-    BinaryTreeNode<T> *parent = nullptr;
-    BinaryTreeNode<T> *grandparent = nullptr;
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::fix_violation(BinaryTreeNode<T, Augment, Layout> *node) {
+    fix_violation(_root, node);
+}
+
+// Fixes red-black violations within the tree at root
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::fix_violation(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *node) {
+    BinaryTreeNode<T, Augment, Layout> *parent = nullptr;
+    BinaryTreeNode<T, Augment, Layout> *grandparent = nullptr;
 
-    while ((node != _root) && (node->_color != Black) && (node->_parent->_color == Red)) {
+    while ((node != root) && (node->color() != Black) && (node->_parent->color() == Red)) {
         parent = node->_parent;
         grandparent = parent->_parent;
 
         if (parent == grandparent->_left) {
-            BinaryTreeNode<T> *uncle = grandparent->_right;
+            BinaryTreeNode<T, Augment, Layout> *uncle = grandparent->_right;
 
-            if (uncle && uncle->_color == Red) {
-                grandparent->_color = Red;
-                parent->_color = Black;
-                uncle->_color = Black;
+            if (uncle && uncle->color() == Red) {
+                grandparent->set_color(Red);
+                parent->set_color(Black);
+                uncle->set_color(Black);
                 node = grandparent;
             } else {
                 if (node == parent->_right) {
-                    rotate_left(parent);
+                    rotate_left(root, parent);
                     node = parent;
                     parent = node->_parent;
                 }
-                rotate_right(grandparent);
-                std::swap(parent->_color, grandparent->_color);
+                rotate_right(root, grandparent);
+                Color parent_color = parent->color();
+                parent->set_color(grandparent->color());
+                grandparent->set_color(parent_color);
                 node = parent;
             }
         } else {
-            BinaryTreeNode<T> *uncle = grandparent->_left;
+            BinaryTreeNode<T, Augment, Layout> *uncle = grandparent->_left;
 
-            if (uncle && uncle->_color == Red) {
-                grandparent->_color = Red;
-                parent->_color = Black;
-                uncle->_color = Black;
+            if (uncle && uncle->color() == Red) {
+                grandparent->set_color(Red);
+                parent->set_color(Black);
+                uncle->set_color(Black);
                 node = grandparent;
             } else {
                 if (node == parent->_left) {
-                    rotate_right(parent);
+                    rotate_right(root, parent);
                     node = parent;
                     parent = node->_parent;
                 }
-                rotate_left(grandparent);
-                std::swap(parent->_color, grandparent->_color);
+                rotate_left(root, grandparent);
+                Color parent_color = parent->color();
+                parent->set_color(grandparent->color());
+                grandparent->set_color(parent_color);
                 node = parent;
             }
         }
     }
 
-    _root->_color = Black;
-}
\ No newline at end of file
+    bool grew = root->color() == Red;
+    root->set_color(Black);
+    return grew;
+}
+
+// Replaces the subtree at u with the subtree at v
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::transplant(BinaryTreeNode<T, Augment, Layout> *u, BinaryTreeNode<T, Augment, Layout> *v) {
+    if (!u->_parent) {
+        _root = v;
+    } else if (u == u->_parent->_left) {
+        u->_parent->_left = v;
+    } else {
+        u->_parent->_right = v;
+    }
+    if (v) {
+        v->_parent = u->_parent;
+    }
+}
+
+// Removes a node from the tree
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::erase_node(BinaryTreeNode<T, Augment, Layout> *z) {
+    if (z == _finger) {
+        _finger = nullptr;
+    }
+    BinaryTreeNode<T, Augment, Layout> *y = z;
+    Color y_original_color = y->color();
+    BinaryTreeNode<T, Augment, Layout> *x;
+    BinaryTreeNode<T, Augment, Layout> *x_parent;
+
+    if (!z->_left) {
+        x = z->_right;
+        x_parent = z->_parent;
+        transplant(z, z->_right);
+    } else if (!z->_right) {
+        x = z->_left;
+        x_parent = z->_parent;
+        transplant(z, z->_left);
+    } else {
+        // move the successor into z's place
+        y = z->_right;
+        while (y->_left) {
+            y = y->_left;
+        }
+        y_original_color = y->color();
+        x = y->_right;
+        if (y->_parent == z) {
+            x_parent = y;
+        } else {
+            x_parent = y->_parent;
+            transplant(y, y->_right);
+            y->_right = z->_right;
+            y->_right->_parent = y;
+        }
+        transplant(z, y);
+        y->_left = z->_left;
+        y->_left->_parent = y;
+        y->set_color(z->color());
+    }
+
+    update_path(x_parent);
+    if (y_original_color == Black) {
+        delete_fixup(x, x_parent);
+    }
+    destroy_node(z);
+    _size--;
+#ifdef TREE_SET_VERIFY_PATHS
+    assert(path_is_valid(x_parent ? x_parent : _root));
+#endif
+    if (_filter) {
+        filter_remove(1);
+    }
+}
+
+// Walks from node up to the root checking each node against its children
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::path_is_valid(const BinaryTreeNode<T, Augment, Layout> *node) const {
+    auto spine_blacks = [](const BinaryTreeNode<T, Augment, Layout> *n) {
+        int blacks = 0;
+        for (; n; n = n->_left) blacks += n->color() == Black ? 1 : 0;
+        return blacks;
+    };
+    if (_root && (_root->_parent || _root->color() != Black)) return false;
+    for (; node; node = node->_parent) {
+        const BinaryTreeNode<T, Augment, Layout> *left = node->_left;
+        const BinaryTreeNode<T, Augment, Layout> *right = node->_right;
+        if (left && (left->_parent != node || _comparator(left->value, node->value) >= 0)) return false;
+        if (right && (right->_parent != node || _comparator(node->value, right->value) >= 0)) return false;
+        if (node->color() == Red && ((left && left->color() == Red) || (right && right->color() == Red))) return false;
+        if (spine_blacks(left) != spine_blacks(right)) return false;
+        if (!node->_parent && node != _root) return false;
+    }
+    return true;
+}
+
+// Full check in one in-order pass
+template <typename T, typename Compare, typename Augment, typename Layout>
+bool TreeSet<T, Compare, Augment, Layout>::is_valid() const {
+    if (!_root) return _size == 0;
+    size_t count = 0;
+    bool ordered = _root->is_rbtree([&](const T &a, const T &b) {
+        count++;
+        return _comparator(a, b) < 0;
+    });
+    // the first element is never compared
+    return ordered && count + 1 == _size;
+}
+
+// Fix the extra black left behind by a deletion
+template <typename T, typename Compare, typename Augment, typename Layout>
+void TreeSet<T, Compare, Augment, Layout>::delete_fixup(BinaryTreeNode<T, Augment, Layout> *x, BinaryTreeNode<T, Augment, Layout> *parent) {
+    auto is_black = [](BinaryTreeNode<T, Augment, Layout> *node) { return !node || node->color() == Black; };
+
+    while (x != _root && is_black(x)) {
+        if (x == parent->_left) {
+            BinaryTreeNode<T, Augment, Layout> *w = parent->_right;
+            if (w->color() == Red) {
+                w->set_color(Black);
+                parent->set_color(Red);
+                rotate_left(parent);
+                w = parent->_right;
+            }
+            if (is_black(w->_left) && is_black(w->_right)) {
+                w->set_color(Red);
+                x = parent;
+                parent = x->_parent;
+            } else {
+                if (is_black(w->_right)) {
+                    w->_left->set_color(Black);
+                    w->set_color(Red);
+                    rotate_right(w);
+                    w = parent->_right;
+                }
+                w->set_color(parent->color());
+                parent->set_color(Black);
+                if (w->_right) w->_right->set_color(Black);
+                rotate_left(parent);
+                x = _root;
+                parent = nullptr;
+            }
+        } else {
+            BinaryTreeNode<T, Augment, Layout> *w = parent->_left;
+            if (w->color() == Red) {
+                w->set_color(Black);
+                parent->set_color(Red);
+                rotate_right(parent);
+                w = parent->_left;
+            }
+            if (is_black(w->_left) && is_black(w->_right)) {
+                w->set_color(Red);
+                x = parent;
+                parent = x->_parent;
+            } else {
+                if (is_black(w->_left)) {
+                    w->_right->set_color(Black);
+                    w->set_color(Red);
+                    rotate_left(w);
+                    w = parent->_left;
+                }
+                w->set_color(parent->color());
+                parent->set_color(Black);
+                if (w->_left) w->_left->set_color(Black);
+                rotate_right(parent);
+                x = _root;
+                parent = nullptr;
+            }
+        }
+    }
+    if (x) {
+        x->set_color(Black);
+    }
+}
@@ -6,16 +6,347 @@
 #include <cstddef>
 #include <vector>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
 #include "BinaryTreeNode.hpp"
+#include "BloomFilter.hpp"
+#include "NodePool.hpp"
+#include "SortedRun.hpp"
 
+/// @brief default three-way comparator of `TreeSet`
+/// Orders elements with `<` and `>`, which the compiler can inline. A runtime
+/// comparator can be supplied instead; calls then go through `std::function`
+/// with both elements passed by reference. An `int(const T &, const T &)`
+/// callable copies nothing; an older `int(T, T)` one still works, but copies
+/// its arguments itself.
 template <typename T>
+class DefaultComparator
+{
+private:
+    std::function<int(const T &, const T &)> _fn;
+
+public:
+    DefaultComparator() = default;
+
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, DefaultComparator>::value &&
+                                          std::is_invocable_r<int, F &, const T &, const T &>::value>>
+    DefaultComparator(F fn) : _fn(std::move(fn)) {}
+
+    /// @brief whether this comparator uses the natural `<` ordering
+    bool is_natural() const { return !_fn; }
+
+    /// @brief compare two elements
+    /// @return -1 if a < b, 1 if a > b, otherwise 0
+    int operator()(const T &a, const T &b) const {
+        if (_fn) return _fn(a, b);
+        return (a < b) ? -1 : (a > b) ? 1 : 0;
+    }
+};
+
+/// @brief a pair of iterators usable in a range-based for loop
+template <typename Iterator>
+class IteratorRange
+{
+private:
+    Iterator _begin;
+    Iterator _end;
+
+public:
+    IteratorRange(Iterator begin, Iterator end) : _begin(begin), _end(end) {}
+    Iterator begin() const { return _begin; }
+    Iterator end() const { return _end; }
+    bool empty() const { return _begin == _end; }
+};
+
+template <typename T, typename Compare>
+class FrozenTreeSet;
+
+/// @tparam T type of the elements
+/// @tparam Compare callable `int(const T &, const T &)` returning -1, 0 or 1
+/// @tparam Augment extra data kept in every node, see Augment.hpp
+/// @tparam Layout how nodes store links and color, see NodeLayout.hpp
+template <typename T, typename Compare = DefaultComparator<T>, typename Augment = NoAugment, typename Layout = WideNode>
 class TreeSet
 {
 private:
-    BinaryTreeNode<T> *_root;
-    std::function<int(T, T)> _comparator;
+    template <typename K, typename V, typename C, typename A, typename L>
+    friend class TreeMap;
+
+    using Pool = typename Layout::template pool<BinaryTreeNode<T, Augment, Layout>>;
+
+    BinaryTreeNode<T, Augment, Layout> *_root;
+    Compare _comparator;
     size_t _size;
+    Pool _pool;
+    BinaryTreeNode<T, Augment, Layout> *_finger = nullptr; // last node inserted or found by an insert
+
+    /// @brief Bloom filter of the elements, see `enable_filter`
+    struct Filter {
+        BlockedBloomFilter bloom;
+        FilterHash<T> hash;
+        double bits_per_element;
+        size_t stale; // removed elements whose bits are still set
+    };
+    std::unique_ptr<Filter> _filter;
+
+    /// @brief refill the filter from the elements, sized for twice as many
+    void rebuild_filter();
+
+    /// @brief add an element to the filter, rebuilding it once it is full
+    void filter_insert(const T &value);
+
+    /// @brief note removed elements, rebuilding the filter once they
+    ///        outnumber the elements left
+    void filter_remove(size_t count);
+
+    /// @brief whether the filter proves that no element equals `value`
+    bool filter_excludes(const T &value) const;
+
+    /// @brief check the invariants that an insert or erase may have broken
+    ///        around `node`: for it and each of its ancestors, the parent links
+    ///        and order of its children, no red node with a red child, and equal
+    ///        black heights along the leftmost paths of both subtrees
+    /// @return true if no violation was found
+    /// @note O(log^2 n); a cheap partial check for `TREE_SET_VERIFY_PATHS`
+    bool path_is_valid(const BinaryTreeNode<T, Augment, Layout> *node) const;
+
+    /// @brief construct a node in storage taken from `_pool`
+    /// @param args arguments for constructing the value in place
+    /// @return the new red node with no children and no parent
+    template <typename... Args>
+    BinaryTreeNode<T, Augment, Layout> *create_node(Args &&...args);
+
+    /// @brief a node already made by `create_node`, handed through
+    ///        `insert_unique` to be linked as it is
+    struct BuiltNode {
+        BinaryTreeNode<T, Augment, Layout> *node;
+    };
+
+    /// @brief the node of a `BuiltNode`, so `insert_at` links it instead of
+    ///        building another
+    BinaryTreeNode<T, Augment, Layout> *create_node(BuiltNode built) { return built.node; }
+
+    /// @brief `R`, for the lookup overloads that take a key of another type
+    /// Keys that convert to `T` keep using the `const T &` overloads, which
+    /// also ask the filter first.
+    template <typename K, typename R>
+    using KeyLookup = std::enable_if_t<!std::is_convertible<const K &, const T &>::value, R>;
+
+    /// @brief find the node whose value compares equal to `key`
+    /// @param key a `T`, or any type the comparator can compare with `T`
+    /// @return the node, or nullptr if there is none
+    template <typename K>
+    BinaryTreeNode<T, Augment, Layout> *find_node(const K &key) const;
+
+    /// @brief number of descents `find_many` keeps in flight
+    static constexpr size_t BATCH_WIDTH = 16;
+
+    /// @brief look up many keys with their descents interleaved, so the cache
+    ///        misses of different lookups overlap
+    /// @param excludes `excludes(key)` is true for keys known to be absent,
+    ///        e.g. ruled out by the filter; they never take a lane
+    /// @param visit called as `visit(i, node)` once per key, with the node
+    ///        found for `keys[i]` or nullptr, in no particular order of `i`
+    template <typename K, typename Excludes, typename Visit>
+    void find_many(const K *keys, size_t count, Excludes &&excludes, Visit &&visit) const;
+
+    /// @brief find `key`, or insert a node built from `args` in one descent
+    /// @param key what to search for; must compare equal to the value built from `args`
+    /// @param args arguments for constructing the value in place if `key` is absent
+    /// @return the found or new node, and whether it was inserted
+    /// @note tries next to the last insertion point first, so increasing or
+    ///       decreasing streams cost O(1) comparisons per insert
+    template <typename K, typename... Args>
+    std::pair<BinaryTreeNode<T, Augment, Layout> *, bool> insert_unique(const K &key, Args &&...args);
+
+    /// @brief `insert_unique`, first trying the gaps just before and just
+    ///        after `hint`
+    /// @param hint a node near where `key` belongs, or nullptr to start at the root
+    template <typename K, typename... Args>
+    std::pair<BinaryTreeNode<T, Augment, Layout> *, bool> insert_near(BinaryTreeNode<T, Augment, Layout> *hint,
+                                                                      const K &key, Args &&...args);
+
+    /// @brief link a new node built from `args` below `parent` and rebalance
+    /// @param left whether it becomes the left child; that child must be empty
+    template <typename... Args>
+    BinaryTreeNode<T, Augment, Layout> *insert_at(BinaryTreeNode<T, Augment, Layout> *parent, bool left, Args &&...args);
+
+    /// @brief the node a hint iterator points at, with `end()` meaning the largest
+    BinaryTreeNode<T, Augment, Layout> *hint_node(const BinaryTreeNode<T, Augment, Layout> *hint) const;
+
+    /// @brief remove the nodes from `first` up to, but not including, `last`
+    /// @return the number of elements removed
+    size_t erase_between(BinaryTreeNode<T, Augment, Layout> *first, BinaryTreeNode<T, Augment, Layout> *last);
+
+    /// @brief destroy a node and return its storage to `_pool`
+    /// @param node the node to destroy
+    void destroy_node(BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief recompute the augmented data of `node` from its value and children
+    static void update(BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief recompute the augmented data of `node` and all of its ancestors
+    static void update_path(BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief number of nodes in the subtree rooted at `node`
+    /// @note needs an `Augment` policy with subtree sizes
+    static size_t subtree_size(const BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief number of elements less than (or, if `inclusive`, not greater than) `value`
+    template <typename K>
+    size_t count_before(const K &value, bool inclusive) const;
+
+    /// @brief `Augment`'s aggregate of the subtree rooted at `node`, or the
+    ///        identity for nullptr
+    /// @note needs an `Augment` policy with an aggregate
+    static auto subtree_aggregate(const BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief fold `Augment`'s monoid over the elements x with lo <= x <= hi, in order
+    template <typename K>
+    auto aggregate_between(const K &lo, const K &hi) const;
+
+    /// @brief deep copy a subtree into this set's pool
+    /// @param node root of the subtree to copy
+    /// @param parent parent of the copied root
+    /// @return root of the copy
+    BinaryTreeNode<T, Augment, Layout> *copy_subtree(const BinaryTreeNode<T, Augment, Layout> *node, BinaryTreeNode<T, Augment, Layout> *parent);
+
+    /// @brief replace the contents with `values`, sorted and deduplicated first
+    /// @param values the new elements in any order
+    /// @param threads sort, deduplicate and build on up to this many threads
+    /// @note when values compare equal the last one is kept, as with repeated `add`
+    void assign(std::vector<T> values, unsigned threads = 1);
+
+    /// @brief replace the contents with a strictly increasing run in O(n)
+    /// @param values the new elements, sorted by `_comparator` with no duplicates
+    /// @param threads build disjoint subtrees on up to this many threads
+    void build_from_sorted(const std::vector<T> &values, unsigned threads = 1);
+
+    /// @brief `build_from_sorted` from `n` values of any type `T` can be built from
+    template <typename Source>
+    void build_from_sorted(const Source *values, size_t n, unsigned threads = 1);
+
+    /// @brief build a balanced subtree from `values[lo, hi)` bottom-up
+    /// @param depth depth of the subtree root
+    /// @param red_depth nodes at this depth are colored red, all others black
+    /// @param parent parent of the subtree root
+    /// @param block pool storage for all nodes; `values[i]` goes in slot i
+    /// @param threads build the two halves concurrently while this is above 1
+    /// @return root of the subtree
+    template <typename Source>
+    BinaryTreeNode<T, Augment, Layout> *build_subtree(const Source *values, size_t lo, size_t hi, int depth, int red_depth,
+                                     BinaryTreeNode<T, Augment, Layout> *parent, const typename Pool::Block &block,
+                                     unsigned threads);
+
+    /// @brief below this many elements, work is not split across threads
+    static constexpr size_t PARALLEL_GRAIN = 1 << 14;
+
+    /// @brief split the tree `split_depth` levels down for parallel export
+    /// @param pieces receives, in order, `{subtree root, true}` for the whole
+    ///        subtrees at `split_depth` and `{node, false}` for each node above
+    static void split_pieces(const BinaryTreeNode<T, Augment, Layout> *node, int depth, int split_depth,
+                             std::vector<std::pair<const BinaryTreeNode<T, Augment, Layout> *, bool>> &pieces);
+
+    /// @brief the leftmost node of the tree
+    /// @return the node holding the smallest value, or nullptr if empty
+    BinaryTreeNode<T, Augment, Layout> *first_node() const;
+
+    /// @brief in-order successor, found through the parent links
+    /// @param node a node of the tree
+    /// @return the next node in order, or nullptr if `node` is the last one
+    static BinaryTreeNode<T, Augment, Layout> *successor(const BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief the rightmost node of the tree
+    /// @return the node holding the largest value, or nullptr if empty
+    BinaryTreeNode<T, Augment, Layout> *last_node() const;
+
+    /// @brief in-order predecessor, found through the parent links
+    /// @param node a node of the tree
+    /// @return the previous node in order, or nullptr if `node` is the first one
+    static BinaryTreeNode<T, Augment, Layout> *predecessor(const BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief first node whose value is not less than (or, if `strict`, is greater than) `value`
+    template <typename K>
+    BinaryTreeNode<T, Augment, Layout> *bound_node(const K &value, bool strict) const;
+
+    enum class SetOperation { Union, Intersection, Difference, SymmetricDifference };
+
+    /// @brief walk both sets in order at once and collect the result of `op`
+    /// @param other the right-hand operand, ordered by the same comparator
+    /// @param op which elements to keep
+    /// @return the sorted elements of the result
+    /// @note on equal elements, union keeps the value from `other` and
+    ///       intersection keeps the value from this set
+    std::vector<T> merge(const TreeSet &other, SetOperation op) const;
+
+    /// @brief whether probing the larger set once per element of the smaller
+    ///        one (O(m log n)) beats a linear merge (O(n + m))
+    static bool prefer_probing(size_t small_size, size_t large_size);
+
+    /// @brief a red-black tree of this set's nodes, detached from `_root`:
+    ///        its root is black and has no parent
+    struct Subtree {
+        BinaryTreeNode<T, Augment, Layout> *root;
+        int black_height; // black nodes on every path down from the root, 0 when empty
+    };
+
+    /// @brief the three parts of a tree cut at a key by `split_tree`
+    struct SplitParts {
+        Subtree less;
+        BinaryTreeNode<T, Augment, Layout> *equal; // unlinked, or nullptr if the key was absent
+        Subtree greater;
+    };
+
+    /// @brief a subtree of black height at least this holds PARALLEL_GRAIN nodes
+    static constexpr int PARALLEL_BLACK_HEIGHT = 14;
+
+    /// @brief number of black nodes on the leftmost path below `node`, counting it
+    static int black_height(const BinaryTreeNode<T, Augment, Layout> *node);
+
+    /// @brief unlink a child from its parent and make it a `Subtree`,
+    ///        recoloring a red root black
+    /// @param black_height black height of `node` before the recoloring
+    static Subtree detach(BinaryTreeNode<T, Augment, Layout> *node, int black_height);
+
+    /// @brief join two trees with every element of `left` less than
+    ///        `pivot` and every element of `right` greater than it
+    /// @param pivot an unlinked node, relinked and recolored as needed
+    /// @note O(|difference of the black heights| + 1): `pivot` is hung on the
+    ///       spine of the taller tree where the heights match, and the usual
+    ///       insert fixup rebalances from there
+    static Subtree join_trees(Subtree left, BinaryTreeNode<T, Augment, Layout> *pivot, Subtree right);
+
+    /// @brief `join_trees` without a pivot, taking the largest node of `left`
+    Subtree join_trees(Subtree left, Subtree right) const;
+
+    /// @brief cut a tree into the elements less than, equal to and greater
+    ///        than `key` in O(log n)
+    template <typename K>
+    SplitParts split_tree(Subtree tree, const K &key) const;
+
+    /// @brief join-based union of two trees of this set's nodes, with the
+    ///        values of `b` winning on equal elements
+    /// @param threads recurse into both halves concurrently while above 1
+    /// @param dropped receives the roots of subtrees left out of the result
+    Subtree unite_trees(Subtree a, Subtree b, unsigned threads, std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const;
+
+    /// @brief join-based intersection of a tree of this set's nodes with a
+    ///        subtree of another set, keeping the values of `a`
+    Subtree intersect_trees(Subtree a, const BinaryTreeNode<T, Augment, Layout> *b, unsigned threads,
+                            std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const;
+
+    /// @brief join-based difference of a tree of this set's nodes and a
+    ///        subtree of another set
+    Subtree subtract_trees(Subtree a, const BinaryTreeNode<T, Augment, Layout> *b, unsigned threads,
+                           std::vector<BinaryTreeNode<T, Augment, Layout> *> &dropped) const;
+
+    /// @brief destroy every node of a detached subtree
+    /// @return the number of nodes destroyed
+    size_t destroy_subtree(BinaryTreeNode<T, Augment, Layout> *node);
 
     // Red-Black Tree functions
     // if not doing Red-Black tree, these functions can be empty
@@ -23,25 +354,112 @@ private:
     /// @brief fix any violation of red-black tree properties
     /// @param z the new node inserted
     /// @note textbook 13.3 P.339
-    void fix_violation(BinaryTreeNode<T> *z);
+    void fix_violation(BinaryTreeNode<T, Augment, Layout> *z);
+
+    /// @brief `fix_violation` in the tree rooted at `root` instead of `_root`
+    /// @return true if the root had to be recolored black, which adds one
+    ///         to the black height of the tree
+    static bool fix_violation(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *z);
 
     /// @brief left rotation
     /// @param x the node to rotate on
     /// @note textbook 13.2 P.336
-    void rotate_left(BinaryTreeNode<T> *x);
+    void rotate_left(BinaryTreeNode<T, Augment, Layout> *x);
+
+    /// @brief `rotate_left` in the tree rooted at `root` instead of `_root`
+    static void rotate_left(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *x);
 
     /// @brief Right rotation
     /// @param y the node to rotate on
     /// @note textbook P.336 exercise 13.2-1
-    void rotate_right(BinaryTreeNode<T> *y);
+    void rotate_right(BinaryTreeNode<T, Augment, Layout> *y);
+
+    /// @brief `rotate_right` in the tree rooted at `root` instead of `_root`
+    static void rotate_right(BinaryTreeNode<T, Augment, Layout> *&root, BinaryTreeNode<T, Augment, Layout> *y);
+
+    /// @brief replace the subtree rooted at `u` with the one rooted at `v`
+    /// @note textbook 13.4 P.349
+    void transplant(BinaryTreeNode<T, Augment, Layout> *u, BinaryTreeNode<T, Augment, Layout> *v);
+
+    /// @brief unlink a node, rebalance and recycle its storage
+    /// @param z the node to remove
+    /// @note textbook 13.4 P.349
+    void erase_node(BinaryTreeNode<T, Augment, Layout> *z);
+
+    /// @brief restore red-black properties after removing a black node
+    /// @param x the node that took the removed node's place, may be nullptr
+    /// @param parent parent of `x`, needed when `x` is nullptr
+    /// @note textbook 13.4 P.351
+    void delete_fixup(BinaryTreeNode<T, Augment, Layout> *x, BinaryTreeNode<T, Augment, Layout> *parent);
 
 
 
 public:
+    /// @brief bidirectional iterator over the set in order
+    /// @note elements are immutable through the iterator since they decide
+    ///       the shape of the tree
+    class const_iterator
+    {
+    private:
+        friend class TreeSet;
+        template <typename K, typename V, typename C, typename A, typename L>
+        friend class TreeMap;
+        const BinaryTreeNode<T, Augment, Layout> *_node;
+        const TreeSet *_set;
+
+        const_iterator(const BinaryTreeNode<T, Augment, Layout> *node, const TreeSet *set) : _node(node), _set(set) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : _node(nullptr), _set(nullptr) {}
+
+        reference operator*() const { return _node->value; }
+        pointer operator->() const { return &_node->value; }
+
+        const_iterator &operator++() {
+            _node = TreeSet::successor(_node);
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        // decrementing end() lands on the largest element
+        const_iterator &operator--() {
+            _node = _node ? TreeSet::predecessor(_node) : _set->last_node();
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const { return _node == other._node; }
+        bool operator!=(const const_iterator &other) const { return _node != other._node; }
+    };
+
+    using iterator = const_iterator;
+
+    using Range = IteratorRange<const_iterator>;
+
     TreeSet();
+
+    /// @brief build a set from `items` in O(n log n), or O(n) when `items` is sorted
+    /// @param items the elements, in any order and possibly with duplicates
     TreeSet(const std::vector<T> &items);
-    TreeSet(std::function<int(T, T)> comparator);
-    TreeSet(const std::vector<T> &items, std::function<int(T, T)> comparator);
+    TreeSet(Compare comparator);
+    TreeSet(const std::vector<T> &items, Compare comparator);
+    TreeSet(const TreeSet &other);
+    TreeSet(TreeSet &&other) noexcept;
+    TreeSet &operator=(const TreeSet &other);
+    TreeSet &operator=(TreeSet &&other) noexcept;
 
     /// @brief Returns the number of elements in the tree.
     /// @return The number of elements in the tree.
@@ -51,12 +469,70 @@ public:
     /// If there is an element whose value equals (checked by comparator) `value`,
     /// the existing value will be replaced by `value`.
     /// @param value put this value into the set
-    void add(T value);
+    void add(const T &value);
+
+    /// @brief adds a value to the set, moving it into the tree
+    /// @param value put this value into the set
+    void add(T &&value);
+
+    /// @brief adds a value, looking for its place next to `hint` first
+    /// @param hint an iterator to the element just after or just before where
+    ///        `value` belongs, e.g. `end()` for values arriving in increasing order
+    /// @param value the element to add
+    /// @return an iterator to the added or updated element
+    /// @note O(1) comparisons when the hint is right, O(log n) otherwise
+    const_iterator add(const_iterator hint, const T &value);
+    const_iterator add(const_iterator hint, T &&value);
+
+    /// @brief constructs a value from `args` in a new node and adds it to the set
+    /// @param args arguments forwarded to a constructor of `T`
+    /// @note the value is never moved on insert. If an equal element exists,
+    ///       it is replaced by move assignment, or kept when `T` cannot be
+    ///       move-assigned, and the new node is freed.
+    template <typename... Args>
+    void emplace(Args &&...args);
+
+    /// @brief removes a value from the set, rebalancing in O(log n)
+    /// @param value the element to remove
+    /// @return true if an element was removed, false if it was not in the set
+    bool remove(const T &value);
+
+    /// @brief removes the element equal to `key`
+    /// @param key any type the comparator can compare with `T`, so no `T`
+    ///        has to be built to name the element
+    /// @return true if an element was removed
+    /// @note the filter only hashes `T`s, so it is not asked
+    template <typename K>
+    KeyLookup<K, bool> remove(const K &key);
+
+    /// @brief removes the element at `pos`
+    /// @param pos a valid dereferenceable iterator of this set
+    /// @return an iterator to the element after the removed one
+    const_iterator erase(const_iterator pos);
+
+    /// @brief removes every element x with lo <= x <= hi
+    /// @return the number of elements removed
+    /// @note O(log n + k) for k removed elements: the tree is split at both
+    ///       ends of the range, the middle destroyed, and the rest joined
+    size_t erase_range(const T &lo, const T &hi);
 
     /// @brief check if a element is in the set
     /// @param value the element
     /// @return true if value is in the set, otherwise false
-    bool contains(T value) const;
+    bool contains(const T &value) const;
+
+    /// @brief check if an element equal to `key` is in the set
+    /// @param key any type the comparator can compare with `T`
+    template <typename K>
+    KeyLookup<K, bool> contains(const K &key) const;
+
+    /// @brief check many elements at once, faster than calling `contains`
+    ///        in a loop on trees that do not fit in cache
+    /// @param values `count` elements to look for
+    /// @param found receives `count` results, `found[i]` for `values[i]`
+    /// @note with a filter, the elements it rules out are answered without
+    ///       taking part in the batch
+    void contains_many(const T *values, size_t count, bool *found) const;
 
     /// @brief check if the set is empty
     /// @return true if the set is empty, otherwise false
@@ -74,15 +550,147 @@ public:
     /// @return a sorted vector containing all values in the set
     std::vector<T> to_vector() const;
 
+    /// @brief an immutable copy in Eytzinger layout for read-heavy use
+    /// @return a `FrozenTreeSet` with the same elements and comparator, in O(n)
+    FrozenTreeSet<T, Compare> freeze() const;
+
+    /// @brief write the elements to a sorted-run file (see SortedRun.hpp)
+    /// @param path the file to create or replace
+    /// @note requires `T` to be trivially copyable
+    void save(const std::string &path) const;
+
+    /// @brief replace the contents with those of a file written by `save`,
+    ///        mapping it into memory and building the tree in O(n)
+    /// @param path the file to read
+    /// @param threads build on up to this many threads
+    /// @note to serve lookups from the file without building a tree, use
+    ///       `MappedTreeSet`
+    void load(const std::string &path, unsigned threads = 1);
+
+    /// @brief `to_vector()` with the tree split at the top into disjoint
+    ///        subtrees that are exported concurrently
+    /// @param threads number of threads to use
+    /// @note requires `T` to be default constructible
+    std::vector<T> to_vector(unsigned threads) const;
+
+    /// @brief replace the contents with `items`, like the vector constructor,
+    ///        sorting, deduplicating and building on several threads
+    /// @param items the elements, in any order and possibly with duplicates
+    /// @param threads number of threads to use
+    void build(const std::vector<T> &items, unsigned threads);
+
+    /// @brief iterator to the smallest element
+    const_iterator begin() const;
+
+    /// @brief iterator past the largest element
+    const_iterator end() const;
+
+    /// @brief first element that is not less than `value`
+    /// @param value the value to compare against
+    /// @return an iterator to the element, or `end()` if there is none
+    const_iterator lower_bound(const T &value) const;
+    template <typename K>
+    KeyLookup<K, const_iterator> lower_bound(const K &key) const;
+
+    /// @brief first element that is greater than `value`
+    /// @param value the value to compare against
+    /// @return an iterator to the element, or `end()` if there is none
+    const_iterator upper_bound(const T &value) const;
+    template <typename K>
+    KeyLookup<K, const_iterator> upper_bound(const K &key) const;
+
+    /// @brief the elements equal to `value`, as `{lower_bound, upper_bound}`
+    std::pair<const_iterator, const_iterator> equal_range(const T &value) const;
+
+    /// @brief view of the elements x with lo <= x <= hi, in order
+    /// @param lo smallest value of the range
+    /// @param hi largest value of the range
+    /// @return the view; it allocates nothing and walks the tree lazily
+    Range range(const T &lo, const T &hi) const;
+
     /// @brief finds a value and return it
     /// @param value 
     /// @return value if found, otherwise std::nullopt
-    std::optional<T> get(T value) const;
+    std::optional<T> get(const T &value) const;
+    template <typename K>
+    KeyLookup<K, std::optional<T>> get(const K &key) const;
+
+    /// @brief find many values at once, see `contains_many`
+    /// @param values `count` elements to look for
+    /// @param results receives `count` results, `results[i]` for `values[i]`
+    void get_many(const T *values, size_t count, std::optional<T> *results) const;
+
+    /// @brief number of elements smaller than `value`
+    /// @param value the value to rank, which does not need to be in the set
+    /// @return the 0-based position `value` has or would have in `to_vector()`
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    size_t rank(const T &value) const;
+    template <typename K>
+    KeyLookup<K, size_t> rank(const K &key) const;
+
+    /// @brief finds the k-th smallest element
+    /// @param k 0-based position in sorted order
+    /// @return the element, or std::nullopt if `k >= size()`
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    std::optional<T> select(size_t k) const;
+
+    /// @brief number of elements x with lo <= x <= hi
+    /// @note O(log n); requires `Augment` to keep subtree sizes (`OrderStatistics`)
+    size_t count_range(const T &lo, const T &hi) const;
+
+    /// @brief combine the elements x with lo <= x <= hi, in order, with the
+    ///        monoid of an `Aggregate<Monoid>` policy
+    /// @return a `Monoid::value_type`, the identity if the range is empty
+    /// @note O(log n)
+    auto aggregate(const T &lo, const T &hi) const;
+
+    /// @brief moves the elements not less than `key` into a new set
+    /// @param key where to cut; it does not need to be in the set
+    /// @return the moved elements; this set keeps the ones less than `key`
+    /// @note the tree is cut in O(log n). Each set owns its node storage, so
+    ///       the smaller of the two parts is then copied out: O(log n + k)
+    ///       for k elements on the smaller side
+    TreeSet split(const T &key);
+
+    /// @brief concatenate two sets around an element that separates them
+    /// @param left a set whose elements are all less than `pivot`
+    /// @param pivot the element to put between them
+    /// @param right a set whose elements are all greater than `pivot`
+    /// @return a set of every element of `left`, `pivot` and `right`; both
+    ///         arguments are left empty
+    /// @throw std::invalid_argument if the elements are not in that order
+    /// @note O(log n): the tree of `right` is linked in, and its node storage
+    ///       handed over chunk by chunk rather than copied. If `left` has a
+    ///       filter, adding the elements of `right` to it takes O(m) more.
+    static TreeSet join(TreeSet &&left, const T &pivot, TreeSet &&right);
+
+    /// @brief in-place union by splitting and joining trees
+    /// @param other the set to add; on equal elements its values are kept
+    /// @param threads recurse into both halves on up to this many threads
+    /// @return a reference to this set
+    /// @note O(m log(n / m + 1)) work for sets of sizes m <= n, plus copying
+    ///       `other`'s nodes into this set
+    TreeSet &unite(const TreeSet &other, unsigned threads = 1);
+
+    /// @brief in-place intersection by splitting and joining trees
+    /// @param other the set to intersect with; values of this set are kept
+    /// @param threads recurse into both halves on up to this many threads
+    /// @return a reference to this set
+    /// @note O(m log(n / m + 1)) work for sets of sizes m <= n, plus
+    ///       destroying the elements removed
+    TreeSet &intersect(const TreeSet &other, unsigned threads = 1);
+
+    /// @brief in-place difference by splitting and joining trees
+    /// @param other the elements to remove
+    /// @param threads recurse into both halves on up to this many threads
+    /// @return a reference to this set
+    /// @note O(m log(n / m + 1)) work for sets of sizes m <= n
+    TreeSet &subtract(const TreeSet &other, unsigned threads = 1);
 
     /// @brief set uniom
     /// @param other another set to be unioned
     /// @return the result of the union
-    TreeSet operator+(const TreeSet &other);
+    TreeSet operator+(const TreeSet &other) const;
 
     /// @brief in-place set union
     /// @param other another set to be unioned
@@ -92,7 +700,17 @@ public:
     /// @brief set intersection
     /// @param other another set
     /// @return the result of the intersection
-    TreeSet operator&(const TreeSet &other);
+    TreeSet operator&(const TreeSet &other) const;
+
+    /// @brief set difference
+    /// @param other another set
+    /// @return the elements of this set that are not in `other`
+    TreeSet operator-(const TreeSet &other) const;
+
+    /// @brief symmetric set difference
+    /// @param other another set
+    /// @return the elements that are in exactly one of the two sets
+    TreeSet operator^(const TreeSet &other) const;
 
     /// @brief set equal
     /// @param other another set
@@ -106,6 +724,7 @@ public:
 
     /// @brief check if the tree is balanced
     /// @return true if the tree is balanced, otherwise false
+    /// @note O(n); see `is_valid()` to also check the ordering
     bool is_balanced() const
     {
         if (!_root)
@@ -113,6 +732,49 @@ public:
         return _root->is_rbtree();
     }
 
+    /// @brief check every invariant of the tree: the red-black properties,
+    ///        parent links, strictly increasing order and the element count
+    /// @return true if the tree is well formed, otherwise false
+    /// @note O(n) in a single pass. Compile with `TREE_SET_VERIFY_PATHS`
+    ///       defined to instead assert, after every insert and erase, only
+    ///       the invariants along the path it touched.
+    bool is_valid() const;
+
+    /// @brief keep a blocked Bloom filter of the elements, which `contains`,
+    ///        `get` and `remove` check before descending: most lookups of
+    ///        absent elements then read one cache line instead of O(log n) nodes
+    /// @param bits_per_element filter size; 10 gives at most about 1% false
+    ///        positives. The filter has room for twice the elements, so it
+    ///        takes up to `2 * bits_per_element / 8` bytes per element.
+    /// @param hash hash of the elements; elements that compare equal must hash equal
+    /// @throw std::invalid_argument if no hash is given and `std::hash<T>` does not exist
+    /// @note inserts add to the filter. Removals leave their bits set until
+    ///       they outnumber the elements, and then the filter is rebuilt in
+    ///       O(n), as it is when it fills up: it is sized for twice the
+    ///       elements it was last built from.
+    void enable_filter(double bits_per_element = 10, FilterHash<T> hash = FilterHash<T>());
+
+    /// @brief drop the filter
+    void disable_filter();
+
+    /// @brief bytes of filter bits, or 0 without a filter
+    size_t filter_bytes() const;
+
+    /// @brief number of times the set asked for node storage
+    /// @return the number of node chunks allocated so far; arena pages with
+    ///        `CompactNode`
+    /// @note divide by `size()` to get allocations per insert
+    size_t allocation_count() const { return _pool.chunk_allocations(); }
+
+    /// @brief bytes of node storage used per element
+    /// @return the size of one node slot in the pool
+    static constexpr size_t bytes_per_node() { return Pool::bytes_per_node(); }
+
+    /// @brief node storage held per element, counting free slots and, with
+    ///        `CompactNode`, each arena page's share of its chunk
+    /// @return 0 for an empty set
+    double bytes_per_element() const;
+
     /// @brief remove every element in the set
     void clear();
     virtual ~TreeSet();
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <map>
+#include <random>
+#include "ArtMap.cpp"
+
+using Entries = std::vector<std::pair<std::string, int>>;
+
+TEST(ArtMapTest, InsertGetAndOverwrite)
+{
+    ArtMap<int, std::string> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.insert(i, std::to_string(i));
+    }
+    map.insert(7, "seven");
+
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_EQ(map.get(7), "seven");
+    ASSERT_EQ(map.get(999), "999");
+    ASSERT_EQ(map.get(1000), std::nullopt);
+    ASSERT_TRUE(map.contains(0));
+    ASSERT_TRUE(map.is_valid());
+}
+
+TEST(ArtMapTest, IntegerKeysKeepNumericOrder)
+{
+    ArtMap<int64_t, int> map;
+    std::vector<int64_t> keys = { 0, -1, 1, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), 256, -256, 255 };
+    for (int64_t key : keys)
+    {
+        map.insert(key, 1);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int64_t> result;
+    for (const auto &entry : map)
+    {
+        result.push_back(entry.first);
+    }
+    ASSERT_EQ(result, keys);
+    ASSERT_EQ((--map.end())->first, std::numeric_limits<int64_t>::max());
+    ASSERT_EQ(map.lower_bound(2)->first, 255);
+    ASSERT_EQ(map.upper_bound(-256)->first, -1);
+}
+
+TEST(ArtMapTest, StringKeysThatArePrefixesOfEachOther)
+{
+    ArtMap<std::string, int> map;
+    std::vector<std::string> keys = { "", "a", "ab", "abc", "abcdefghijklmnopqrstuvwxyz", "abcdefghijklmnopqrstuvwxyz0",
+                                      "abcdefghijklmnopq", "b", std::string("a\0b", 3), "\xff" };
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        map.insert(keys[i], static_cast<int>(i));
+        ASSERT_TRUE(map.is_valid()) << i;
+    }
+    std::map<std::string, int> expected;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        expected[keys[i]] = static_cast<int>(i);
+    }
+    ASSERT_EQ(map.to_vector(), Entries(expected.begin(), expected.end()));
+
+    ASSERT_FALSE(map.contains("abcd"));
+    ASSERT_FALSE(map.contains("abcdefghijklmnopqrstuvwxyY"));
+    ASSERT_EQ(map.lower_bound("abcd")->first, "abcdefghijklmnopq");
+    ASSERT_EQ(map.lower_bound("abcdefghijklmnopqrstuvwxz")->first, "b");
+    ASSERT_EQ(map.upper_bound("\xff"), map.end());
+
+    for (const auto &key : keys)
+    {
+        ASSERT_TRUE(map.remove(key)) << key;
+        ASSERT_FALSE(map.remove(key)) << key;
+        ASSERT_TRUE(map.is_valid()) << key;
+    }
+    ASSERT_TRUE(map.is_empty());
+}
+
+TEST(ArtMapTest, MatchesStdMapUnderRandomOperations)
+{
+    // keys share long prefixes and fan out widely, so every node type grows and shrinks
+    std::mt19937 rng(7);
+    auto random_key = [&] {
+        std::string key = "/api/v1/items/";
+        size_t length = rng() % 4;
+        for (size_t i = 0; i < length; ++i)
+        {
+            key.push_back(static_cast<char>(rng() % 200));
+        }
+        return key;
+    };
+
+    ArtMap<std::string, int> map;
+    std::map<std::string, int> expected;
+    for (int step = 0; step < 40000; ++step)
+    {
+        std::string key = random_key();
+        switch (rng() % 4)
+        {
+        case 0:
+        case 1:
+            map.insert(key, step);
+            expected[key] = step;
+            break;
+        case 2:
+            ASSERT_EQ(map.remove(key), expected.erase(key) == 1);
+            break;
+        default: {
+            auto it = map.lower_bound(key);
+            auto want = expected.lower_bound(key);
+            ASSERT_EQ(it == map.end(), want == expected.end());
+            if (want != expected.end())
+            {
+                ASSERT_EQ(it->first, want->first);
+                ASSERT_EQ(it->second, want->second);
+            }
+        }
+        }
+        if (step % 4000 == 0)
+        {
+            ASSERT_TRUE(map.is_valid());
+        }
+    }
+    ASSERT_TRUE(map.is_valid());
+    ASSERT_EQ(map.size(), expected.size());
+    ASSERT_EQ(map.to_vector(), Entries(expected.begin(), expected.end()));
+
+    std::vector<std::string> in_range;
+    for (const auto &entry : map.range("/api/v1/items/a", "/api/v1/items/b"))
+    {
+        in_range.push_back(entry.first);
+    }
+    std::vector<std::string> want;
+    for (auto it = expected.lower_bound("/api/v1/items/a"); it != expected.upper_bound("/api/v1/items/b"); ++it)
+    {
+        want.push_back(it->first);
+    }
+    ASSERT_EQ(in_range, want);
+}
+
+TEST(ArtMapTest, NodesGrowAndShrinkThroughEveryType)
+{
+    // 256 children under one node, then removed in an order that empties it from both ends
+    ArtMap<uint32_t, int> map;
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        map.insert(0x01020300 + i, static_cast<int>(i));
+    }
+    ASSERT_TRUE(map.is_valid());
+    for (uint32_t i = 0; i < 128; ++i)
+    {
+        ASSERT_TRUE(map.remove(0x01020300 + i));
+        ASSERT_TRUE(map.remove(0x010203ff - i));
+        ASSERT_TRUE(map.is_valid()) << i;
+        if (i < 127)
+        {
+            ASSERT_EQ(map.begin()->first, 0x01020301 + i);
+        }
+    }
+    ASSERT_TRUE(map.is_empty());
+    ASSERT_EQ(map.bytes_per_element(), 0);
+}
+
+TEST(ArtMapTest, CopyMoveAndSubscript)
+{
+    ArtMap<uint64_t, int> map({ { 3, 30 }, { 1, 10 }, { 2, 20 }, { 1, 11 } });
+    ASSERT_EQ(map.size(), 3);
+    ASSERT_EQ(map.get(1), 11);
+
+    ArtMap<uint64_t, int> copy = map;
+    copy[4] += 40;
+    copy[1]++;
+    ASSERT_EQ(copy.get(4), 40);
+    ASSERT_EQ(copy.get(1), 12);
+    ASSERT_EQ(map.get(1), 11);
+    ASSERT_FALSE(map.contains(4));
+
+    ArtMap<uint64_t, int> moved = std::move(copy);
+    ASSERT_EQ(moved.size(), 4);
+    ASSERT_TRUE(copy.is_empty());
+    map = moved;
+    ASSERT_EQ(map.to_vector(), moved.to_vector());
+    ASSERT_GT(map.bytes_per_element(), 0);
+
+    std::vector<int> values;
+    for (const auto &entry : map.range(2, 3))
+    {
+        values.push_back(entry.second);
+    }
+    ASSERT_EQ(values, std::vector<int>({ 20, 30 }));
+    ASSERT_TRUE(map.range(3, 2).empty());
+
+    map.clear();
+    ASSERT_TRUE(map.is_empty());
+    ASSERT_EQ(map.begin(), map.end());
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include "BTreeMap.cpp"
+
+TEST(BTreeMapTest, InsertGetAndOverwrite)
+{
+    BTreeMap<int, std::string> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.insert(i, std::to_string(i));
+    }
+    map.insert(7, "seven");
+
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_EQ(map.get(7), "seven");
+    ASSERT_EQ(map.get(999), "999");
+    ASSERT_EQ(map.get(1000), std::nullopt);
+    ASSERT_TRUE(map.contains(0));
+}
+
+TEST(BTreeMapTest, ToVectorAndRange)
+{
+    BTreeMap<std::string, int> map({ { "b", 2 }, { "a", 1 }, { "c", 3 } });
+
+    auto result = map.to_vector();
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_EQ(result[0].first, "a");
+
+    std::vector<int> values;
+    for (const auto &entry : map.range("b", "z"))
+    {
+        values.push_back(entry.second);
+    }
+    ASSERT_EQ(values, std::vector<int>({ 2, 3 }));
+
+    map.clear();
+    ASSERT_TRUE(map.is_empty());
+}
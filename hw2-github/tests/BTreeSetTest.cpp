@@ -0,0 +1,116 @@
+#include "BTreeSet.cpp"
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(BTreeSetTest, InstantiateEmptyTree)
+{
+    BTreeSet<int> s;
+
+    ASSERT_EQ(s.size(), 0);
+    ASSERT_TRUE(s.is_empty());
+    ASSERT_EQ(s.min(), std::nullopt);
+    ASSERT_TRUE(s.begin() == s.end());
+}
+
+TEST(BTreeSetTest, RandomInsertionsMatchStdSet)
+{
+    BTreeSet<int> s;
+    std::set<int> expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int value = rand() % 50000;
+        s.add(value);
+        expected.insert(value);
+    }
+
+    ASSERT_EQ(s.size(), expected.size());
+    ASSERT_TRUE(s.is_balanced());
+    ASSERT_EQ(s.to_vector(), std::vector<int>(expected.begin(), expected.end()));
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(s.contains(i), expected.count(i) == 1);
+    }
+    ASSERT_EQ(s.min(), *expected.begin());
+    ASSERT_EQ(s.max(), *expected.rbegin());
+}
+
+TEST(BTreeSetTest, SortedAndReverseInsertions)
+{
+    BTreeSet<int64_t> ascending;
+    BTreeSet<int64_t> descending;
+    for (int64_t i = 0; i < 5000; ++i)
+    {
+        ascending.add(i);
+        descending.add(4999 - i);
+    }
+
+    ASSERT_TRUE(ascending.is_balanced());
+    ASSERT_TRUE(descending.is_balanced());
+    ASSERT_EQ(ascending, descending);
+}
+
+TEST(BTreeSetTest, BulkBuildIsBalanced)
+{
+    for (int n = 0; n < 3000; n += 97)
+    {
+        std::vector<double> values;
+        for (int i = 0; i < n; ++i)
+        {
+            values.push_back(i * 0.5);
+        }
+        BTreeSet<double> s(values);
+        ASSERT_EQ(s.size(), static_cast<size_t>(n));
+        ASSERT_TRUE(s.is_balanced()) << "Bulk-built tree of size " << n << " is unbalanced";
+    }
+}
+
+TEST(BTreeSetTest, IteratorsAndBounds)
+{
+    BTreeSet<int, DefaultComparator<int>, 16> s({ 50, 10, 40, 20, 30 });
+
+    std::vector<int> backward;
+    for (auto it = s.end(); it != s.begin();)
+    {
+        backward.push_back(*--it);
+    }
+    ASSERT_EQ(backward, std::vector<int>({ 50, 40, 30, 20, 10 }));
+    ASSERT_EQ(*s.lower_bound(21), 30);
+    ASSERT_EQ(*s.upper_bound(30), 40);
+    ASSERT_TRUE(s.upper_bound(50) == s.end());
+
+    std::vector<int> in_range;
+    for (int x : s.range(15, 40))
+    {
+        in_range.push_back(x);
+    }
+    ASSERT_EQ(in_range, std::vector<int>({ 20, 30, 40 }));
+}
+
+TEST(BTreeSetTest, CustomComparatorAndStrings)
+{
+    auto descending = [](const std::string &a, const std::string &b) { return (a > b) ? -1 : (a < b) ? 1 : 0; };
+    BTreeSet<std::string> s(descending);
+    for (int i = 0; i < 300; ++i)
+    {
+        s.add(std::to_string(i));
+    }
+
+    ASSERT_TRUE(s.is_balanced());
+    ASSERT_EQ(s.min(), "99");
+    ASSERT_TRUE(s.contains("150"));
+    ASSERT_FALSE(s.contains("300"));
+}
+
+TEST(BTreeSetTest, SetOperations)
+{
+    BTreeSet<int> s1({ 1, 2, 3, 4, 5 });
+    BTreeSet<int> s2({ 4, 5, 6, 7 });
+
+    ASSERT_EQ((s1 + s2).to_vector(), std::vector<int>({ 1, 2, 3, 4, 5, 6, 7 }));
+    ASSERT_EQ((s1 & s2).to_vector(), std::vector<int>({ 4, 5 }));
+    ASSERT_EQ((s1 - s2).to_vector(), std::vector<int>({ 1, 2, 3 }));
+    ASSERT_EQ((s1 ^ s2).to_vector(), std::vector<int>({ 1, 2, 3, 6, 7 }));
+
+    s1 += s2;
+    ASSERT_EQ(s1.size(), 7);
+}
@@ -1,6 +1,7 @@
 
 #include "TreeSet.cpp"
 #include <gtest/gtest.h>
+#include <set>
 
 class BalancedTreeSetTest : public ::testing::Test {
 protected:
@@ -80,4 +81,122 @@ TEST_F(BalancedTreeSetTest, LargeNumberOfInsertions) {
         }
     }
     ASSERT_TRUE(tree.is_balanced());
-}
\ No newline at end of file
+}
+TEST_F(BalancedTreeSetTest, BulkBuildIsBalanced) {
+    for (int n = 0; n <= 130; ++n) {
+        std::vector<int> values;
+        for (int i = n; i > 0; --i) {
+            values.push_back(i);
+            values.push_back(i); // duplicates are dropped
+        }
+        TreeSet<int> s(values);
+        ASSERT_EQ(s.size(), static_cast<size_t>(n));
+        ASSERT_TRUE(s.is_balanced()) << "Bulk-built tree of size " << n << " is unbalanced";
+
+        // the bulk-built tree must keep accepting inserts
+        s.add(n + 1);
+        s.add(-n);
+        ASSERT_TRUE(s.is_balanced()) << "Tree of size " << n << " became unbalanced after inserting";
+    }
+}
+
+TEST(OrderStatisticsTest, RankSelectAfterRandomInsertions) {
+    TreeSet<int, DefaultComparator<int>, OrderStatistics> s;
+    std::vector<int> inserted;
+    for (int i = 0; i < 500; ++i) {
+        int value = rand() % 1000;
+        s.add(value);
+        inserted.push_back(value);
+    }
+    ASSERT_TRUE(s.is_balanced());
+
+    std::vector<int> sorted = s.to_vector();
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        ASSERT_EQ(s.select(k), sorted[k]);
+        ASSERT_EQ(s.rank(sorted[k]), k);
+    }
+    ASSERT_EQ(s.select(sorted.size()), std::nullopt);
+    ASSERT_EQ(s.count_range(100, 199),
+              static_cast<size_t>(std::count_if(sorted.begin(), sorted.end(), [](int x) { return x >= 100 && x <= 199; })));
+}
+
+TEST(OrderStatisticsTest, SizesSurviveBulkBuildAndCopy) {
+    std::vector<int> values;
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(i * 2);
+    }
+    TreeSet<int, DefaultComparator<int>, OrderStatistics> s(values);
+    auto copy = s;
+    copy.add(51);
+
+    ASSERT_EQ(s.rank(52), 26);
+    ASSERT_EQ(copy.rank(52), 27);
+    ASSERT_EQ(copy.select(26), 51);
+    ASSERT_EQ(copy.count_range(0, 51), 27);
+    ASSERT_EQ(TreeSet<int>::bytes_per_node(), sizeof(BinaryTreeNode<int>));
+}
+
+TEST_F(BalancedTreeSetTest, RandomRemovals) {
+    std::set<int> expected;
+    for (int i = 0; i < 2000; ++i) {
+        int value = rand() % 1000;
+        if (rand() % 3 == 0) {
+            ASSERT_EQ(tree.remove(value), expected.erase(value) == 1);
+        } else {
+            tree.add(value);
+            expected.insert(value);
+        }
+        if (i % 50 == 0) {
+            ASSERT_TRUE(tree.is_balanced()) << "Tree became unbalanced after operation " << i;
+        }
+    }
+    ASSERT_TRUE(tree.is_balanced());
+    ASSERT_EQ(tree.to_vector(), std::vector<int>(expected.begin(), expected.end()));
+
+    for (int value : expected) {
+        ASSERT_TRUE(tree.remove(value));
+        ASSERT_TRUE(tree.is_balanced()) << "Tree became unbalanced after removing " << value;
+    }
+    ASSERT_TRUE(tree.is_empty());
+}
+
+TEST_F(BalancedTreeSetTest, EraseRangeSplitsAndJoins) {
+    for (int i = 0; i < 1000; ++i) {
+        tree.add(i);
+    }
+    // a short range and a long one both cut the tree twice and join it once
+    ASSERT_EQ(tree.erase_range(100, 104), 5);
+    ASSERT_TRUE(tree.is_balanced());
+    ASSERT_EQ(tree.erase_range(200, 899), 700);
+    ASSERT_TRUE(tree.is_balanced());
+    ASSERT_EQ(tree.size(), 295);
+    ASSERT_EQ(*tree.lower_bound(100), 105);
+    ASSERT_EQ(*tree.lower_bound(200), 900);
+    ASSERT_EQ(tree.erase_range(5000, 6000), 0);
+
+    // ranges reaching either end, then everything
+    ASSERT_EQ(tree.erase_range(-10, 9), 10);
+    ASSERT_EQ(tree.erase_range(990, 2000), 10);
+    ASSERT_TRUE(tree.is_balanced());
+    ASSERT_EQ(tree.min(), 10);
+    ASSERT_EQ(tree.max(), 989);
+    ASSERT_EQ(tree.erase_range(0, 1000), 275);
+    ASSERT_TRUE(tree.is_empty());
+    tree.add(3);
+    ASSERT_TRUE(tree.is_balanced());
+}
+
+TEST(OrderStatisticsTest, SizesSurviveRemovals) {
+    TreeSet<int, DefaultComparator<int>, OrderStatistics> s;
+    for (int i = 0; i < 300; ++i) {
+        s.add(i);
+    }
+    for (int i = 0; i < 300; i += 3) {
+        s.remove(i);
+    }
+    ASSERT_TRUE(s.is_balanced());
+    std::vector<int> sorted = s.to_vector();
+    for (size_t k = 0; k < sorted.size(); ++k) {
+        ASSERT_EQ(s.select(k), sorted[k]);
+    }
+}
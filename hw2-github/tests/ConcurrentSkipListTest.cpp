@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include "ConcurrentSkipList.cpp"
+
+TEST(ConcurrentSkipListTest, MatchesStdSetOnOneThread)
+{
+    std::mt19937 rng(3);
+    std::set<int> expected;
+    ConcurrentSkipList<int> s;
+    ASSERT_TRUE(s.is_empty());
+    ASSERT_EQ(s.min(), std::nullopt);
+    ASSERT_EQ(s.max(), std::nullopt);
+    for (int i = 0; i < 20000; ++i)
+    {
+        int v = rng() % 5000;
+        if (rng() % 3)
+        {
+            ASSERT_EQ(s.add(v), expected.insert(v).second);
+        }
+        else
+        {
+            ASSERT_EQ(s.remove(v), expected.erase(v) == 1);
+        }
+    }
+    ASSERT_TRUE(s.is_valid());
+    ASSERT_EQ(s.size(), expected.size());
+    ASSERT_EQ(s.to_vector(), std::vector<int>(expected.begin(), expected.end()));
+    ASSERT_EQ(s.min(), *expected.begin());
+    ASSERT_EQ(s.max(), *expected.rbegin());
+    for (int v = -1; v <= 5000; ++v)
+    {
+        ASSERT_EQ(s.contains(v), expected.count(v) == 1);
+    }
+    ASSERT_EQ(s.get(*expected.begin()), *expected.begin());
+    ASSERT_EQ(s.get(-1), std::nullopt);
+
+    // removing the largest elements leaves dead nodes for max() to step over
+    ASSERT_TRUE(s.remove(*expected.rbegin()));
+    expected.erase(std::prev(expected.end()));
+    ASSERT_EQ(s.max(), *expected.rbegin());
+
+    s.clear();
+    ASSERT_TRUE(s.is_empty());
+    ASSERT_TRUE(s.is_valid());
+}
+
+TEST(ConcurrentSkipListTest, CustomComparatorAndStrings)
+{
+    ConcurrentSkipList<std::string> s([](const std::string &a, const std::string &b) { return a < b ? 1 : a > b ? -1 : 0; });
+    for (std::string word : { "pear", "apple", "fig", "apple" })
+    {
+        s.add(word);
+    }
+    ASSERT_EQ(s.size(), 3);
+    ASSERT_EQ(s.to_vector(), (std::vector<std::string>{ "pear", "fig", "apple" }));
+    ASSERT_EQ(s.min(), "pear");
+    ASSERT_EQ(s.max(), "apple");
+}
+
+// no default constructor: the head sentinel must not need a value
+struct Ticket
+{
+    explicit Ticket(int id) : id(id) {}
+    int id;
+    bool operator<(const Ticket &other) const { return id < other.id; }
+    bool operator>(const Ticket &other) const { return id > other.id; }
+};
+
+TEST(ConcurrentSkipListTest, ValuesNeedNoDefaultConstructor)
+{
+    ConcurrentSkipList<Ticket> s;
+    for (int id : { 3, 1, 2 })
+    {
+        ASSERT_TRUE(s.add(Ticket(id)));
+    }
+    ASSERT_TRUE(s.remove(Ticket(2)));
+    ASSERT_EQ(s.min()->id, 1);
+    ASSERT_EQ(s.max()->id, 3);
+    ASSERT_TRUE(s.is_valid());
+}
+
+TEST(ConcurrentSkipListTest, ConcurrentDisjointAdds)
+{
+    const int threads = 4, per_thread = 20000;
+    ConcurrentSkipList<int> s;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&s, t] {
+            for (int i = 0; i < per_thread; ++i)
+            {
+                s.add(i * threads + t);
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    ASSERT_EQ(s.size(), threads * per_thread);
+    ASSERT_TRUE(s.is_valid());
+    std::vector<int> values = s.to_vector();
+    for (int i = 0; i < threads * per_thread; ++i)
+    {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST(ConcurrentSkipListTest, ConcurrentAddRemoveAndReads)
+{
+    // writers fight over a small key range; each key's final presence is
+    // decided by how many times it was added and removed successfully
+    const int threads = 4, keys = 512, ops = 20000;
+    ConcurrentSkipList<int> s;
+    std::vector<std::atomic<int>> balance(keys);
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> reads{0};
+
+    std::thread reader([&] {
+        while (!stop.load())
+        {
+            int last = -1;
+            for (int v : s)
+            {
+                if (v <= last || v >= keys) std::abort(); // always in order
+                last = v;
+            }
+            reads += s.contains(keys / 2) + s.get(1).has_value();
+            s.min();
+            s.max();
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            for (int i = 0; i < ops; ++i)
+            {
+                int v = rng() % keys;
+                if (rng() % 2)
+                {
+                    balance[v] += s.add(v);
+                }
+                else
+                {
+                    balance[v] -= s.remove(v);
+                }
+            }
+        });
+    }
+    for (std::thread &writer : writers)
+    {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+
+    ASSERT_TRUE(s.is_valid());
+    size_t present = 0;
+    for (int v = 0; v < keys; ++v)
+    {
+        ASSERT_TRUE(balance[v] == 0 || balance[v] == 1);
+        ASSERT_EQ(s.contains(v), balance[v] == 1);
+        present += balance[v];
+    }
+    ASSERT_EQ(s.size(), present);
+}
+
+TEST(ConcurrentSkipListTest, RemovedNodesAreReclaimed)
+{
+    ConcurrentSkipList<int> s;
+    for (int i = 0; i < 10000; ++i)
+    {
+        s.add(i);
+        s.remove(i);
+    }
+    // with no thread pinned, everything but the last few batches is freed
+    ASSERT_LT(EpochReclaimer::instance().pending(), 256);
+
+    // an iterator keeps its nodes alive while others remove them
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+    auto it = s.begin();
+    std::thread remover([&s] {
+        for (int i = 0; i < 100; ++i)
+        {
+            s.remove(i);
+        }
+    });
+    remover.join();
+    ASSERT_EQ(*it, 0);
+    ++it;
+    ASSERT_TRUE(it == s.end());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <set>
+#include "TreeSet.cpp"
+
+TEST(FrozenTreeSetTest, FreezeKeepsElementsInOrder)
+{
+    TreeSet<int> s({ 5, 1, 9, 3, 7 });
+    FrozenTreeSet<int> frozen = s.freeze();
+
+    ASSERT_EQ(frozen.size(), 5);
+    ASSERT_EQ(frozen.to_vector(), std::vector<int>({ 1, 3, 5, 7, 9 }));
+    ASSERT_EQ(frozen.min(), 1);
+    ASSERT_EQ(frozen.max(), 9);
+    ASSERT_TRUE(frozen.contains(7));
+    ASSERT_FALSE(frozen.contains(4));
+}
+
+TEST(FrozenTreeSetTest, EmptySet)
+{
+    FrozenTreeSet<int> frozen = TreeSet<int>().freeze();
+
+    ASSERT_TRUE(frozen.is_empty());
+    ASSERT_FALSE(frozen.contains(0));
+    ASSERT_EQ(frozen.begin(), frozen.end());
+    ASSERT_EQ(frozen.lower_bound(0), frozen.end());
+    ASSERT_EQ(frozen.rank(0), 0);
+    ASSERT_EQ(frozen.min(), std::nullopt);
+}
+
+TEST(FrozenTreeSetTest, BoundsAndRankMatchSortedVector)
+{
+    // every size up to a few full levels, so each shape of the last level is hit
+    std::mt19937 rng(3);
+    for (size_t n = 1; n < 70; ++n)
+    {
+        std::vector<int64_t> keys;
+        for (size_t i = 0; i < n; ++i)
+        {
+            keys.push_back(static_cast<int64_t>(i) * 3);
+        }
+        std::shuffle(keys.begin(), keys.end(), rng);
+        FrozenTreeSet<int64_t> frozen(keys);
+        std::sort(keys.begin(), keys.end());
+        ASSERT_EQ(frozen.to_vector(), keys);
+
+        for (int64_t x = -1; x <= static_cast<int64_t>(n) * 3; ++x)
+        {
+            auto expected_lo = std::lower_bound(keys.begin(), keys.end(), x);
+            auto expected_hi = std::upper_bound(keys.begin(), keys.end(), x);
+            auto lo = frozen.lower_bound(x);
+            auto hi = frozen.upper_bound(x);
+            ASSERT_EQ(lo == frozen.end(), expected_lo == keys.end());
+            ASSERT_EQ(hi == frozen.end(), expected_hi == keys.end());
+            if (lo != frozen.end())
+            {
+                ASSERT_EQ(*lo, *expected_lo);
+            }
+            if (hi != frozen.end())
+            {
+                ASSERT_EQ(*hi, *expected_hi);
+            }
+            ASSERT_EQ(frozen.rank(x), size_t(expected_lo - keys.begin()));
+            ASSERT_EQ(frozen.contains(x), std::binary_search(keys.begin(), keys.end(), x));
+        }
+    }
+}
+
+TEST(FrozenTreeSetTest, IteratesBackward)
+{
+    FrozenTreeSet<double> frozen({ 0.5, 2.5, 1.5, 3.5, 4.5, 5.5 });
+    std::vector<double> reversed;
+    for (auto it = frozen.end(); it != frozen.begin();)
+    {
+        reversed.push_back(*--it);
+    }
+
+    ASSERT_EQ(reversed, std::vector<double>({ 5.5, 4.5, 3.5, 2.5, 1.5, 0.5 }));
+}
+
+TEST(FrozenTreeSetTest, CustomComparatorAndDuplicates)
+{
+    auto descending = [](int a, int b) { return (a > b) ? -1 : (a < b) ? 1 : 0; };
+    TreeSet<int> s({ 1, 4, 2, 4, 3 }, descending);
+    FrozenTreeSet<int> frozen = s.freeze();
+
+    ASSERT_EQ(frozen.to_vector(), std::vector<int>({ 4, 3, 2, 1 }));
+    ASSERT_EQ(*frozen.lower_bound(5), 4);
+    ASSERT_EQ(frozen.rank(2), 2);
+    ASSERT_EQ(FrozenTreeSet<int>({ 2, 2, 1 }).size(), 2);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include "MappedTreeSet.cpp"
+#include "TreeMap.cpp"
+
+static std::string temp_path(const std::string &name)
+{
+    return ::testing::TempDir() + name;
+}
+
+TEST(MappedTreeSetTest, SaveAndLoadSet)
+{
+    std::string path = temp_path("set.run");
+    std::vector<int64_t> items;
+    for (int64_t i = 0; i < 100000; ++i)
+    {
+        items.push_back((i * 7919) % 100003);
+    }
+    TreeSet<int64_t> s(items);
+    s.save(path);
+
+    for (unsigned threads : { 1u, 4u })
+    {
+        TreeSet<int64_t> loaded;
+        loaded.add(-1); // replaced by load
+        loaded.load(path, threads);
+        ASSERT_EQ(loaded.size(), s.size());
+        ASSERT_TRUE(loaded.is_valid());
+        ASSERT_EQ(loaded, s);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(MappedTreeSetTest, ServeSetFromFile)
+{
+    std::string path = temp_path("mapped.run");
+    TreeSet<int>({ 50, 10, 40, 20, 30 }).save(path);
+
+    MappedTreeSet<int> mapped(path);
+    ASSERT_EQ(mapped.size(), 5);
+    ASSERT_TRUE(mapped.contains(30));
+    ASSERT_FALSE(mapped.contains(35));
+    ASSERT_EQ(mapped.get(40), 40);
+    ASSERT_EQ(mapped.get(41), std::nullopt);
+    ASSERT_EQ(*mapped.lower_bound(35), 40);
+    ASSERT_EQ(*mapped.upper_bound(40), 50);
+    ASSERT_EQ(mapped.upper_bound(50), mapped.end());
+    ASSERT_EQ(mapped.rank(35), 3);
+    ASSERT_EQ(mapped.to_vector(), std::vector<int>({ 10, 20, 30, 40, 50 }));
+    std::remove(path.c_str());
+}
+
+TEST(MappedTreeSetTest, EmptySet)
+{
+    std::string path = temp_path("empty.run");
+    TreeSet<int>().save(path);
+
+    MappedTreeSet<int> mapped(path);
+    ASSERT_TRUE(mapped.is_empty());
+    ASSERT_FALSE(mapped.contains(0));
+    TreeSet<int> loaded({ 1, 2 });
+    loaded.load(path);
+    ASSERT_TRUE(loaded.is_empty());
+    std::remove(path.c_str());
+}
+
+TEST(MappedTreeSetTest, SaveAndLoadMap)
+{
+    std::string path = temp_path("map.run");
+    TreeMap<int, double> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.insert(i * 3, i / 2.0);
+    }
+    map.save(path);
+
+    TreeMap<int, double> loaded;
+    loaded.load(path);
+    ASSERT_EQ(loaded.to_vector(), map.to_vector());
+    ASSERT_EQ(loaded.get(300), 50.0);
+
+    MappedTreeMap<int, double> mapped(path);
+    ASSERT_EQ(mapped.size(), 1000);
+    ASSERT_EQ(mapped.get(300), 50.0);
+    ASSERT_EQ(mapped.get(301), std::nullopt);
+    ASSERT_TRUE(mapped.contains(2997));
+    ASSERT_EQ(mapped.lower_bound(301)->first, 303);
+    std::remove(path.c_str());
+}
+
+struct DescendingOrder
+{
+    int operator()(int a, int b) const { return (a > b) ? -1 : (a < b) ? 1 : 0; }
+};
+
+TEST(MappedTreeSetTest, RejectsBadFiles)
+{
+    ASSERT_THROW(MappedTreeSet<int>(temp_path("missing.run")), std::system_error);
+
+    std::string path = temp_path("ints.run");
+    TreeSet<int>({ 1, 2, 3 }).save(path);
+    // different record type
+    ASSERT_THROW(MappedTreeSet<int64_t>{ path }, std::runtime_error);
+    // saved under another order
+    TreeSet<int, DescendingOrder> descending;
+    ASSERT_THROW(descending.load(path), std::runtime_error);
+
+    // not a sorted-run file at all
+    FILE *file = std::fopen(path.c_str(), "wb");
+    std::fputs("key,value\n1,2\n3,4\n5,6\n7,8\n9,10\n", file);
+    std::fclose(file);
+    ASSERT_THROW(MappedTreeSet<int>{ path }, std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include "PersistentTreeSet.cpp"
+
+TEST(PersistentTreeSetTest, AddRemoveContains)
+{
+    PersistentTreeSet<int> s({ 5, 3, 8, 1, 4 });
+
+    ASSERT_EQ(s.size(), 5);
+    ASSERT_TRUE(s.contains(4));
+    ASSERT_TRUE(s.remove(4));
+    ASSERT_FALSE(s.remove(4));
+    ASSERT_FALSE(s.contains(4));
+    s.add(3);
+    ASSERT_EQ(s.snapshot().to_vector(), std::vector<int>({ 1, 3, 5, 8 }));
+}
+
+TEST(PersistentTreeSetTest, SnapshotsDoNotSeeLaterWrites)
+{
+    PersistentTreeSet<int> s;
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+    auto before = s.snapshot();
+    for (int i = 0; i < 100; i += 2)
+    {
+        s.remove(i);
+    }
+    s.add(1000);
+    auto after = s.snapshot();
+
+    ASSERT_EQ(before.size(), 100);
+    ASSERT_TRUE(before.contains(0));
+    ASSERT_FALSE(before.contains(1000));
+    ASSERT_EQ(after.size(), 51);
+    ASSERT_FALSE(after.contains(0));
+    ASSERT_EQ(after.max(), 1000);
+    ASSERT_TRUE(before.is_balanced());
+    ASSERT_TRUE(after.is_balanced());
+}
+
+TEST(PersistentTreeSetTest, RandomOperationsMatchStdSet)
+{
+    std::mt19937 rng(7);
+    PersistentTreeSet<int> s;
+    std::set<int> expected;
+    for (int i = 0; i < 4000; ++i)
+    {
+        int key = rng() % 500;
+        if (rng() % 3 == 0)
+        {
+            ASSERT_EQ(s.remove(key), expected.erase(key) == 1);
+        }
+        else
+        {
+            s.add(key);
+            expected.insert(key);
+        }
+        if (i % 97 == 0)
+        {
+            ASSERT_TRUE(s.snapshot().is_balanced());
+        }
+    }
+
+    auto snapshot = s.snapshot();
+    ASSERT_TRUE(snapshot.is_balanced());
+    ASSERT_EQ(snapshot.to_vector(), std::vector<int>(expected.begin(), expected.end()));
+}
+
+TEST(PersistentTreeSetTest, BulkConstructorBuildsBalancedTrees)
+{
+    // perfect and non-perfect sizes, with duplicates in any order
+    for (int n : { 0, 1, 2, 3, 7, 8, 100, 1023, 1024, 5000 })
+    {
+        std::vector<int> items;
+        for (int i = 0; i < n; ++i)
+        {
+            items.push_back((i * 7919) % n);
+            items.push_back(i);
+        }
+        PersistentTreeSet<int> s(items);
+        ASSERT_EQ(s.size(), static_cast<size_t>(n));
+        auto snapshot = s.snapshot();
+        ASSERT_TRUE(snapshot.is_balanced());
+        ASSERT_EQ(snapshot.to_vector().size(), static_cast<size_t>(n));
+        ASSERT_TRUE(snapshot.is_empty() || (snapshot.min() == 0 && snapshot.max() == n - 1));
+    }
+
+    // the last of equal entries wins, as with repeated adds
+    PersistentTreeMap<std::string, int> map({ { "a", 1 }, { "b", 2 }, { "a", 3 } });
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(map.snapshot().get(std::string("a"))->second, 3);
+}
+
+TEST(PersistentTreeSetTest, SnapshotOutlivesItsSet)
+{
+    auto s = std::make_unique<PersistentTreeSet<int>>(std::vector<int>{ 1, 2, 3 });
+    auto snapshot = s->snapshot();
+    s->add(4);
+    s.reset();
+    ASSERT_EQ(snapshot.to_vector(), std::vector<int>({ 1, 2, 3 }));
+}
+
+TEST(PersistentTreeSetTest, MapLooksUpByKey)
+{
+    PersistentTreeMap<std::string, int> map;
+    map.add({ "b", 2 });
+    map.add({ "a", 1 });
+    map.add({ "a", 10 });
+
+    auto snapshot = map.snapshot();
+    ASSERT_EQ(snapshot.size(), 2);
+    ASSERT_EQ(snapshot.get(std::string("a"))->second, 10);
+    ASSERT_TRUE(map.remove(std::string("b")));
+    ASSERT_TRUE(snapshot.contains(std::string("b")));
+}
+
+TEST(PersistentTreeSetTest, ReadersRunDuringWrites)
+{
+    PersistentTreeSet<int> s;
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(2 * i); // even keys are never removed
+    }
+
+    std::atomic<bool> done{ false };
+    std::atomic<int> failures{ 0 };
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&] {
+            while (!done)
+            {
+                auto snapshot = s.snapshot();
+                for (int i = 0; i < 1000; i += 37)
+                {
+                    failures += !snapshot.contains(2 * i);
+                }
+                failures += !snapshot.is_balanced();
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i)
+    {
+        s.add(2 * (i % 500) + 1);
+        s.remove(2 * ((i + 250) % 500) + 1);
+    }
+    done = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+
+    ASSERT_EQ(failures, 0);
+    ASSERT_TRUE(s.snapshot().is_balanced());
+}
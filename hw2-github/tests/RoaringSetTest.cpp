@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <set>
+#include "RoaringSet.cpp"
+
+TEST(RoaringSetTest, AddContainsRemove)
+{
+    RoaringSet<uint32_t> s;
+    ASSERT_TRUE(s.is_empty());
+    ASSERT_EQ(s.min(), std::nullopt);
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        s.add(i * 3); // the first chunk passes 4096 values and becomes a bitmap
+    }
+    s.add(3);
+    ASSERT_EQ(s.size(), 10000);
+    ASSERT_TRUE(s.contains(29997));
+    ASSERT_FALSE(s.contains(29998));
+    ASSERT_EQ(s.min(), 0u);
+    ASSERT_EQ(s.max(), 29997u);
+
+    for (uint32_t i = 0; i < 10000; i += 2)
+    {
+        ASSERT_TRUE(s.remove(i * 3));
+        ASSERT_FALSE(s.remove(i * 3));
+    }
+    ASSERT_EQ(s.size(), 5000);
+    ASSERT_FALSE(s.contains(0));
+    ASSERT_TRUE(s.contains(3));
+    ASSERT_EQ(s.min(), 3u);
+}
+
+TEST(RoaringSetTest, MatchesStdSetAcrossContainerKinds)
+{
+    // sparse, dense and range-shaped chunks side by side
+    std::mt19937 rng(5);
+    std::set<uint32_t> expected;
+    for (int i = 0; i < 3000; ++i)
+    {
+        expected.insert(rng() % 65536);
+    }
+    for (int i = 0; i < 30000; ++i)
+    {
+        expected.insert(65536 + rng() % 65536);
+    }
+    for (uint32_t v = 5 * 65536 + 100; v < 7 * 65536 + 7; ++v)
+    {
+        expected.insert(v);
+    }
+    expected.insert(std::numeric_limits<uint32_t>::max());
+
+    RoaringSet<uint32_t> s(std::vector<uint32_t>(expected.begin(), expected.end()));
+    ASSERT_EQ(s.size(), expected.size());
+    ASSERT_EQ(s.to_vector(), std::vector<uint32_t>(expected.begin(), expected.end()));
+    ASSERT_EQ(s.max(), std::numeric_limits<uint32_t>::max());
+    ASSERT_LT(s.bytes_per_element(), 1.0);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint32_t v = rng() % (8 * 65536);
+        if (rng() % 2)
+        {
+            s.add(v);
+            expected.insert(v);
+        }
+        else
+        {
+            ASSERT_EQ(s.remove(v), expected.erase(v) == 1);
+        }
+        ASSERT_EQ(s.contains(v ^ 1), expected.count(v ^ 1) == 1);
+    }
+    ASSERT_EQ(s.size(), expected.size());
+    ASSERT_EQ(s.to_vector(), std::vector<uint32_t>(expected.begin(), expected.end()));
+    s.run_optimize();
+    ASSERT_EQ(s.to_vector(), std::vector<uint32_t>(expected.begin(), expected.end()));
+}
+
+TEST(RoaringSetTest, UnionAndIntersectionMatchStdAlgorithms)
+{
+    std::mt19937 rng(9);
+    auto random_set = [&](uint32_t density, uint32_t chunks) {
+        std::vector<uint32_t> v;
+        for (uint32_t c = 0; c < chunks; ++c)
+        {
+            for (uint32_t i = 0; i < density; ++i)
+            {
+                v.push_back(c * 65536 + rng() % 65536);
+            }
+        }
+        for (uint32_t i = 0; i < 5000; ++i)
+        {
+            v.push_back(3 * 65536 + i); // a run in both sets
+        }
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+        return v;
+    };
+
+    // arrays against arrays, bitmaps and runs in every pairing
+    for (uint32_t da : { 100u, 3000u, 20000u })
+    {
+        for (uint32_t db : { 50u, 4000u, 40000u })
+        {
+            std::vector<uint32_t> a = random_set(da, 5), b = random_set(db, 4);
+            RoaringSet<uint32_t> x(a), y(b);
+            std::vector<uint32_t> united, common;
+            std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(united));
+            std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(common));
+
+            ASSERT_EQ((x + y).to_vector(), united) << da << " " << db;
+            ASSERT_EQ((x & y).to_vector(), common) << da << " " << db;
+            ASSERT_EQ((x & y).size(), common.size());
+            RoaringSet<uint32_t> z = x;
+            z += y;
+            ASSERT_TRUE(z == x + y);
+            z &= y;
+            ASSERT_TRUE(z == y);
+            ASSERT_TRUE(x != y);
+        }
+    }
+}
+
+TEST(RoaringSetTest, SignedAnd64BitValuesKeepOrder)
+{
+    std::vector<int64_t> values = { -1, 0, 1, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), -65536, 65536, 1LL << 40 };
+    RoaringSet<int64_t> s(values);
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(s.to_vector(), values);
+    ASSERT_EQ(s.min(), std::numeric_limits<int64_t>::min());
+    ASSERT_EQ(s.max(), std::numeric_limits<int64_t>::max());
+    ASSERT_TRUE(s.contains(-65536));
+    ASSERT_FALSE(s.contains(-65535));
+
+    RoaringSet<int> ints;
+    for (int v : { 5, -5, 0, -100000 })
+    {
+        ints.add(v);
+    }
+    ASSERT_EQ(ints.to_vector(), std::vector<int>({ -100000, -5, 0, 5 }));
+    ints.clear();
+    ASSERT_TRUE(ints.is_empty());
+    ASSERT_EQ(ints.begin(), ints.end());
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cctype>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include "ShardedTreeMap.cpp"
+
+using Entries = std::vector<std::pair<int, int>>;
+
+TEST(ShardedTreeMapTest, MatchesStdMapOnOneThread)
+{
+    std::mt19937 rng(9);
+    std::map<int, int> expected;
+    ShardedTreeMap<int, int> m(8);
+    ASSERT_TRUE(m.is_empty());
+    for (int i = 0; i < 20000; ++i)
+    {
+        int key = rng() % 4000 - 2000;
+        if (rng() % 3)
+        {
+            m.insert(key, i);
+            expected[key] = i;
+        }
+        else
+        {
+            ASSERT_EQ(m.remove(key), expected.erase(key) == 1);
+        }
+    }
+    ASSERT_EQ(m.size(), expected.size());
+    ASSERT_EQ(m.to_vector(), Entries(expected.begin(), expected.end()));
+    for (int key = -2001; key <= 2000; ++key)
+    {
+        auto it = expected.find(key);
+        ASSERT_EQ(m.contains(key), it != expected.end());
+        ASSERT_EQ(m.get(key), it == expected.end() ? std::nullopt : std::optional<int>(it->second));
+    }
+
+    Entries window(expected.lower_bound(-100), expected.upper_bound(250));
+    ASSERT_EQ(m.range(-100, 250), window);
+    ASSERT_TRUE(m.range(250, -100).empty());
+
+    m.clear();
+    ASSERT_TRUE(m.is_empty());
+    ASSERT_TRUE(m.to_vector().empty());
+}
+
+TEST(ShardedTreeMapTest, CustomComparatorNeedsMatchingHash)
+{
+    // case-insensitive keys: equal keys must land in the same shard
+    auto lower = [](std::string s) {
+        for (char &c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    };
+    auto compare = [&](const std::string &a, const std::string &b) {
+        int c = lower(a).compare(lower(b));
+        return c < 0 ? -1 : c > 0 ? 1 : 0;
+    };
+    auto hash = [&](const std::string &s) { return std::hash<std::string>()(lower(s)); };
+    ShardedTreeMap<std::string, int> m(4, compare, hash);
+    m.insert("Pear", 1);
+    m.insert("apple", 2);
+    m.insert("PEAR", 3);
+    m.insert("Fig", 4);
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(m.get("pear"), 3);
+    using Words = std::vector<std::pair<std::string, int>>;
+    ASSERT_EQ(m.to_vector(), (Words{ { "apple", 2 }, { "Fig", 4 }, { "Pear", 3 } }));
+}
+
+TEST(ShardedTreeMapTest, ConcurrentCountersAndSnapshots)
+{
+    const int threads = 4, keys = 1000, rounds = 20;
+    ShardedTreeMap<int, long> counts(16);
+    std::atomic<bool> stop{false};
+
+    std::thread reader([&] {
+        while (!stop.load())
+        {
+            // a snapshot is sorted and every count in it is in range
+            std::vector<std::pair<int, long>> snapshot = counts.to_vector();
+            for (size_t i = 0; i < snapshot.size(); ++i)
+            {
+                if ((i > 0 && snapshot[i - 1].first >= snapshot[i].first) || snapshot[i].second > threads * rounds)
+                {
+                    std::abort();
+                }
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t)
+    {
+        writers.emplace_back([&counts, t] {
+            for (int r = 0; r < rounds; ++r)
+            {
+                for (int k = 0; k < keys; ++k)
+                {
+                    counts.update((k * 7 + t) % keys, [](long &c) { return ++c; });
+                }
+            }
+        });
+    }
+    for (std::thread &writer : writers)
+    {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+
+    ASSERT_EQ(counts.size(), keys);
+    for (const auto &entry : counts.to_vector())
+    {
+        ASSERT_EQ(entry.second, threads * rounds);
+    }
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "TreeMap.cpp"
+#include <limits>
+#include <map>
+#include <memory>
 
 class TreeMapTest : public ::testing::Test {
 protected:
@@ -79,7 +82,318 @@ TEST_F(TreeMapTest, MultipleInsertionsSameKey) {
     ASSERT_EQ(map.get(1), "Uno"); // Ensure that the value is the new one
 }
 
+TEST(TreeMapComparatorTest, CustomKeyComparator) {
+    TreeMap<int, std::string> map([](int a, int b) { return (a > b) ? -1 : (a < b) ? 1 : 0; });
+    map.insert(1, "One");
+    map.insert(3, "Three");
+    map.insert(2, "Two");
+
+    auto result = map.to_vector();
+    ASSERT_EQ(result.size(), 3);
+    ASSERT_EQ(result[0].first, 3);
+    ASSERT_EQ(result[2].first, 1);
+    ASSERT_EQ(map.get(2), "Two");
+}
+
+TEST_F(TreeMapTest, IteratorsAndRange) {
+    for (int i = 1; i <= 5; ++i) {
+        map.insert(i * 10, std::to_string(i));
+    }
+
+    int expected_key = 10;
+    for (const auto &[key, value] : map) {
+        ASSERT_EQ(key, expected_key);
+        expected_key += 10;
+    }
+
+    ASSERT_EQ(map.lower_bound(25)->first, 30);
+    ASSERT_EQ(map.upper_bound(30)->second, "4");
+
+    std::vector<int> keys;
+    for (const auto &entry : map.range(20, 40)) {
+        keys.push_back(entry.first);
+    }
+    ASSERT_EQ(keys, std::vector<int>({ 20, 30, 40 }));
+}
+
+TEST(TreeMapOrderStatisticsTest, RankAndSelect) {
+    TreeMap<int, std::string, DefaultComparator<int>, OrderStatistics> map;
+    map.insert(30, "c");
+    map.insert(10, "a");
+    map.insert(20, "b");
+
+    ASSERT_EQ(map.rank(20), 1);
+    ASSERT_EQ(map.rank(25), 2);
+    ASSERT_EQ(map.select(2)->second, "c");
+    ASSERT_EQ(map.count_range(10, 20), 2);
+}
+
+TEST_F(TreeMapTest, RemoveKeys) {
+    for (int i = 0; i < 10; ++i) {
+        map.insert(i, std::to_string(i));
+    }
+
+    ASSERT_TRUE(map.remove(3));
+    ASSERT_FALSE(map.remove(3));
+    ASSERT_FALSE(map.contains(3));
+    ASSERT_EQ(map.erase_range(5, 7), 3);
+    ASSERT_EQ(map.size(), 6);
+    ASSERT_EQ(map.get(8), "8");
+}
+
+struct Widget {
+    int size;
+    explicit Widget(int size) : size(size) {}
+};
+
+TEST(TreeMapEmplaceTest, ValueWithoutDefaultConstructor) {
+    TreeMap<int, Widget> map;
+    ASSERT_TRUE(map.try_emplace(2, 20).second);
+    ASSERT_TRUE(map.try_emplace(1, 10).second);
+    map.insert(3, Widget(30));
+
+    ASSERT_TRUE(map.contains(2));
+    ASSERT_EQ(map.get(3)->size, 30);
+    ASSERT_EQ(map.lower_bound(2)->second.size, 20);
+    ASSERT_EQ(map.upper_bound(2)->first, 3);
+    ASSERT_FALSE(map.range(1, 2).empty());
+    ASSERT_TRUE(map.remove(1));
+    ASSERT_EQ(map.erase_range(2, 3), 2);
+    ASSERT_TRUE(map.is_empty());
+}
+
+TEST(TreeMapEmplaceTest, TryEmplaceKeepsExistingValue) {
+    TreeMap<std::string, std::string> map;
+    auto [first, inserted] = map.try_emplace("key", 3, 'a');
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(first->second, "aaa");
+
+    std::string value = "new";
+    auto [again, inserted_again] = map.try_emplace("key", std::move(value));
+    ASSERT_FALSE(inserted_again);
+    ASSERT_EQ(again->second, "aaa");
+    ASSERT_EQ(value, "new"); // untouched, nothing was moved from
+}
+
+TEST(TreeMapEmplaceTest, InsertOrAssign) {
+    TreeMap<std::string, std::unique_ptr<int>> map;
+    ASSERT_TRUE(map.insert_or_assign("a", std::make_unique<int>(1)).second);
+    auto [it, inserted] = map.insert_or_assign("a", std::make_unique<int>(2));
+
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(*it->second, 2);
+    ASSERT_EQ(map.size(), 1);
+}
+
+struct CountingCompare {
+    static size_t calls;
+    int operator()(int a, int b) const {
+        calls++;
+        return (a < b) ? -1 : (a > b) ? 1 : 0;
+    }
+};
+
+size_t CountingCompare::calls = 0;
+
+TEST(TreeMapUpsertTest, SubscriptCounts) {
+    TreeMap<std::string, int> counts;
+    for (const char *word : { "a", "b", "a", "c", "a", "b" }) {
+        counts[word] += 1;
+    }
+
+    ASSERT_EQ(counts.size(), 3);
+    ASSERT_EQ(counts.get("a"), 3);
+    ASSERT_EQ(counts.get("b"), 2);
+    ASSERT_EQ(counts.get("c"), 1);
+}
+
+TEST(TreeMapUpsertTest, FindOrInsertReturnsMutableValue) {
+    TreeMap<int, std::vector<int>> groups;
+    groups.find_or_insert(1).push_back(10);
+    groups.find_or_insert(1, 5, 0).push_back(11); // args ignored, key exists
+    groups.find_or_insert(2, 2, 7);
+
+    ASSERT_EQ(groups.get(1), std::vector<int>({ 10, 11 }));
+    ASSERT_EQ(groups.get(2), std::vector<int>({ 7, 7 }));
+}
+
+TEST(TreeMapUpsertTest, UpsertIsOneDescent) {
+    TreeMap<int, int, CountingCompare> map;
+    for (int i = 0; i < 1023; ++i) {
+        map.insert(i, i);
+    }
+
+    // a red-black tree with n nodes is at most 2 log2(n + 1) levels deep
+    const size_t max_depth = 20;
+    CountingCompare::calls = 0;
+    map[512] += 1;
+    ASSERT_LE(CountingCompare::calls, max_depth);
+
+    CountingCompare::calls = 0;
+    map.insert(700, 0);
+    ASSERT_LE(CountingCompare::calls, max_depth);
+
+    CountingCompare::calls = 0;
+    map.insert_or_assign(5000, 1);
+    ASSERT_LE(CountingCompare::calls, max_depth);
+
+    ASSERT_EQ(map.get(512), 513);
+    ASSERT_EQ(map.get(700), 0);
+    ASSERT_EQ(map.size(), 1024);
+}
+
+TEST_F(TreeMapTest, BatchLookupsMatchSingleLookups) {
+    for (int i = 0; i < 1000; i += 3) {
+        map.insert(i, std::to_string(i));
+    }
+    std::vector<int> keys;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back((i * 37) % 1005 - 2); // hits, misses and keys out of range
+    }
+
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    std::vector<std::optional<std::string>> values(keys.size());
+    map.contains_many(keys.data(), keys.size(), found.get());
+    map.get_many(keys.data(), keys.size(), values.data());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(found[i], map.contains(keys[i]));
+        ASSERT_EQ(values[i], map.get(keys[i]));
+    }
+
+    TreeMap<int, std::string> empty;
+    empty.contains_many(keys.data(), keys.size(), found.get());
+    ASSERT_FALSE(found[0]);
+}
+
+TEST(TreeMapUpsertTest, HintedAndIncreasingInserts) {
+    TreeMap<int, int, CountingCompare> map;
+    CountingCompare::calls = 0;
+    for (int i = 0; i < 10000; ++i) {
+        map.insert(i, i);
+    }
+    ASSERT_LE(CountingCompare::calls, 20000u);
+
+    auto it = map.insert(map.end(), 20000, 1);
+    ASSERT_EQ(it->first, 20000);
+    it = map.insert(it, 15000, 2);
+    ASSERT_EQ(it->second, 2);
+    it = map.insert(map.begin(), 15000, 3);
+    ASSERT_EQ(map.get(15000), 3);
+    ASSERT_EQ(map.size(), 10002);
+}
+
+TEST(TreeMapAggregateTest, RangeSumMinMaxMatchScan) {
+    TreeMap<int, long, DefaultComparator<int>, Aggregate<SumMonoid<long>>> sums;
+    TreeMap<int, long, DefaultComparator<int>, Aggregate<MinMonoid<long>>> mins;
+    TreeMap<int, long, DefaultComparator<int>, Aggregate<MaxMonoid<long>>> maxes;
+    std::map<int, long> expected;
+    uint32_t x = 2024;
+    for (int i = 0; i < 5000; ++i) {
+        x = x * 1664525u + 1013904223u;
+        int key = static_cast<int>(x % 2000);
+        long value = static_cast<long>(x >> 20) - 2000;
+        if (x & 0x8000) {
+            sums.remove(key);
+            mins.remove(key);
+            maxes.remove(key);
+            expected.erase(key);
+        } else {
+            sums.insert(key, value);
+            mins.insert(key, value);
+            maxes.insert_or_assign(key, value);
+            expected[key] = value;
+        }
+    }
+
+    for (int lo = -10; lo < 2010; lo += 97) {
+        for (int hi = lo - 5; hi < 2010; hi += 131) {
+            long sum = 0, min = std::numeric_limits<long>::max(), max = std::numeric_limits<long>::lowest();
+            for (auto it = expected.lower_bound(lo); it != expected.end() && it->first <= hi; ++it) {
+                sum += it->second;
+                min = std::min(min, it->second);
+                max = std::max(max, it->second);
+            }
+            ASSERT_EQ(sums.aggregate(lo, hi), sum);
+            ASSERT_EQ(mins.aggregate(lo, hi), min);
+            ASSERT_EQ(maxes.aggregate(lo, hi), max);
+        }
+    }
+}
+
+TEST(TreeMapAggregateTest, CountMatchesCountRange) {
+    TreeMap<int, int, DefaultComparator<int>, Aggregate<CountMonoid>> map;
+    for (int i = 0; i < 100; ++i) {
+        map.insert(i * 2, i);
+    }
+    ASSERT_EQ(map.aggregate(10, 20), 6u);
+    ASSERT_EQ(map.aggregate(11, 11), 0u);
+    ASSERT_EQ(map.aggregate(20, 10), 0u);
+    ASSERT_EQ(map.aggregate(-100, 1000), 100u);
+}
+
+TEST(TreeMapFilterTest, MissesSkipTheTree) {
+    TreeMap<int, int, CountingCompare> map;
+    for (int i = 0; i < 10000; ++i) {
+        map.insert(i * 2, i);
+    }
+    map.enable_filter();
+
+    CountingCompare::calls = 0;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_FALSE(map.get(i * 2 + 1).has_value());
+    }
+    ASSERT_LT(CountingCompare::calls, 10000u * 20 / 10);
+
+    // and so do the batch lookups
+    std::vector<int> misses, hits;
+    for (int i = 0; i < 10000; ++i) {
+        misses.push_back(i * 2 + 1);
+        hits.push_back(i * 2);
+    }
+    std::unique_ptr<bool[]> found(new bool[misses.size()]);
+    std::vector<std::optional<int>> values(misses.size());
+    CountingCompare::calls = 0;
+    map.contains_many(misses.data(), misses.size(), found.get());
+    map.get_many(misses.data(), misses.size(), values.data());
+    ASSERT_LT(CountingCompare::calls, 2 * 10000u * 20 / 10);
+    for (size_t i = 0; i < misses.size(); ++i) {
+        ASSERT_FALSE(found[i]);
+        ASSERT_FALSE(values[i].has_value());
+    }
+    map.get_many(hits.data(), hits.size(), values.data());
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(values[i], i);
+    }
+
+    for (int i = 0; i < 10000; ++i) {
+        map[i * 2 + 1] = -i;
+    }
+    ASSERT_TRUE(map.remove(4));
+    ASSERT_FALSE(map.remove(4));
+    for (int i = 0; i < 20000; ++i) {
+        ASSERT_EQ(map.contains(i), i != 4) << i;
+    }
+    ASSERT_EQ(map.get(7), -3);
+}
+
+TEST(TreeMapFilterTest, StringKeysAndCustomHash) {
+    TreeMap<std::string, int> words;
+    words.insert("apple", 1);
+    words.enable_filter(16);
+    words.insert("pear", 2);
+    ASSERT_EQ(words.get("pear"), 2);
+    ASSERT_FALSE(words.contains("plum"));
+
+    TreeMap<std::pair<int, int>, int> unhashable;
+    ASSERT_THROW(unhashable.enable_filter(), std::invalid_argument);
+    TreeMap<std::pair<int, int>, int> hashed;
+    hashed.enable_filter(10, [](const std::pair<int, int> &key) { return std::hash<int>()(key.first * 31 + key.second); });
+    hashed.insert({ 1, 2 }, 3);
+    ASSERT_EQ(hashed.get({ 1, 2 }), 3);
+    ASSERT_FALSE(hashed.contains({ 2, 1 }));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
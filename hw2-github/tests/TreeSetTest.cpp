@@ -1,5 +1,7 @@
 #include "TreeSet.cpp"
 #include <gtest/gtest.h>
+#include <memory>
+#include <set>
 
 TEST(TreeSetTest, InstantiateEmptyTree)
 {
@@ -279,3 +281,930 @@ TEST(TreeSetTest, AddingNegativeNumbers)
     ASSERT_EQ(s.size(), 3);
     ASSERT_EQ(s.to_vector(), std::vector<int>({ -3, -2, -1 }));
 }
+
+TEST(TreeSetTest, AllocatesNodesInChunks)
+{
+    TreeSet<int> s;
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+        s.add(i); // duplicate should not allocate
+    }
+
+    ASSERT_EQ(s.size(), 1000);
+    ASSERT_LT(s.allocation_count(), 10);
+    ASSERT_GE(TreeSet<int>::bytes_per_node(), sizeof(int));
+}
+
+TEST(TreeSetTest, CopyIsIndependent)
+{
+    TreeSet<std::string> s1({ "b", "a", "c" });
+    TreeSet<std::string> s2 = s1;
+    s2.add("d");
+    s1.clear();
+
+    ASSERT_EQ(s1.size(), 0);
+    ASSERT_EQ(s2.to_vector(), std::vector<std::string>({ "a", "b", "c", "d" }));
+    ASSERT_TRUE(s2.is_balanced());
+
+    s1 = s2;
+    ASSERT_EQ(s1, s2);
+}
+
+struct DescendingInt
+{
+    int operator()(const int &a, const int &b) const { return (a > b) ? -1 : (a < b) ? 1 : 0; }
+};
+
+TEST(TreeSetTest, CompileTimeComparator)
+{
+    TreeSet<int, DescendingInt> s({ 2, 4, 1, 3 });
+
+    ASSERT_EQ(s.to_vector(), std::vector<int>({ 4, 3, 2, 1 }));
+    ASSERT_TRUE(s.contains(3));
+    ASSERT_FALSE(s.contains(5));
+    ASSERT_TRUE(s.is_balanced());
+}
+
+// counts copies, so comparisons that take their arguments by value show up
+struct CopyCountedKey
+{
+    static int copies;
+    int key;
+
+    CopyCountedKey(int key) : key(key) {}
+    CopyCountedKey(const CopyCountedKey &other) : key(other.key) { copies++; }
+    bool operator<(const CopyCountedKey &other) const { return key < other.key; }
+    bool operator>(const CopyCountedKey &other) const { return key > other.key; }
+};
+
+int CopyCountedKey::copies = 0;
+
+TEST(TreeSetTest, RuntimeComparatorTakesReferences)
+{
+    auto by_key = [](const CopyCountedKey &a, const CopyCountedKey &b) { return (a.key < b.key) ? -1 : (a.key > b.key) ? 1 : 0; };
+    TreeSet<CopyCountedKey> s(by_key);
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(CopyCountedKey(i));
+    }
+    CopyCountedKey::copies = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        ASSERT_EQ(s.contains(CopyCountedKey(i)), i < 100);
+    }
+    ASSERT_EQ(CopyCountedKey::copies, 0);
+
+    // comparators written for the old by-value signature still convert
+    TreeSet<int> descending([](int a, int b) { return (a > b) ? -1 : (a < b) ? 1 : 0; });
+    descending.add(1);
+    descending.add(2);
+    ASSERT_EQ(descending.to_vector(), std::vector<int>({ 2, 1 }));
+}
+
+TEST(TreeSetTest, BulkBuildKeepsLastDuplicate)
+{
+    using Entry = std::pair<int, char>;
+    auto by_first = [](const Entry &a, const Entry &b) { return (a.first < b.first) ? -1 : (a.first > b.first) ? 1 : 0; };
+    TreeSet<Entry> s({ { 2, 'a' }, { 1, 'a' }, { 2, 'b' }, { 3, 'a' }, { 1, 'b' } }, by_first);
+
+    ASSERT_EQ(s.to_vector(), std::vector<Entry>({ { 1, 'b' }, { 2, 'b' }, { 3, 'a' } }));
+}
+
+TEST(TreeSetTest, DifferenceAndSymmetricDifference)
+{
+    TreeSet<int> s1({ 1, 2, 3, 4, 5 });
+    TreeSet<int> s2({ 4, 5, 6, 7 });
+
+    ASSERT_EQ((s1 - s2).to_vector(), std::vector<int>({ 1, 2, 3 }));
+    ASSERT_EQ((s2 - s1).to_vector(), std::vector<int>({ 6, 7 }));
+    ASSERT_EQ((s1 ^ s2).to_vector(), std::vector<int>({ 1, 2, 3, 6, 7 }));
+    ASSERT_TRUE((s1 ^ s2).is_balanced());
+}
+
+TEST(TreeSetTest, InPlaceUnion)
+{
+    TreeSet<int> s1({ 1, 3, 5 });
+    TreeSet<int> s2({ 2, 3, 4 });
+
+    TreeSet<int> &result = (s1 += s2);
+
+    ASSERT_EQ(&result, &s1);
+    ASSERT_EQ(s1.to_vector(), std::vector<int>({ 1, 2, 3, 4, 5 }));
+    ASSERT_EQ(s2.size(), 3);
+}
+
+TEST(TreeSetTest, SetOperationsWithMuchSmallerSet)
+{
+    std::vector<int> evens;
+    for (int i = 0; i < 10000; i += 2)
+    {
+        evens.push_back(i);
+    }
+    TreeSet<int> large(evens);
+    TreeSet<int> small({ -1, 4, 5, 9998 });
+
+    ASSERT_EQ((large & small).to_vector(), std::vector<int>({ 4, 9998 }));
+    ASSERT_EQ((small & large).to_vector(), std::vector<int>({ 4, 9998 }));
+    ASSERT_EQ((small - large).to_vector(), std::vector<int>({ -1, 5 }));
+
+    large += small;
+    ASSERT_EQ(large.size(), 5002);
+    ASSERT_TRUE(large.contains(-1));
+    ASSERT_TRUE(large.is_balanced());
+}
+
+TEST(TreeSetTest, IntersectionKeepsComparator)
+{
+    auto descending = [](int a, int b) { return (a > b) ? -1 : (a < b) ? 1 : 0; };
+    TreeSet<int> s1({ 1, 2, 3, 4 }, descending);
+    TreeSet<int> s2({ 2, 3, 4, 5 }, descending);
+
+    ASSERT_EQ((s1 & s2).to_vector(), std::vector<int>({ 4, 3, 2 }));
+}
+
+TEST(TreeSetTest, IteratesInOrder)
+{
+    TreeSet<int> s({ 5, 1, 4, 2, 3 });
+
+    std::vector<int> forward(s.begin(), s.end());
+    ASSERT_EQ(forward, std::vector<int>({ 1, 2, 3, 4, 5 }));
+
+    std::vector<int> backward;
+    for (auto it = s.end(); it != s.begin();)
+    {
+        backward.push_back(*--it);
+    }
+    ASSERT_EQ(backward, std::vector<int>({ 5, 4, 3, 2, 1 }));
+
+    TreeSet<int> empty;
+    ASSERT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(TreeSetTest, BoundsAndRange)
+{
+    TreeSet<int> s({ 10, 20, 30, 40, 50 });
+
+    ASSERT_EQ(*s.lower_bound(20), 20);
+    ASSERT_EQ(*s.lower_bound(21), 30);
+    ASSERT_EQ(*s.upper_bound(20), 30);
+    ASSERT_TRUE(s.lower_bound(51) == s.end());
+
+    auto [first, last] = s.equal_range(30);
+    ASSERT_EQ(*first, 30);
+    ASSERT_EQ(*last, 40);
+
+    std::vector<int> in_range;
+    for (int x : s.range(15, 40))
+    {
+        in_range.push_back(x);
+    }
+    ASSERT_EQ(in_range, std::vector<int>({ 20, 30, 40 }));
+    ASSERT_TRUE(s.range(41, 49).empty());
+    ASSERT_TRUE(s.range(40, 10).empty());
+}
+
+TEST(TreeSetTest, RemoveAndErase)
+{
+    TreeSet<int> s({ 1, 2, 3, 4, 5 });
+
+    ASSERT_TRUE(s.remove(3));
+    ASSERT_FALSE(s.remove(3));
+    ASSERT_EQ(s.to_vector(), std::vector<int>({ 1, 2, 4, 5 }));
+
+    auto next = s.erase(s.lower_bound(2));
+    ASSERT_EQ(*next, 4);
+    ASSERT_EQ(s.size(), 3);
+
+    // freed nodes are reused before new storage is requested
+    size_t allocations = s.allocation_count();
+    s.add(2);
+    s.add(3);
+    ASSERT_EQ(s.allocation_count(), allocations);
+    ASSERT_EQ(s.to_vector(), std::vector<int>({ 1, 2, 3, 4, 5 }));
+}
+
+struct PtrCompare
+{
+    int operator()(const std::unique_ptr<int> &a, const std::unique_ptr<int> &b) const {
+        return (*a < *b) ? -1 : (*a > *b) ? 1 : 0;
+    }
+
+    // bare ints, so lookups need no allocation
+    int operator()(int a, const std::unique_ptr<int> &b) const {
+        return (a < *b) ? -1 : (a > *b) ? 1 : 0;
+    }
+};
+
+TEST(TreeSetTest, AddAndEmplaceMoveOnlyValues)
+{
+    TreeSet<std::unique_ptr<int>, PtrCompare> s;
+    s.add(std::make_unique<int>(2));
+    s.emplace(new int(1));
+    s.emplace(new int(3));
+    s.add(std::make_unique<int>(2)); // replaces the equal element
+
+    ASSERT_EQ(s.size(), 3);
+    std::vector<int> values;
+    for (const auto &p : s)
+    {
+        values.push_back(*p);
+    }
+    ASSERT_EQ(values, std::vector<int>({ 1, 2, 3 }));
+    ASSERT_TRUE(s.contains(3));
+    ASSERT_TRUE(s.remove(1));
+    ASSERT_FALSE(s.contains(1));
+    ASSERT_TRUE(s.is_balanced());
+}
+
+struct Person
+{
+    int id;
+    std::string name;
+};
+
+// orders people by id, and compares bare ids with them
+struct ById
+{
+    int operator()(const Person &a, const Person &b) const { return (a.id < b.id) ? -1 : (a.id > b.id) ? 1 : 0; }
+    int operator()(int id, const Person &b) const { return (id < b.id) ? -1 : (id > b.id) ? 1 : 0; }
+};
+
+TEST(TreeSetTest, LookupsTakeKeysOfAnotherType)
+{
+    TreeSet<Person, ById, OrderStatistics> s;
+    for (int id : { 40, 10, 30, 20 })
+    {
+        s.add(Person{ id, "p" + std::to_string(id) });
+    }
+
+    ASSERT_TRUE(s.contains(30));
+    ASSERT_FALSE(s.contains(35));
+    ASSERT_EQ(s.get(20)->name, "p20");
+    ASSERT_EQ(s.get(25), std::nullopt);
+    ASSERT_EQ(s.rank(30), 2);
+    ASSERT_EQ(s.rank(35), 3);
+    ASSERT_EQ(s.lower_bound(25)->id, 30);
+    ASSERT_EQ(s.upper_bound(30)->id, 40);
+    ASSERT_TRUE(s.upper_bound(40) == s.end());
+    ASSERT_TRUE(s.remove(10));
+    ASSERT_FALSE(s.remove(10));
+    ASSERT_EQ(s.size(), 3);
+    ASSERT_TRUE(s.is_balanced());
+}
+
+struct CopyCounted
+{
+    static int copies;
+    static int moves;
+    int key;
+
+    CopyCounted(int key) : key(key) {}
+    CopyCounted(const CopyCounted &other) : key(other.key) { copies++; }
+    CopyCounted(CopyCounted &&other) noexcept : key(other.key) { moves++; }
+    CopyCounted &operator=(const CopyCounted &other) { key = other.key; copies++; return *this; }
+    CopyCounted &operator=(CopyCounted &&other) noexcept { key = other.key; return *this; }
+    bool operator<(const CopyCounted &other) const { return key < other.key; }
+    bool operator>(const CopyCounted &other) const { return key > other.key; }
+};
+
+int CopyCounted::copies = 0;
+int CopyCounted::moves = 0;
+
+TEST(TreeSetTest, AddRvalueNeverCopies)
+{
+    TreeSet<CopyCounted> s;
+    CopyCounted::copies = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(CopyCounted(i));
+        s.emplace(i + 100);
+    }
+    s.add(CopyCounted(5)); // existing key
+    for (int i = 0; i < 200; ++i)
+    {
+        ASSERT_TRUE(s.contains(CopyCounted(i)));
+    }
+
+    ASSERT_EQ(s.size(), 200);
+    ASSERT_EQ(CopyCounted::copies, 0);
+}
+
+TEST(TreeSetTest, EmplaceBuildsTheValueInItsNode)
+{
+    TreeSet<CopyCounted> s;
+    CopyCounted::copies = 0;
+    CopyCounted::moves = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        s.emplace(i);
+    }
+    ASSERT_EQ(CopyCounted::moves, 0);
+    s.emplace(5); // existing key: move-assigned, not move-constructed
+    ASSERT_EQ(CopyCounted::moves, 0);
+    ASSERT_EQ(CopyCounted::copies, 0);
+    ASSERT_EQ(s.size(), 10);
+}
+
+// neither copyable nor movable, so it can only be built in its node
+struct Pinned
+{
+    int key;
+    std::string name;
+
+    Pinned(int key, std::string name) : key(key), name(std::move(name)) {}
+    Pinned(const Pinned &) = delete;
+    Pinned &operator=(const Pinned &) = delete;
+    bool operator<(const Pinned &other) const { return key < other.key; }
+    bool operator>(const Pinned &other) const { return key > other.key; }
+};
+
+TEST(TreeSetTest, EmplaceNonMovableValues)
+{
+    TreeSet<Pinned> s;
+    s.emplace(2, "two");
+    s.emplace(1, "one");
+    s.emplace(3, "three");
+    s.emplace(2, "again"); // cannot be assigned, so the first one stays
+
+    ASSERT_EQ(s.size(), 3);
+    std::vector<std::string> names;
+    for (const Pinned &p : s)
+    {
+        names.push_back(p.name);
+    }
+    ASSERT_EQ(names, std::vector<std::string>({ "one", "two", "three" }));
+    ASSERT_TRUE(s.contains(Pinned(3, "")));
+    ASSERT_TRUE(s.remove(Pinned(1, "")));
+    ASSERT_TRUE(s.is_balanced());
+}
+
+TEST(TreeSetTest, ParallelBuildMatchesSequential)
+{
+    std::vector<int> items;
+    uint32_t x = 12345;
+    for (int i = 0; i < 300000; ++i)
+    {
+        x = x * 1664525u + 1013904223u;
+        items.push_back(static_cast<int>(x % 200000)); // many duplicates
+    }
+    TreeSet<int> sequential(items);
+
+    for (unsigned threads : { 1u, 2u, 3u, 8u })
+    {
+        TreeSet<int> parallel;
+        parallel.add(-1); // replaced by build
+        parallel.build(items, threads);
+        ASSERT_EQ(parallel.size(), sequential.size());
+        ASSERT_TRUE(parallel.is_balanced());
+        ASSERT_EQ(parallel.to_vector(threads), sequential.to_vector());
+    }
+}
+
+TEST(TreeSetTest, ParallelExportWithSubtreeSizes)
+{
+    std::vector<int> items;
+    for (int i = 0; i < 100000; ++i)
+    {
+        items.push_back((i * 7919) % 100003);
+    }
+    TreeSet<int, DefaultComparator<int>, OrderStatistics> s;
+    s.build(items, 4);
+    s.remove(50);
+    s.add(-5);
+
+    std::vector<int> expected = s.to_vector();
+    ASSERT_EQ(s.to_vector(4), expected);
+    ASSERT_EQ(s.to_vector(16), expected);
+    ASSERT_EQ(s.rank(100), 100); // -5 and 0..99 without 50
+}
+
+template <typename Layout>
+void check_layout_against_std_set()
+{
+    TreeSet<int, DefaultComparator<int>, OrderStatistics, Layout> s;
+    std::set<int> expected;
+    uint32_t x = 777;
+    for (int i = 0; i < 20000; ++i)
+    {
+        x = x * 1664525u + 1013904223u;
+        int value = static_cast<int>(x % 5000);
+        if (x & 0x10000)
+        {
+            ASSERT_EQ(s.remove(value), expected.erase(value) == 1);
+        }
+        else
+        {
+            s.add(value);
+            expected.insert(value);
+        }
+    }
+    ASSERT_TRUE(s.is_balanced());
+    ASSERT_EQ(s.size(), expected.size());
+    ASSERT_EQ(s.to_vector(), std::vector<int>(expected.begin(), expected.end()));
+    ASSERT_EQ(s.rank(2500), static_cast<size_t>(std::distance(expected.begin(), expected.lower_bound(2500))));
+    ASSERT_EQ(s.erase_range(1000, 1999), static_cast<size_t>(std::distance(expected.lower_bound(1000), expected.upper_bound(1999))));
+    ASSERT_TRUE(s.is_balanced());
+
+    TreeSet<int, DefaultComparator<int>, OrderStatistics, Layout> copy = s;
+    copy.add(-1);
+    ASSERT_FALSE(s.contains(-1));
+    TreeSet<int, DefaultComparator<int>, OrderStatistics, Layout> moved = std::move(copy);
+    ASSERT_TRUE(moved.contains(-1));
+    ASSERT_TRUE(moved.is_balanced());
+}
+
+TEST(TreeSetTest, PackedColorLayoutMatchesStdSet)
+{
+    check_layout_against_std_set<PackedColorNode>();
+}
+
+TEST(TreeSetTest, CompactLayoutMatchesStdSet)
+{
+    check_layout_against_std_set<CompactNode>();
+}
+
+TEST(TreeSetTest, CompactLayoutShrinksNodes)
+{
+    ASSERT_EQ(TreeSet<int>::bytes_per_node(), 32u);
+    ASSERT_EQ((TreeSet<int, DefaultComparator<int>, NoAugment, CompactNode>::bytes_per_node()), 16u);
+    // an int fits in the padding after the color; a long does not
+    ASSERT_EQ(TreeSet<long>::bytes_per_node(), 40u);
+    ASSERT_EQ((TreeSet<long, DefaultComparator<long>, NoAugment, PackedColorNode>::bytes_per_node()), 32u);
+    ASSERT_EQ((TreeSet<long, DefaultComparator<long>, NoAugment, CompactNode>::bytes_per_node()), 24u);
+}
+
+TEST(TreeSetTest, CompactLayoutBuildSpansChunks)
+{
+    std::vector<int> items;
+    for (int i = 0; i < 200000; ++i)
+    {
+        items.push_back(i);
+    }
+    TreeSet<int, DefaultComparator<int>, NoAugment, CompactNode> s;
+    s.build(items, 4);
+    ASSERT_EQ(s.size(), items.size());
+    ASSERT_TRUE(s.is_balanced());
+    ASSERT_EQ(s.to_vector(), items);
+    ASSERT_TRUE(s.remove(100000));
+    ASSERT_FALSE(s.contains(100000));
+    ASSERT_TRUE(s.contains(199999));
+}
+
+TEST(TreeSetTest, SmallCompactTreesShareArenaChunks)
+{
+    // more one-element trees than the arena has chunks: each takes a page
+    using Set = TreeSet<int, DefaultComparator<int>, NoAugment, CompactNode>;
+    using Arena = NodeArena<BinaryTreeNode<int, NoAugment, CompactNode>>;
+    const size_t trees = Arena::MAX_CHUNKS + 1000;
+    size_t chunks_before = Arena::chunk_count();
+    {
+        std::vector<Set> sets(trees);
+        for (size_t i = 0; i < trees; ++i)
+        {
+            sets[i].add(static_cast<int>(i));
+        }
+        ASSERT_EQ(sets[0].bytes_per_element(), Arena::BYTES_PER_PAGE);
+        ASSERT_LT(sets[0].bytes_per_element(), 4200);
+        ASSERT_LE(Arena::chunk_count(), chunks_before + trees / (Arena::PAGES_PER_CHUNK - 1) + 1);
+        ASSERT_TRUE(sets[trees - 1].contains(static_cast<int>(trees - 1)));
+    }
+    // pages go back and empty chunks are unmapped, but for one spare
+    ASSERT_LE(Arena::chunk_count(), chunks_before + 1);
+
+    // large trees pay a page share per 256 nodes
+    Set large;
+    for (int i = 0; i < 100000; ++i)
+    {
+        large.add(i);
+    }
+    ASSERT_LT(large.bytes_per_element(), 17.0);
+    ASSERT_EQ(Set().bytes_per_element(), 0);
+}
+
+TEST(TreeSetTest, IsValidThroughInsertsAndRemoves)
+{
+    TreeSet<int> s;
+    ASSERT_TRUE(s.is_valid());
+    s.add(1);
+    ASSERT_TRUE(s.is_valid());
+
+    uint32_t x = 99;
+    for (int i = 0; i < 50000; ++i)
+    {
+        x = x * 1664525u + 1013904223u;
+        int value = static_cast<int>(x % 10000);
+        if (x & 0x10000)
+            s.remove(value);
+        else
+            s.add(value);
+    }
+    ASSERT_TRUE(s.is_valid());
+
+    TreeSet<int, DescendingInt> descending({ 5, 3, 9, 1, 7 });
+    ASSERT_TRUE(descending.is_valid());
+}
+
+TEST(TreeSetTest, ValidatesLargeTreeInLinearTime)
+{
+    std::vector<int> items;
+    for (int i = 0; i < 2000000; ++i)
+    {
+        items.push_back(i);
+    }
+    TreeSet<int> s(items);
+    ASSERT_TRUE(s.is_balanced());
+    ASSERT_TRUE(s.is_valid());
+}
+
+TEST(TreeSetTest, BatchLookupsMatchSingleLookups)
+{
+    TreeSet<int> s;
+    for (int i = 0; i < 5000; i += 2)
+    {
+        s.add(i);
+    }
+    // fewer, as many and more keys than the lookups kept in flight
+    for (size_t count : { 0, 5, 16, 1001 })
+    {
+        std::vector<int> keys;
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys.push_back(static_cast<int>((i * 7919) % 5003) - 1);
+        }
+        std::unique_ptr<bool[]> found(new bool[count + 1]);
+        std::vector<std::optional<int>> values(count);
+        s.contains_many(keys.data(), count, found.get());
+        s.get_many(keys.data(), count, values.data());
+        for (size_t i = 0; i < count; ++i)
+        {
+            ASSERT_EQ(found[i], s.contains(keys[i]));
+            ASSERT_EQ(values[i], s.get(keys[i]));
+        }
+    }
+}
+
+struct CountingIntCompare
+{
+    static size_t calls;
+    int operator()(int a, int b) const
+    {
+        calls++;
+        return (a < b) ? -1 : (a > b) ? 1 : 0;
+    }
+};
+
+size_t CountingIntCompare::calls = 0;
+
+TEST(TreeSetTest, MonotoneStreamsCostConstantComparisons)
+{
+    const int n = 100000;
+    TreeSet<int, CountingIntCompare> increasing;
+    CountingIntCompare::calls = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        increasing.add(i);
+    }
+    ASSERT_LE(CountingIntCompare::calls, 2u * n);
+    ASSERT_TRUE(increasing.is_valid());
+
+    TreeSet<int, CountingIntCompare> decreasing;
+    CountingIntCompare::calls = 0;
+    for (int i = n; i > 0; --i)
+    {
+        decreasing.add(i);
+    }
+    ASSERT_LE(CountingIntCompare::calls, 2u * n);
+    ASSERT_TRUE(decreasing.is_valid());
+
+    // the finger must not outlive its node
+    increasing.remove(n - 1);
+    increasing.add(n + 5);
+    increasing.add(n - 1);
+    ASSERT_EQ(increasing.size(), static_cast<size_t>(n + 1));
+    ASSERT_TRUE(increasing.is_valid());
+}
+
+TEST(TreeSetTest, HintedAdd)
+{
+    TreeSet<int, CountingIntCompare> s;
+    CountingIntCompare::calls = 0;
+    for (int i = 0; i < 1000; i += 2)
+    {
+        s.add(s.end(), i);
+    }
+    ASSERT_LE(CountingIntCompare::calls, 1000u);
+
+    // fill the gaps, hinting with the element just after each one
+    auto it = s.begin();
+    for (int i = 1; i < 1000; i += 2)
+    {
+        ++it;
+        CountingIntCompare::calls = 0;
+        auto added = s.add(it, i);
+        ASSERT_LE(CountingIntCompare::calls, 2u);
+        ASSERT_EQ(*added, i);
+    }
+
+    // wrong hints and duplicates still work
+    ASSERT_EQ(*s.add(s.begin(), 5000), 5000);
+    ASSERT_EQ(*s.add(s.end(), -7), -7);
+    ASSERT_EQ(*s.add(s.lower_bound(500), 500), 500);
+    ASSERT_EQ(s.size(), 1002u);
+    ASSERT_TRUE(s.is_valid());
+}
+
+// concatenation is not commutative, so it shows whether ranges fold in order
+struct ConcatMonoid
+{
+    using value_type = std::string;
+    static std::string identity() { return ""; }
+    static std::string lift(const std::string &x) { return x; }
+    static std::string combine(const std::string &a, const std::string &b) { return a + b; }
+};
+
+TEST(TreeSetTest, AggregateFoldsRangeInOrder)
+{
+    TreeSet<std::string, DefaultComparator<std::string>, Aggregate<ConcatMonoid>> s;
+    std::string letters = "qwertyuiopasdfghjklzxcvbnm";
+    for (char c : letters)
+    {
+        s.add(std::string(1, c));
+    }
+    s.remove("k");
+    ASSERT_TRUE(s.is_valid());
+    ASSERT_EQ(s.aggregate("a", "z"), "abcdefghijlmnopqrstuvwxyz");
+    ASSERT_EQ(s.aggregate("c", "h"), "cdefgh");
+    ASSERT_EQ(s.aggregate("ja", "mm"), "lm");
+    ASSERT_EQ(s.aggregate("k", "k"), "");
+
+    auto copy = s;
+    copy.add("k");
+    ASSERT_EQ(copy.aggregate("j", "l"), "jkl");
+    ASSERT_EQ(s.aggregate("j", "l"), "jl");
+}
+
+// trivially destructible elements whose aggregates own heap memory
+struct DigitsMonoid
+{
+    using value_type = std::string;
+    static std::string identity() { return ""; }
+    static std::string lift(int x) { return std::to_string(x) + " is long enough to leave the SSO buffer"; }
+    static std::string combine(const std::string &a, const std::string &b) { return a.size() < b.size() ? b : a; }
+};
+
+TEST(TreeSetTest, ClearDestroysAggregatesOfTrivialElements)
+{
+    // under ASan, skipping the node destructors here shows up as a leak
+    TreeSet<int, DefaultComparator<int>, Aggregate<DigitsMonoid>> s;
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+    }
+    s.clear();
+    ASSERT_TRUE(s.is_empty());
+    s.add(7);
+    ASSERT_EQ(s.aggregate(0, 10), DigitsMonoid::lift(7));
+}
+
+template <typename Layout>
+void check_split_and_join()
+{
+    using Set = TreeSet<int, DefaultComparator<int>, OrderStatistics, Layout>;
+    std::vector<int> expected;
+    Set s;
+    uint32_t x = 4242;
+    for (int i = 0; i < 3000; ++i)
+    {
+        x = x * 1664525u + 1013904223u;
+        s.add(static_cast<int>(x % 10000) * 2);
+    }
+    expected = s.to_vector();
+
+    // cut near both ends and in the middle, so each side is the smaller one once
+    for (int key : { -5, 300, 10001, 19500, 30000 })
+    {
+        Set left = s;
+        Set right = left.split(key);
+        auto cut = std::lower_bound(expected.begin(), expected.end(), key);
+        ASSERT_TRUE(left.is_valid());
+        ASSERT_TRUE(right.is_valid());
+        ASSERT_EQ(left.to_vector(), std::vector<int>(expected.begin(), cut));
+        ASSERT_EQ(right.to_vector(), std::vector<int>(cut, expected.end()));
+        ASSERT_EQ(right.rank(key + 1000), static_cast<size_t>(std::lower_bound(cut, expected.end(), key + 1000) - cut));
+
+        // split on an odd key, so the pivot is free to put back between the parts
+        Set joined = Set::join(std::move(left), key | 1, std::move(right));
+        ASSERT_TRUE(joined.is_valid());
+        ASSERT_TRUE(left.is_empty());
+        ASSERT_TRUE(right.is_empty());
+        ASSERT_EQ(joined.size(), expected.size() + 1);
+        ASSERT_EQ(joined.rank(key | 1), static_cast<size_t>(cut - expected.begin()));
+        ASSERT_TRUE(joined.remove(key | 1));
+        ASSERT_EQ(joined.to_vector(), expected);
+        joined.add(7);
+        ASSERT_TRUE(joined.is_valid());
+    }
+}
+
+TEST(TreeSetTest, SplitAndJoin)
+{
+    check_split_and_join<WideNode>();
+    check_split_and_join<CompactNode>();
+}
+
+TEST(TreeSetTest, JoinChecksOrder)
+{
+    TreeSet<int> small({ 1, 2, 3 });
+    TreeSet<int> large({ 10, 20 });
+    ASSERT_THROW(TreeSet<int>::join(std::move(small), 10, std::move(large)), std::invalid_argument);
+    ASSERT_THROW(TreeSet<int>::join(std::move(large), 5, std::move(small)), std::invalid_argument);
+    ASSERT_EQ(small.size(), 3u);
+    ASSERT_EQ(large.size(), 2u);
+
+    TreeSet<int> joined = TreeSet<int>::join(TreeSet<int>(), 0, std::move(small));
+    ASSERT_EQ(joined.to_vector(), std::vector<int>({ 0, 1, 2, 3 }));
+    ASSERT_TRUE(joined.is_valid());
+}
+
+TEST(TreeSetTest, JoinBasedOperationsMatchStdAlgorithms)
+{
+    using Set = TreeSet<int, DefaultComparator<int>, OrderStatistics>;
+    auto random_values = [](uint32_t seed, size_t n, int range) {
+        std::vector<int> values;
+        for (size_t i = 0; i < n; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            values.push_back(static_cast<int>((seed >> 8) % range));
+        }
+        return values;
+    };
+    // large enough that four threads recurse concurrently
+    for (auto sizes : { std::make_pair(60000, 50000), std::make_pair(60000, 300), std::make_pair(20, 60000) })
+    {
+        Set a(random_values(1, sizes.first, 200000));
+        Set b(random_values(2, sizes.second, 200000));
+        std::vector<int> va = a.to_vector(), vb = b.to_vector(), expected;
+        for (unsigned threads : { 1u, 4u })
+        {
+            Set u = a, i = a, d = a;
+            u.unite(b, threads);
+            i.intersect(b, threads);
+            d.subtract(b, threads);
+
+            expected.clear();
+            std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+            ASSERT_TRUE(u.is_valid());
+            ASSERT_EQ(u.to_vector(), expected);
+            ASSERT_EQ(u.select(expected.size() / 2), expected[expected.size() / 2]);
+
+            expected.clear();
+            std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+            ASSERT_TRUE(i.is_valid());
+            ASSERT_EQ(i.to_vector(), expected);
+            ASSERT_EQ((a & b).to_vector(), expected);
+            ASSERT_EQ((b & a).to_vector(), expected);
+
+            expected.clear();
+            std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+            ASSERT_TRUE(d.is_valid());
+            ASSERT_EQ(d.to_vector(), expected);
+            ASSERT_EQ((a - b).to_vector(), expected);
+            ASSERT_EQ(d.rank(100000), static_cast<size_t>(std::lower_bound(expected.begin(), expected.end(), 100000) - expected.begin()));
+        }
+    }
+
+    Set a({ 1, 2, 3 });
+    a.intersect(a);
+    ASSERT_EQ(a.size(), 3u);
+    a.subtract(a);
+    ASSERT_TRUE(a.is_empty());
+}
+
+TEST(TreeSetTest, JoinBasedOperationsKeepDocumentedValues)
+{
+    // elements compare by key only; the second member tells the two sets apart
+    auto by_key = [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return (a.first < b.first) ? -1 : (a.first > b.first) ? 1 : 0;
+    };
+    using Set = TreeSet<std::pair<int, int>>;
+    using Pairs = std::vector<std::pair<int, int>>;
+    std::vector<std::pair<int, int>> many;
+    for (int i = 0; i < 1000; ++i)
+    {
+        many.push_back({ i, 0 });
+    }
+    const Set large(many, by_key);
+    const Set small({ { 5, 1 }, { 7, 1 }, { 20000, 1 } }, by_key);
+
+    Set intersection = small;
+    intersection.intersect(large);
+    ASSERT_EQ(intersection.to_vector(), Pairs({ { 5, 1 }, { 7, 1 } }));
+    intersection = large;
+    intersection.intersect(small);
+    ASSERT_EQ(intersection.to_vector(), Pairs({ { 5, 0 }, { 7, 0 } }));
+
+    Set united = large;
+    united.unite(small);
+    ASSERT_EQ(united.size(), 1001u);
+    ASSERT_EQ(*united.get({ 5, -1 }), std::make_pair(5, 1));
+    ASSERT_EQ(*united.get({ 6, -1 }), std::make_pair(6, 0));
+    ASSERT_TRUE(united.is_valid());
+}
+
+TEST(TreeSetTest, FilterSkipsMostMissesAndNeverHidesElements)
+{
+    TreeSet<int, CountingIntCompare> s;
+    for (int i = 0; i < 20000; i += 2)
+    {
+        s.add(i);
+    }
+    s.enable_filter(10);
+    ASSERT_GT(s.filter_bytes(), 0u);
+
+    // odd numbers are all absent; most of them never reach the tree
+    CountingIntCompare::calls = 0;
+    for (int i = 1; i < 20000; i += 2)
+    {
+        ASSERT_FALSE(s.contains(i));
+    }
+    ASSERT_LT(CountingIntCompare::calls, 10000u * 20 / 10);
+
+    // the batch lookups ask the filter first too
+    std::vector<int> odd;
+    for (int i = 1; i < 20000; i += 2)
+    {
+        odd.push_back(i);
+    }
+    std::unique_ptr<bool[]> found(new bool[odd.size()]);
+    std::vector<std::optional<int>> values(odd.size());
+    CountingIntCompare::calls = 0;
+    s.contains_many(odd.data(), odd.size(), found.get());
+    s.get_many(odd.data(), odd.size(), values.data());
+    ASSERT_LT(CountingIntCompare::calls, 2 * 10000u * 20 / 10);
+    for (size_t i = 0; i < odd.size(); ++i)
+    {
+        ASSERT_FALSE(found[i]);
+        ASSERT_FALSE(values[i].has_value());
+    }
+    std::vector<int> even = { 0, 2, 19998 };
+    s.contains_many(even.data(), even.size(), found.get());
+    ASSERT_TRUE(found[0] && found[1] && found[2]);
+
+    // inserts past the filter's capacity, removals, bulk rebuilds, copies
+    // and moves must never turn a present element into a filtered miss
+    std::set<int> expected;
+    for (int i = 0; i < 20000; i += 2)
+    {
+        expected.insert(i);
+    }
+    for (int i = 20001; i < 60000; i += 3)
+    {
+        s.add(i);
+        expected.insert(i);
+    }
+    for (int i = 0; i < 60000; i += 5)
+    {
+        ASSERT_EQ(s.remove(i), expected.erase(i) == 1);
+    }
+    TreeSet<int, CountingIntCompare> other({ -4, -2, 7, 20001 });
+    s += other;
+    expected.insert({ -4, -2, 7, 20001 });
+    s.erase_range(30000, 50000);
+    expected.erase(expected.lower_bound(30000), expected.upper_bound(50000));
+    TreeSet<int, CountingIntCompare> copy = s;
+    TreeSet<int, CountingIntCompare> moved = std::move(copy);
+    for (int i = -10; i < 60000; ++i)
+    {
+        ASSERT_EQ(moved.contains(i), expected.count(i) == 1) << i;
+        ASSERT_EQ(s.get(i).has_value(), expected.count(i) == 1) << i;
+    }
+
+    TreeSet<int, CountingIntCompare> high = s.split(40000);
+    ASSERT_GT(high.filter_bytes(), 0u);
+    ASSERT_TRUE(high.contains(*expected.lower_bound(40000)));
+    TreeSet<int, CountingIntCompare> joined = TreeSet<int, CountingIntCompare>::join(std::move(s), 39999, std::move(high));
+    ASSERT_TRUE(joined.contains(39999));
+    joined.clear();
+    ASSERT_FALSE(joined.contains(2));
+    joined.add(2);
+    ASSERT_TRUE(joined.contains(2));
+
+    joined.disable_filter();
+    ASSERT_EQ(joined.filter_bytes(), 0u);
+    ASSERT_TRUE(joined.contains(2));
+}
+
+TEST(TreeSetTest, FilterUsesSuppliedHash)
+{
+    auto by_key = [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return (a.first < b.first) ? -1 : (a.first > b.first) ? 1 : 0;
+    };
+    TreeSet<std::pair<int, int>> s({ { 1, 10 }, { 2, 20 } }, by_key);
+    ASSERT_THROW(s.enable_filter(), std::invalid_argument);
+
+    s.enable_filter(12, [](const std::pair<int, int> &x) { return std::hash<int>()(x.first); });
+    ASSERT_TRUE(s.contains({ 1, -1 }));
+    ASSERT_EQ(s.get({ 2, -1 })->second, 20);
+    ASSERT_FALSE(s.contains({ 3, 10 }));
+}